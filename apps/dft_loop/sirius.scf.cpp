@@ -21,10 +21,11 @@ void json_output_common(json& dict__)
     dict__["threads_per_rank"] = omp_get_max_threads();
 }
 
-std::unique_ptr<Simulation_context> create_sim_ctx(std::string     fname__,
-                                                   cmd_args const& args__)
+std::unique_ptr<Simulation_context> create_sim_ctx(std::string         fname__,
+                                                   cmd_args const&     args__,
+                                                   Communicator const& comm__ = Communicator::world())
 {
-    auto ctx_ptr = std::unique_ptr<Simulation_context>(new Simulation_context(fname__, Communicator::world()));
+    auto ctx_ptr = std::unique_ptr<Simulation_context>(new Simulation_context(fname__, comm__));
     Simulation_context& ctx = *ctx_ptr;
 
     auto& inp = ctx.parameters_input();
@@ -46,11 +47,13 @@ std::unique_ptr<Simulation_context> create_sim_ctx(std::string     fname__,
     return std::move(ctx_ptr);
 }
 
-
-double ground_state(Simulation_context& ctx,
-                    task_t              task,
-                    cmd_args const&     args,
-                    int                 write_output)
+/// Run the ground state calculation and return the output dictionary.
+/** If write_output is set, the dictionary is written to the output file and the density and potential are saved
+ *  for a restart. */
+json ground_state(Simulation_context& ctx,
+                  task_t              task,
+                  cmd_args const&     args,
+                  int                 write_output)
 {
     if (ctx.comm().rank() == 0 && ctx.control().print_memory_usage_) {
         MEMORY_USAGE_INFO();
@@ -73,11 +76,18 @@ double ground_state(Simulation_context& ctx,
     auto& density = dft.density();
 
     if (task == task_t::ground_state_restart) {
-        if (!utils::file_exists(storage_file_name)) {
+        auto checkpoint_file = checkpoint_marker_name(ctx.control().checkpoint_prefix_);
+        if (utils::file_exists(storage_file_name)) {
+            density.load();
+            potential.load();
+        } else if (utils::file_exists(checkpoint_file)) {
+            int iter = dft.load_checkpoint();
+            if (ctx.comm().rank() == 0) {
+                printf("restart from the checkpoint of SCF iteration %i\n", iter);
+            }
+        } else {
             TERMINATE("storage file is not found");
         }
-        density.load();
-        potential.load();
     } else {
         dft.initial_state();
     }
@@ -85,7 +95,8 @@ double ground_state(Simulation_context& ctx,
     double initial_tol = ctx.iterative_solver_tolerance();
 
     /* launch the calculation */
-    auto result = dft.find(inp.potential_tol_, inp.energy_tol_, initial_tol, inp.num_dft_iter_, write_state);
+    auto result = dft.find(inp.potential_tol_, inp.energy_tol_, initial_tol, inp.num_dft_iter_,
+                           write_state && write_output);
 
     if (ctx.control().verification_ >= 1) {
         dft.check_scf_density();
@@ -95,15 +106,19 @@ double ground_state(Simulation_context& ctx,
     if (repeat_update) {
         for (int i = 0; i < repeat_update; i++) {
             dft.update();
-            result = dft.find(inp.potential_tol_, inp.energy_tol_, initial_tol, inp.num_dft_iter_, write_state);
+            result = dft.find(inp.potential_tol_, inp.energy_tol_, initial_tol, inp.num_dft_iter_,
+                              write_state && write_output);
         }
     }
 
     dft.print_magnetic_moment();
 
+    /* non-local forces are computed together with the stress tensor */
+    bool fused_nonloc = ctx.control().print_stress_ && ctx.control().print_forces_ && !ctx.full_potential();
+
     if (ctx.control().print_stress_ && !ctx.full_potential()) {
         Stress& s       = dft.stress();
-        auto stress_tot = s.calc_stress_total();
+        auto stress_tot = fused_nonloc ? s.calc_stress_total(dft.forces()) : s.calc_stress_total();
         s.print_info();
         result["stress"] = std::vector<std::vector<double>>(3, std::vector<double>(3));
         for (int i = 0; i < 3; i++) {
@@ -114,7 +129,7 @@ double ground_state(Simulation_context& ctx,
     }
     if (ctx.control().print_forces_) {
         Force& f         = dft.forces();
-        auto& forces_tot = f.calc_forces_total();
+        auto& forces_tot = f.calc_forces_total(!fused_nonloc);
         f.print_info();
         result["forces"] = std::vector<std::vector<double>>(ctx.unit_cell().num_atoms(), std::vector<double>(3));
         for (int i = 0; i < ctx.unit_cell().num_atoms(); i++) {
@@ -169,8 +184,8 @@ double ground_state(Simulation_context& ctx,
         }
     }
 
-    if (write_state && write_output) {
-        json dict;
+    json dict;
+    if (write_state) {
         json_output_common(dict);
 
         dict["task"] = static_cast<int>(task);
@@ -179,8 +194,11 @@ double ground_state(Simulation_context& ctx,
         dict["counters"] = json::object();
         dict["counters"]["local_operator_num_applied"] = Local_operator::num_applied();
         dict["counters"]["band_evp_work_count"] = Band::evp_work_count();
+        if (ctx.control().autotune_) {
+            dict["autotune"] = ctx.autotune_result();
+        }
 
-        if (ctx.comm().rank() == 0) {
+        if (ctx.comm().rank() == 0 && write_output) {
             std::string output_file = args.value<std::string>("output", std::string("output_") +
                                                               ctx.start_time_tag() + std::string(".json"));
             std::ofstream ofs(output_file, std::ofstream::out | std::ofstream::trunc);
@@ -211,12 +229,156 @@ double ground_state(Simulation_context& ctx,
     /* wait for all */
     ctx.comm().barrier();
 
-    return dft.total_energy();
+    return dict;
+}
+
+/// Shared queue of the task-farm mode.
+/** The queue is a counter on rank 0 of the communicator which is atomically incremented with MPI_Fetch_and_op;
+ *  a group pulls the next task as soon as it has finished the previous one. */
+class task_queue
+{
+  private:
+    int counter_{0};
+
+    MPI_Win win_;
+
+  public:
+    task_queue(Communicator const& comm__)
+    {
+        CALL_MPI(MPI_Win_create, (&counter_, sizeof(int), sizeof(int), MPI_INFO_NULL, comm__.mpi_comm(), &win_));
+    }
+
+    ~task_queue()
+    {
+        MPI_Win_free(&win_);
+    }
+
+    /// Get the index of the next task.
+    int next()
+    {
+        int one{1};
+        int idx{0};
+        CALL_MPI(MPI_Win_lock, (MPI_LOCK_SHARED, 0, 0, win_));
+        CALL_MPI(MPI_Fetch_and_op, (&one, &idx, MPI_INT, 0, 0, MPI_SUM, win_));
+        CALL_MPI(MPI_Win_unlock, (0, win_));
+        return idx;
+    }
+};
+
+/// Run many independent ground state calculations in groups of MPI ranks.
+/** The world communicator is split into num_groups groups of equal size. Each group creates its own simulation
+ *  context for the next input from the list, and the leader of the group appends the result as one line to the
+ *  JSON-lines output stream. */
+void run_task_farm(cmd_args const& args)
+{
+    auto& world = Communicator::world();
+
+    task_t task = static_cast<task_t>(args.value<int>("task", 0));
+    if (task != task_t::ground_state_new) {
+        /* restart is not supported: all tasks would read the same storage or checkpoint file */
+        TERMINATE("task-farm mode is implemented for the new ground state task only");
+    }
+
+    /* read the list of input files */
+    std::string list_fname = args.value<std::string>("task_list");
+    if (!utils::file_exists(list_fname)) {
+        TERMINATE("task list file does not exist");
+    }
+    std::vector<std::string> inputs;
+    std::ifstream ifs(list_fname);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.size() && line[0] != '#') {
+            inputs.push_back(line);
+        }
+    }
+
+    int num_groups = args.value<int>("num_groups", world.size());
+    if (num_groups < 1 || world.size() % num_groups) {
+        std::stringstream s;
+        s << "Can't split " << world.size() << " ranks into " << num_groups << " groups";
+        TERMINATE(s);
+    }
+    int group_size = world.size() / num_groups;
+    int group_id   = world.rank() / group_size;
+
+    auto comm_group = world.split(group_id);
+    /* communicator of the group leaders used to write the output stream */
+    auto comm_leaders = world.split(comm_group.rank());
+
+    std::string output_file = args.value<std::string>("output", std::string("output_") +
+                                                      utils::timestamp("%Y%m%d%H%M%S") + std::string(".jsonl"));
+    if (world.rank() == 0) {
+        /* truncate the output stream */
+        std::ofstream(output_file, std::ofstream::out | std::ofstream::trunc);
+        printf("task-farm mode: %i inputs, %i groups of %i ranks\n", static_cast<int>(inputs.size()), num_groups,
+               group_size);
+    }
+    world.barrier();
+
+    MPI_File fh;
+    if (comm_group.rank() == 0) {
+        CALL_MPI(MPI_File_open, (comm_leaders.mpi_comm(), output_file.c_str(), MPI_MODE_WRONLY | MPI_MODE_APPEND,
+                                 MPI_INFO_NULL, &fh));
+    }
+
+    task_queue queue(world);
+
+    while (true) {
+        int itask{0};
+        if (comm_group.rank() == 0) {
+            itask = queue.next();
+        }
+        comm_group.bcast(&itask, 1, 0);
+        if (itask >= static_cast<int>(inputs.size())) {
+            break;
+        }
+
+        json entry;
+        entry["task_id"] = itask;
+        entry["input"]   = inputs[itask];
+        entry["group"]   = group_id;
+
+        /* timers and counters are process-wide; start each task from zero */
+        utils::timer::reset();
+        Local_operator::num_applied(-Local_operator::num_applied());
+        Band::evp_work_count() = 0;
+
+        double t0 = utils::wtime();
+        if (utils::file_exists(inputs[itask])) {
+            auto ctx = create_sim_ctx(inputs[itask], args, comm_group);
+            ctx->initialize();
+            entry["result"] = ground_state(*ctx, task, args, 0);
+        } else {
+            entry["error"] = "input file does not exist";
+        }
+        entry["wall_time"] = utils::wtime() - t0;
+
+        if (comm_group.rank() == 0) {
+            /* one line per task; the shared file pointer makes the writes of different groups atomic */
+            auto str = entry.dump() + "\n";
+            MPI_Status status;
+            CALL_MPI(MPI_File_write_shared, (fh, &str[0], static_cast<int>(str.size()), MPI_CHAR, &status));
+        }
+    }
+
+    if (comm_group.rank() == 0) {
+        CALL_MPI(MPI_File_close, (&fh));
+    }
+    world.barrier();
 }
 
 /// Run a task based on a command line input.
 void run_tasks(cmd_args const& args)
 {
+    /* many independent calculations in one MPI job */
+    if (args.exist("task_list")) {
+        run_task_farm(args);
+        return;
+    }
+
     /* get the task id */
     task_t task = static_cast<task_t>(args.value<int>("task", 0));
     /* get the input file name */
@@ -252,8 +414,6 @@ void run_tasks(cmd_args const& args)
 
         Density density(*ctx);
 
-        K_point_set ks(*ctx);
-
         json inp;
         std::ifstream(fname) >> inp;
 
@@ -268,11 +428,12 @@ void run_tasks(cmd_args const& args)
 
         std::vector<double> x_axis;
         std::vector<std::pair<double, std::string>> x_ticks;
+        std::vector<vector3d<double>> kpath;
 
         /* first point */
         x_axis.push_back(0);
         x_ticks.push_back({0, vertex[0].first});
-        ks.add_kpoint(&vertex[0].second[0], 1.0);
+        kpath.push_back(vector3d<double>(vertex[0].second));
 
         double t{0};
         for (size_t i = 0; i < vertex.size() - 1; i++) {
@@ -283,30 +444,90 @@ void run_tasks(cmd_args const& args)
             int np = std::max(10, static_cast<int>(30 * dv_cart.length()));
             for (int j = 1; j <= np; j++) {
                 vector3d<double> v = v0 + dv * static_cast<double>(j) / np;
-                ks.add_kpoint(&v[0], 1.0);
+                kpath.push_back(v);
                 t += dv_cart.length() / np;
                 x_axis.push_back(t);
             }
             x_ticks.push_back({t, vertex[i + 1].first});
         }
 
-        ks.initialize();
-
         //density.initial_density();
         density.load();
         potential.generate(density);
         Band band(*ctx);
-        if (!ctx->full_potential()) {
-            band.initialize_subspace(ks, H);
-            if (ctx->hubbard_correction()) {
-                TERMINATE("fix me");
-                H.U().hubbard_compute_occupation_numbers(ks); // TODO: this is wrong; U matrix should come form the saved file
-                H.U().calculate_hubbard_potential_and_energy();
+        if (!ctx->full_potential() && ctx->hubbard_correction()) {
+            TERMINATE("fix me");
+        }
+
+        /* The path is split into contiguous segments, one per group of k-point ranks. The k-points are processed
+         * in batches: batch i holds the i-th point of each segment. Only the first batch starts from the initial
+         * subspace; the other points are seeded from the converged solution at the previous point of the segment.
+         * At most two batches are kept in memory. */
+        int num_groups = ctx->comm_k().size();
+        int num_kpoints = static_cast<int>(kpath.size());
+        splindex<block> spl_path(num_kpoints, num_groups, 0);
+        int num_batches = spl_path.local_size(0);
+
+        /* band energies of the path, stored by the root rank */
+        mdarray<double, 3> band_energies(ctx->num_bands(), ctx->num_spin_dims(), num_kpoints);
+
+        std::ofstream ofs_stream;
+        if (Communicator::world().rank() == 0) {
+            ofs_stream.open("bands.jsonl", std::ofstream::out | std::ofstream::trunc);
+        }
+
+        std::unique_ptr<K_point_set> ks_prev;
+        for (int ib = 0; ib < num_batches; ib++) {
+            std::unique_ptr<K_point_set> ks(new K_point_set(*ctx));
+            /* global index of the path k-point for each k-point of the batch */
+            std::vector<int> ik_path;
+            std::vector<int> counts(num_groups, 0);
+            for (int g = 0; g < num_groups; g++) {
+                if (ib < spl_path.local_size(g)) {
+                    int ik = spl_path.global_index(ib, g);
+                    ks->add_kpoint(&kpath[ik][0], 1.0);
+                    ik_path.push_back(ik);
+                    counts[g] = 1;
+                }
             }
+            ks->initialize(counts);
+
+            if (!ctx->full_potential()) {
+                if (ib == 0) {
+                    band.initialize_subspace(*ks, H);
+                } else {
+                    /* neighbour of this point is the local k-point of the previous batch */
+                    for (int ikloc = 0; ikloc < ks->spl_num_kpoints().local_size(); ikloc++) {
+                        int ik = ks->spl_num_kpoints(ikloc);
+                        (*ks)[ik]->initialize_from(*(*ks_prev)[ks_prev->spl_num_kpoints(ikloc)]);
+                    }
+                }
+            }
+            /* wave-functions of the previous batch are no longer needed */
+            ks_prev.reset(nullptr);
+
+            band.solve(*ks, H, true);
+
+            if (Communicator::world().rank() == 0) {
+                for (int ik = 0; ik < ks->num_kpoints(); ik++) {
+                    std::vector<double> bnd_e;
+                    for (int ispn = 0; ispn < ctx->num_spin_dims(); ispn++) {
+                        for (int j = 0; j < ctx->num_bands(); j++) {
+                            band_energies(j, ispn, ik_path[ik]) = (*ks)[ik]->band_energy(j, ispn);
+                            bnd_e.push_back((*ks)[ik]->band_energy(j, ispn));
+                        }
+                    }
+                    json bnd_k;
+                    bnd_k["index"] = ik_path[ik];
+                    bnd_k["kpoint"] = {kpath[ik_path[ik]][0], kpath[ik_path[ik]][1], kpath[ik_path[ik]][2]};
+                    bnd_k["values"] = bnd_e;
+                    ofs_stream << bnd_k.dump() << std::endl;
+                }
+            }
+            ks_prev = std::move(ks);
         }
-        band.solve(ks, H, true);
+        ks_prev.reset(nullptr);
 
-        ks.sync_band_energies();
         if (Communicator::world().rank() == 0) {
             json dict;
             dict["header"] = {};
@@ -322,20 +543,16 @@ void run_tasks(cmd_args const& args)
             }
             dict["bands"] = std::vector<json>();
 
-            for (int ik = 0; ik < ks.num_kpoints(); ik++) {
+            for (int ik = 0; ik < num_kpoints; ik++) {
                 json bnd_k;
-                bnd_k["kpoint"] = std::vector<double>(3, 0);
-                for (int x = 0; x < 3; x++) {
-                    bnd_k["kpoint"][x] = ks[ik]->vk()[x];
-                }
+                bnd_k["kpoint"] = {kpath[ik][0], kpath[ik][1], kpath[ik][2]};
                 std::vector<double> bnd_e;
 
                 for (int ispn = 0; ispn < ctx->num_spin_dims(); ispn++) {
                     for (int j = 0; j < ctx->num_bands(); j++) {
-                        bnd_e.push_back(ks[ik]->band_energy(j, ispn));
+                        bnd_e.push_back(band_energies(j, ispn, ik));
                     }
                 }
-                //ks.get_band_energies(ik, bnd_e.data());
                 bnd_k["values"] = bnd_e;
                 dict["bands"].push_back(bnd_k);
             }
@@ -358,6 +575,8 @@ int main(int argn, char** argv)
     args.register_key("--gen_evp_solver_name=", "{string} generalized eigen-value solver");
     args.register_key("--processing_unit=", "{string} type of the processing unit");
     args.register_key("--repeat_update=", "{int} number of times to repeat update()");
+    args.register_key("--task_list=", "{string} file with the list of input files for the task-farm mode");
+    args.register_key("--num_groups=", "{int} number of groups of MPI ranks in the task-farm mode");
     args.register_key("--control.processing_unit=", "");
     args.register_key("--control.mpi_grid_dims=","");
     args.register_key("--control.std_evp_solver_name=", "");
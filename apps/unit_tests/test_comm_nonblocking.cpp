@@ -0,0 +1,108 @@
+#include <sirius.h>
+
+/* test non-blocking collectives and persistent requests of the communicator */
+
+using namespace sirius;
+
+int test_nonblocking()
+{
+    auto& comm = Communicator::world();
+
+    int rank = comm.rank();
+    int size = comm.size();
+
+    int result{0};
+
+    /* all-gather of variable size blocks */
+    block_data_descriptor d(size);
+    for (int r = 0; r < size; r++) {
+        d.counts[r] = r + 1;
+    }
+    d.calc_offsets();
+    std::vector<double> a(d.size());
+    for (int i = 0; i < d.counts[rank]; i++) {
+        a[d.offsets[rank] + i] = rank + 0.1 * i;
+    }
+    std::vector<Request> req;
+    req.push_back(comm.iallgather(a.data(), d.counts.data(), d.offsets.data()));
+
+    /* broadcast */
+    std::vector<int> b(10, rank);
+    req.push_back(comm.ibcast(b.data(), 10, size - 1));
+
+    /* reduce-scatter */
+    std::vector<double> c(d.size(), 1.0);
+    std::vector<double> c1(d.counts[rank]);
+    req.push_back(comm.ireduce_scatter(c.data(), c1.data(), d.counts.data()));
+
+    /* all-reduce */
+    double e = rank;
+    req.push_back(comm.iallreduce(&e, 1));
+
+    Request::waitall(req);
+
+    for (int r = 0; r < size; r++) {
+        for (int i = 0; i < d.counts[r]; i++) {
+            if (a[d.offsets[r] + i] != r + 0.1 * i) {
+                result++;
+            }
+        }
+    }
+    for (int i = 0; i < 10; i++) {
+        if (b[i] != size - 1) {
+            result++;
+        }
+    }
+    for (int i = 0; i < d.counts[rank]; i++) {
+        if (c1[i] != size) {
+            result++;
+        }
+    }
+    if (e != size * (size - 1) / 2) {
+        result++;
+    }
+
+    /* ring exchange with persistent requests */
+    int x{0};
+    int y{0};
+    std::vector<Request> p2p;
+    p2p.push_back(comm.send_init(&x, 1, (rank + 1) % size, 0));
+    p2p.push_back(comm.recv_init(&y, 1, (rank - 1 + size) % size, 0));
+    for (int iter = 0; iter < 3; iter++) {
+        x = rank * 10 + iter;
+        Request::startall(p2p);
+        Request::waitall(p2p);
+        if (y != ((rank - 1 + size) % size) * 10 + iter) {
+            result++;
+        }
+    }
+    comm.allreduce(&result, 1);
+
+    return result;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    int result = test_nonblocking();
+    if (Communicator::world().rank() == 0) {
+        printf("%-30s", "testing non-blocking MPI: ");
+        if (result) {
+            printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+        } else {
+            printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+        }
+    }
+    sirius::finalize();
+
+    return result;
+}
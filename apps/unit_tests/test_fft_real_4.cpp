@@ -0,0 +1,82 @@
+#include <sirius.h>
+
+/* test the real-to-complex and complex-to-real transformation of a real function */
+
+using namespace sirius;
+
+int run_test(cmd_args& args, device_t pu__)
+{
+    double cutoff = args.value<double>("cutoff", 10);
+
+    matrix3d<double> M;
+    M(0, 0) = M(1, 1) = M(2, 2) = 1.0;
+
+    FFT3D fft(find_translations(cutoff, M), Communicator::world(), pu__);
+
+    Gvec gvec(M, cutoff, Communicator::world(), false);
+    Gvec_partition gvecp(gvec, Communicator::world(), Communicator::self());
+
+    fft.prepare(gvecp);
+
+    /* random real function */
+    mdarray<double, 1> f_rg(fft.local_size());
+    for (int i = 0; i < fft.local_size(); i++) {
+        f_rg[i] = utils::random<double>();
+    }
+
+    /* get plane-wave coefficients with the complex and real transformations */
+    mdarray<double_complex, 1> f_pw(gvecp.gvec_count_fft());
+    mdarray<double_complex, 1> f_pw_r(gvecp.gvec_count_fft());
+    fft.input(&f_rg[0]);
+    fft.transform<-1>(&f_pw[0]);
+    fft.input(&f_rg[0]);
+    fft.transform_real<-1>(&f_pw_r[0]);
+
+    for (int i = 0; i < gvecp.gvec_count_fft(); i++) {
+        if (std::abs(f_pw[i] - f_pw_r[i]) > 1e-12) {
+            return 1;
+        }
+    }
+
+    /* back to real space; the result is a real function with the truncated G-sphere */
+    mdarray<double, 1> g_rg(fft.local_size());
+    mdarray<double, 1> g_rg_r(fft.local_size());
+    fft.transform<1>(&f_pw[0]);
+    fft.output(&g_rg[0]);
+    fft.transform_real<1>(&f_pw[0]);
+    fft.output(&g_rg_r[0]);
+
+    for (int i = 0; i < fft.local_size(); i++) {
+        if (std::abs(g_rg[i] - g_rg_r[i]) > 1e-12) {
+            return 1;
+        }
+    }
+
+    fft.dismiss();
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--cutoff=", "{double} cutoff radius in G-space");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args, CPU);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
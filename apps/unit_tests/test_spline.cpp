@@ -171,6 +171,44 @@ void test_spline_6()
     }
 }
 
+// Test packed set of splines against individual splines.
+void test_spline_set()
+{
+    int n = 7;
+    Radial_grid_lin<double> rgrid(500, 0, 10);
+
+    std::vector<Spline<double>> s(n);
+    Spline_set<double> sset(n, rgrid.num_points());
+    for (int j = 0; j < n; j++) {
+        s[j] = Spline<double>(rgrid, [j](double x){return std::sin((j + 1) * x) * std::exp(-0.1 * x);});
+        sset.set(j, s[j]);
+    }
+
+    std::vector<double> val(n);
+    for (int i = 0; i < rgrid.num_points() - 1; i++) {
+        double dx = 0.37 * rgrid.dx(i);
+        sset(i, dx, val.data());
+        for (int j = 0; j < n; j++) {
+            if (std::abs(val[j] - s[j](i, dx)) > 1e-14) {
+                printf("wrong value of packed spline %i at point %i\n", j, i);
+                exit(1);
+            }
+        }
+    }
+    /* last point of the grid */
+    int i = rgrid.num_points() - 1;
+    sset(i, 0, val.data());
+    for (int j = 0; j < n; j++) {
+        if (std::abs(val[j] - s[j](i)) > 1e-14) {
+            printf("wrong value of packed spline %i at the last point\n", j);
+            exit(1);
+        }
+    }
+    /* empty set is a no-op */
+    Spline_set<double> empty;
+    empty(i, 0, val.data());
+}
+
 void test1(double x0, double x1, int m, double exact_result)
 {
     printf("\n");
@@ -493,6 +531,7 @@ int main(int argn, char** argv)
     test_spline_4();
     test_spline_5();
     test_spline_6();
+    test_spline_set();
 
     //double x0 = 0.00001;
     //test2(linear_grid, x0, 2.0);
@@ -1,9 +1,9 @@
 #!/bin/bash
 
 tests='test_init test_nan test_ylm test_sinx_cosx test_gvec test_fft_correctness_1 
-test_fft_correctness_2 test_fft_real_1 test_fft_real_2 test_fft_real_3 test_spline 
+test_fft_correctness_2 test_fft_real_1 test_fft_real_2 test_fft_real_3 test_fft_real_4 test_spline 
 test_rot_ylm test_linalg test_wf_ortho test_serialize test_mempool test_roundoff 
-test_sht_lapl'
+test_sht_lapl test_comm_nonblocking'
 
 for test in $tests; do
   echo "running '${test}'"
@@ -0,0 +1,123 @@
+# Convert a species file (SIRIUS json or UPF) to the binary CBOR or MessagePack format.
+#
+# Usage: python json_to_binary.py Si.json [--msgpack]
+#        python json_to_binary.py Si.UPF [--msgpack]
+#
+# The output file has the same base name and .cbor (default) or .msgpack extension. Binary species files
+# are read by SIRIUS in the same way as the json files, e.g. "atom_files" : {"Si" : "Si.cbor"}.
+import json
+import struct
+import sys
+import os
+import upf_to_json
+
+def _head(major, n, out):
+    if n < 24:
+        out.append(struct.pack('>B', (major << 5) | n))
+    elif n < 2**8:
+        out.append(struct.pack('>BB', (major << 5) | 24, n))
+    elif n < 2**16:
+        out.append(struct.pack('>BH', (major << 5) | 25, n))
+    elif n < 2**32:
+        out.append(struct.pack('>BI', (major << 5) | 26, n))
+    else:
+        out.append(struct.pack('>BQ', (major << 5) | 27, n))
+
+def encode_cbor(obj, out):
+    if obj is None:
+        out.append(b'\xf6')
+    elif obj is True:
+        out.append(b'\xf5')
+    elif obj is False:
+        out.append(b'\xf4')
+    elif isinstance(obj, int):
+        if obj >= 0:
+            _head(0, obj, out)
+        else:
+            _head(1, -1 - obj, out)
+    elif isinstance(obj, float):
+        out.append(b'\xfb' + struct.pack('>d', obj))
+    elif isinstance(obj, str):
+        b = obj.encode('utf-8')
+        _head(3, len(b), out)
+        out.append(b)
+    elif isinstance(obj, (list, tuple)):
+        _head(4, len(obj), out)
+        for e in obj:
+            encode_cbor(e, out)
+    elif isinstance(obj, dict):
+        _head(5, len(obj), out)
+        for k, v in obj.items():
+            encode_cbor(str(k), out)
+            encode_cbor(v, out)
+    else:
+        raise TypeError('unsupported type: %s' % type(obj))
+
+def encode_msgpack(obj, out):
+    if obj is None:
+        out.append(b'\xc0')
+    elif obj is True:
+        out.append(b'\xc3')
+    elif obj is False:
+        out.append(b'\xc2')
+    elif isinstance(obj, int):
+        if 0 <= obj < 128:
+            out.append(struct.pack('>B', obj))
+        elif -32 <= obj < 0:
+            out.append(struct.pack('>b', obj))
+        elif obj >= 0:
+            out.append(b'\xcf' + struct.pack('>Q', obj))
+        else:
+            out.append(b'\xd3' + struct.pack('>q', obj))
+    elif isinstance(obj, float):
+        out.append(b'\xcb' + struct.pack('>d', obj))
+    elif isinstance(obj, str):
+        b = obj.encode('utf-8')
+        if len(b) < 32:
+            out.append(struct.pack('>B', 0xa0 | len(b)))
+        else:
+            out.append(b'\xdb' + struct.pack('>I', len(b)))
+        out.append(b)
+    elif isinstance(obj, (list, tuple)):
+        out.append(b'\xdd' + struct.pack('>I', len(obj)))
+        for e in obj:
+            encode_msgpack(e, out)
+    elif isinstance(obj, dict):
+        out.append(b'\xdf' + struct.pack('>I', len(obj)))
+        for k, v in obj.items():
+            encode_msgpack(str(k), out)
+            encode_msgpack(v, out)
+    else:
+        raise TypeError('unsupported type: %s' % type(obj))
+
+def main():
+    if len(sys.argv) < 2:
+        print('Usage: python json_to_binary.py species_file [--msgpack]')
+        sys.exit(0)
+
+    file_name = sys.argv[1]
+    fmt = 'msgpack' if '--msgpack' in sys.argv else 'cbor'
+
+    if file_name.endswith('.json'):
+        with open(file_name) as inp:
+            pp_dict = json.load(inp)
+        base = os.path.splitext(file_name)[0]
+    else:
+        pp_dict = upf_to_json.parse_upf_from_file(file_name)
+        if pp_dict is None:
+            print('unknown format of %s' % file_name)
+            sys.exit(1)
+        pp_dict['pseudo_potential']['header']['original_upf_file'] = file_name
+        base = pp_dict['pseudo_potential']['header']['element']
+
+    out = []
+    if fmt == 'cbor':
+        encode_cbor(pp_dict, out)
+    else:
+        encode_msgpack(pp_dict, out)
+
+    with open(base + '.' + fmt, 'wb') as fout:
+        fout.write(b''.join(out))
+
+if __name__ == "__main__":
+    main()
@@ -410,12 +410,27 @@ PYBIND11_MODULE(py_sirius, m)
                  json js = dft.check_scf_density();
                  return pj_convert(js);
              })
+        .def("set_scf_telemetry_callback",
+             [](DFT_ground_state& dft, py::function f)
+             {
+                 dft.scf_telemetry_callback([f](json const& js)
+                                            {
+                                                json record = js;
+                                                f(pj_convert(record));
+                                            });
+             },
+             "callback"_a)
         .def("k_point_set", &DFT_ground_state::k_point_set, py::return_value_policy::reference_internal)
         .def("hamiltonian", &DFT_ground_state::hamiltonian, py::return_value_policy::reference_internal)
         .def("potential", &DFT_ground_state::potential, py::return_value_policy::reference_internal)
         .def("forces", &DFT_ground_state::forces, py::return_value_policy::reference_internal)
         .def("stress", &DFT_ground_state::stress, py::return_value_policy::reference_internal)
         .def("update", &DFT_ground_state::update)
+        .def("update_atomic_positions",
+             [](DFT_ground_state& dft, py::buffer positions) {
+                 set_atom_positions(dft.k_point_set().ctx().unit_cell(), positions);
+                 dft.update();
+             })
         .def("energy_kin_sum_pw", &DFT_ground_state::energy_kin_sum_pw);
 
     py::class_<K_point>(m, "K_point")
@@ -665,7 +680,8 @@ PYBIND11_MODULE(py_sirius, m)
 
     py::class_<Stress>(m, "Stress")
         .def(py::init<Simulation_context&, Density&, Potential&, Hamiltonian&, K_point_set&>())
-        .def("calc_stress_total", &Stress::calc_stress_total, py::return_value_policy::reference_internal)
+        .def("calc_stress_total", py::overload_cast<>(&Stress::calc_stress_total), py::return_value_policy::reference_internal)
+        .def("calc_stress_total", py::overload_cast<Force&>(&Stress::calc_stress_total), py::return_value_policy::reference_internal)
         .def("calc_stress_har", &Stress::calc_stress_har, py::return_value_policy::reference_internal)
         .def("calc_stress_ewald", &Stress::calc_stress_ewald, py::return_value_policy::reference_internal)
         .def("calc_stress_xc", &Stress::calc_stress_xc, py::return_value_policy::reference_internal)
@@ -704,7 +720,8 @@ PYBIND11_MODULE(py_sirius, m)
 
     py::class_<Force>(m, "Force")
         .def(py::init<Simulation_context&, Density&, Potential&, Hamiltonian&, K_point_set&>())
-        .def("calc_forces_total", &Force::calc_forces_total, py::return_value_policy::reference_internal)
+        .def("calc_forces_total", py::overload_cast<>(&Force::calc_forces_total), py::return_value_policy::reference_internal)
+        .def("calc_forces_total", py::overload_cast<bool>(&Force::calc_forces_total), py::return_value_policy::reference_internal)
         .def_property_readonly("ewald", &Force::forces_ewald)
         .def_property_readonly("hubbard", &Force::forces_hubbard)
         .def_property_readonly("vloc", &Force::forces_vloc)
@@ -76,12 +76,15 @@ class Band // TODO: Band class is lightweight and in principle can be converted
     inline int diag_pseudo_potential_davidson(K_point* kp__, Hamiltonian& H__) const;
 
     /// RMM-DIIS diagonalization.
+    /** Davidson solver is used at the beginning of the SCF cycle. Returns the number of Hamiltonian applications
+     *  per block of bands. */
     template <typename T>
-    inline void diag_pseudo_potential_rmm_diis(K_point* kp__, int ispn__, Hamiltonian& H__) const;
+    inline int diag_pseudo_potential_rmm_diis(K_point* kp__, Hamiltonian& H__) const;
 
+    /// Chebyshev-filtered subspace iteration.
+    /** Returns the total degree of the applied filters. */
     template <typename T>
-    inline void
-    diag_pseudo_potential_chebyshev(K_point* kp__, int ispn__, Hamiltonian& H__, P_operator<T>& p_op__) const;
+    inline int diag_pseudo_potential_chebyshev(K_point* kp__, Hamiltonian& H__) const;
 
     /// Auxiliary function used internally by residuals() function.
     inline mdarray<double, 1> residuals_aux(K_point* kp__,
@@ -95,6 +98,8 @@ class Band // TODO: Band class is lightweight and in principle can be converted
                                             mdarray<double, 1>& o_diag__) const;
 
     /// Compute residuals.
+    /** The bands are counted starting from the band index i0 (bands below i0 are locked). If converged is
+     *  provided, it is filled with the flags of converged bands. */
     template <typename T>
     inline int residuals(K_point* kp__,
                          int ispn__,
@@ -109,7 +114,9 @@ class Band // TODO: Band class is lightweight and in principle can be converted
                          Wave_functions& opsi__,
                          Wave_functions& res__,
                          mdarray<double, 2>& h_diag__,
-                         mdarray<double, 1>& o_diag__) const;
+                         mdarray<double, 1>& o_diag__,
+                         int i0__ = 0,
+                         std::vector<int>* converged__ = nullptr) const;
 
     template <typename T>
     void check_residuals(K_point& kp__, Hamiltonian& H__) const;
@@ -23,17 +23,6 @@
  */
 
 
-#if defined(__GPU) && defined(__CUDA)
-#include "../SDDK/GPU/acc.hpp"
-extern "C" void compute_chebyshev_polynomial_gpu(int num_gkvec,
-                                                 int n,
-                                                 double c,
-                                                 double r,
-                                                 acc_complex_double_t* phi0,
-                                                 acc_complex_double_t* phi1,
-                                                 acc_complex_double_t* phi2);
-#endif
-
 template <typename T>
 int Band::diag_pseudo_potential(K_point* kp__, Hamiltonian& H__) const
 {
@@ -56,22 +45,9 @@ int Band::diag_pseudo_potential(K_point* kp__, Hamiltonian& H__) const
     } else if (itso.type_ == "davidson") {
         niter = diag_pseudo_potential_davidson<T>(kp__, H__);
     } else if (itso.type_ == "rmm-diis") {
-        if (ctx_.num_mag_dims() != 3) {
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                diag_pseudo_potential_rmm_diis<T>(kp__, ispn, H__);
-            }
-        } else {
-            STOP();
-        }
+        niter = diag_pseudo_potential_rmm_diis<T>(kp__, H__);
     } else if (itso.type_ == "chebyshev") {
-        P_operator<T> p_op(ctx_, kp__->p_mtrx());
-        if (ctx_.num_mag_dims() != 3) {
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                diag_pseudo_potential_chebyshev<T>(kp__, ispn, H__, p_op);
-            }
-        } else {
-            STOP();
-        }
+        niter = diag_pseudo_potential_chebyshev<T>(kp__, H__);
     } else {
         TERMINATE("unknown iterative solver type");
     }
@@ -271,6 +247,9 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
     /* maximum subspace size */
     int num_phi = itso.subspace_size_ * num_bands;
 
+    /* lock converged bands on subspace restarts; requires orthogonal basis and host memory */
+    const bool locking = itso.locking_ && itso.orthogonalize_ && !is_device_memory(ctx_.preferred_memory_t());
+
     if (num_phi > kp__->num_gkvec()) {
         std::stringstream s;
         s << "subspace size is too large!";
@@ -300,6 +279,9 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
     /* residuals */
     Wave_functions res(mp, kp__->gkvec_partition(), num_bands, ctx_.preferred_memory_t(), num_sc);
 
+    /* S operator, applied to locked Psi wave-functions */
+    Wave_functions spsi_lk(mp, kp__->gkvec_partition(), locking ? num_bands : 1, ctx_.preferred_memory_t(), num_sc);
+
     const int bs = ctx_.cyclic_block_size();
 
     dmatrix<T> hmlt(mp, num_phi, num_phi, ctx_.blacs_grid(), bs, bs);
@@ -460,14 +442,21 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
         /* number of newly added basis functions */
         int n{0};
 
+        /* number of locked bands; they occupy the first nlk positions of psi and are excluded from the subspace */
+        int nlk{0};
+        /* number of bands which are still iterated */
+        int num_active = num_bands;
+        /* flags of converged bands, returned by residuals() */
+        std::vector<int> is_converged;
+
         /* second phase: start iterative diagonalization */
         for (int k = 0; k < itso.num_steps_; k++) {
 
             /* don't compute residuals on last iteration */
             if (k != itso.num_steps_ - 1) {
                 /* get new preconditionined residuals, and also hpsi and opsi as a by-product */
-                n = residuals<T>(kp__, nc_mag ? 2 : ispin_step, N, num_bands, eval, eval_old, evec, hphi,
-                                 sphi, hpsi, spsi, res, h_diag, o_diag);
+                n = residuals<T>(kp__, nc_mag ? 2 : ispin_step, N, num_active, eval, eval_old, evec, hphi,
+                                 sphi, hpsi, spsi, res, h_diag, o_diag, nlk, locking ? &is_converged : nullptr);
             }
 
             /* check if we run out of variational space or eigen-vectors are converged or it's a last iteration */
@@ -478,10 +467,10 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
                 if (ctx_.settings().always_update_wf_ || k + n > 0) {
                     /* in case of non-collinear magnetism transform two components */
                     transform<T>(ctx_.preferred_memory_t(), ctx_.blas_linalg_t(), nc_mag ? 2 : ispin_step, {&phi}, 0, N, evec, 0, 0,
-                                 {&psi}, 0, num_bands);
+                                 {&psi}, nlk, num_active);
                     /* update eigen-values */
-                    for (int j = 0; j < num_bands; j++) {
-                        kp__->band_energy(j, ispin_step, eval[j]);
+                    for (int j = 0; j < num_active; j++) {
+                        kp__->band_energy(nlk + j, ispin_step, eval[j]);
                     }
                 } else {
                     if (ctx_.control().verbosity_ >= 2 && kp__->comm().rank() == 0) {
@@ -496,32 +485,52 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
                     if (ctx_.control().verbosity_ >= 3 && kp__->comm().rank() == 0) {
                         printf("subspace size limit reached\n");
                     }
+                    /* need to compute all hpsi and opsi states (not only unconverged) */
+                    if (converge_by_energy) {
+                        transform<T>(ctx_.preferred_memory_t(), ctx_.blas_linalg_t(), nc_mag ? 2 : ispin_step, 1.0,
+                                     std::vector<Wave_functions*>({&hphi, &sphi}), 0, N, evec, 0, 0, 0.0,
+                                     {&hpsi, &spsi}, 0, num_active);
+                    }
+
+                    /* lock the lowest contiguous block of converged bands; at least one band stays active */
+                    int nc{0};
+                    if (locking) {
+                        while (nc < num_active - 1 && is_converged[nc]) {
+                            nc++;
+                        }
+                        for (int ispn = 0; ispn < num_sc && nc > 0; ispn++) {
+                            spsi_lk.copy_from(spsi, nc, ispn, 0, ispn, nlk);
+                        }
+                        for (int j = 0; j < num_active - nc; j++) {
+                            eval[j]     = eval[j + nc];
+                            eval_old[j] = eval_old[j + nc];
+                        }
+                        nlk += nc;
+                        num_active -= nc;
+                        if (nc && ctx_.control().verbosity_ >= 3 && kp__->comm().rank() == 0) {
+                            printf("number of locked bands: %i\n", nlk);
+                        }
+                    }
+
                     hmlt_old.zero();
-                    for (int i = 0; i < num_bands; i++) {
+                    for (int i = 0; i < num_active; i++) {
                         hmlt_old.set(i, i, eval[i]);
                     }
                     if (!itso.orthogonalize_) {
                         ovlp_old.zero();
-                        for (int i = 0; i < num_bands; i++) {
+                        for (int i = 0; i < num_active; i++) {
                             ovlp_old.set(i, i, 1);
                         }
                     }
 
-                    /* need to compute all hpsi and opsi states (not only unconverged) */
-                    if (converge_by_energy) {
-                        transform<T>(ctx_.preferred_memory_t(), ctx_.blas_linalg_t(), nc_mag ? 2 : ispin_step, 1.0,
-                                     std::vector<Wave_functions*>({&hphi, &sphi}), 0, N, evec, 0, 0, 0.0,
-                                     {&hpsi, &spsi}, 0, num_bands);
-                    }
-
                     /* update basis functions, hphi and ophi */
                     for (int ispn = 0; ispn < num_sc; ispn++) {
-                        phi.copy_from(psi, num_bands, nc_mag ? ispn : ispin_step, 0, nc_mag ? ispn : 0, 0);
-                        hphi.copy_from(hpsi, num_bands, ispn, 0, ispn, 0);
-                        sphi.copy_from(spsi, num_bands, ispn, 0, ispn, 0);
+                        phi.copy_from(psi, num_active, nc_mag ? ispn : ispin_step, nlk, nc_mag ? ispn : 0, 0);
+                        hphi.copy_from(hpsi, num_active, ispn, nc, ispn, 0);
+                        sphi.copy_from(spsi, num_active, ispn, nc, ispn, 0);
                     }
                     /* number of basis functions that we already have */
-                    N = num_bands;
+                    N = num_active;
                 }
             }
 
@@ -530,11 +539,21 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
                 phi.copy_from(res, n, ispn, 0, ispn, N);
             }
 
+            /* project out the locked bands: \phi_{i} -= \sum_{j} \psi_{j} <S\psi_{j}|\phi_{i}> */
+            if (nlk > 0) {
+                dmatrix<T> o_lk(nlk, n);
+                inner(ctx_.preferred_memory_t(), ctx_.blas_linalg_t(), nc_mag ? 2 : ispin_step, spsi_lk, 0, nlk, phi, N, n,
+                      o_lk, 0, 0);
+                transform<T>(ctx_.preferred_memory_t(), ctx_.blas_linalg_t(), nc_mag ? 2 : ispin_step, -1.0,
+                             std::vector<Wave_functions*>({&psi}), 0, nlk, o_lk, 0, 0, 1.0, {&phi}, N, n);
+            }
+
             /* apply Hamiltonian and S operators to the new basis functions */
             H__.apply_h_s<T>(kp__, nc_mag ? 2 : ispin_step, N, n, phi, &hphi, &sphi);
 
             if (itso.orthogonalize_) {
-                orthogonalize<T>(ctx_.preferred_memory_t(), ctx_.blas_linalg_t(), nc_mag ? 2 : 0, phi, hphi, sphi, N, n, ovlp, res);
+                orthogonalize<T>(ctx_.preferred_memory_t(), ctx_.blas_linalg_t(), nc_mag ? 2 : 0, phi, hphi, sphi, N, n, ovlp, res,
+                                 get_ortho_method_t(itso.orthogonalization_method_));
             }
 
             /* setup eigen-value problem
@@ -573,14 +592,14 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
             utils::timer t1("sirius::Band::diag_pseudo_potential_davidson|evp");
             if (itso.orthogonalize_) {
                 /* solve standard eigen-value problem with the size N */
-                if (std_solver.solve(N, num_bands, hmlt, eval.data(), evec)) {
+                if (std_solver.solve(N, num_active, hmlt, eval.data(), evec)) {
                     std::stringstream s;
                     s << "error in diagonalziation";
                     TERMINATE(s);
                 }
             } else {
                 /* solve generalized eigen-value problem with the size N */
-                if (gen_solver.solve(N, num_bands, hmlt, ovlp, eval.data(), evec)) {
+                if (gen_solver.solve(N, num_active, hmlt, ovlp, eval.data(), evec)) {
                     std::stringstream s;
                     s << "error in diagonalziation";
                     TERMINATE(s);
@@ -593,9 +612,9 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
             if (ctx_.control().verbosity_ >= 2 && kp__->comm().rank() == 0) {
                 printf("step: %i, current subspace size: %i, maximum subspace size: %i\n", k, N, num_phi);
                 if (ctx_.control().verbosity_ >= 4) {
-                    for (int i = 0; i < num_bands; i++) {
-                        printf("eval[%i]=%20.16f, diff=%20.16f, occ=%20.16f\n", i, eval[i], std::abs(eval[i] - eval_old[i]),
-                             kp__->band_occupancy(i, ispin_step));
+                    for (int i = 0; i < num_active; i++) {
+                        printf("eval[%i]=%20.16f, diff=%20.16f, occ=%20.16f\n", nlk + i, eval[i], std::abs(eval[i] - eval_old[i]),
+                             kp__->band_occupancy(nlk + i, ispin_step));
                     }
                 }
             }
@@ -639,210 +658,222 @@ inline int Band::diag_pseudo_potential_davidson(K_point*       kp__,
 }
 
 template <typename T>
-inline void Band::diag_pseudo_potential_chebyshev(K_point* kp__,
-                                                  int ispn__,
-                                                  Hamiltonian &H__,
-                                                  P_operator<T>& p_op__) const
+inline int Band::diag_pseudo_potential_chebyshev(K_point* kp__, Hamiltonian& H__) const
 {
     PROFILE("sirius::Band::diag_pseudo_potential_chebyshev");
 
-//==     auto pu = ctx_.processing_unit();
-//==
-//==     /* short notation for number of target wave-functions */
-//==     int num_bands = ctx_.num_fv_states();
-//==
-//==     auto& itso = ctx_.iterative_solver_input_section();
-//==
-//==     /* short notation for target wave-functions */
-//==     auto& psi = kp__->spinor_wave_functions<false>(ispn__);
-//==
-//== //==
-//== //==     //auto& beta_pw_panel = kp__->beta_pw_panel();
-//== //==     //dmatrix<double_complex> S(unit_cell_.mt_basis_size(), unit_cell_.mt_basis_size(), kp__->blacs_grid());
-//== //==     //linalg<CPU>::gemm(2, 0, unit_cell_.mt_basis_size(), unit_cell_.mt_basis_size(), kp__->num_gkvec(), complex_one,
-//== //==     //                  beta_pw_panel, beta_pw_panel, complex_zero, S);
-//== //==     //for (int ia = 0; ia < unit_cell_.num_atoms(); ia++)
-//== //==     //{
-//== //==     //    auto type = unit_cell_.atom(ia)->type();
-//== //==     //    int nbf = type->mt_basis_size();
-//== //==     //    int ofs = unit_cell_.atom(ia)->offset_lo();
-//== //==     //    matrix<double_complex> qinv(nbf, nbf);
-//== //==     //    type->uspp().q_mtrx >> qinv;
-//== //==     //    linalg<CPU>::geinv(nbf, qinv);
-//== //==     //    for (int i = 0; i < nbf; i++)
-//== //==     //    {
-//== //==     //        for (int j = 0; j < nbf; j++) S.add(ofs + j, ofs + i, qinv(j, i));
-//== //==     //    }
-//== //==     //}
-//== //==     //linalg<CPU>::geinv(unit_cell_.mt_basis_size(), S);
-//== //==
-//== //==
-//==     /* maximum order of Chebyshev polynomial*/
-//==     int order = itso.num_steps_ + 2;
-//==
-//==     std::vector< Wave_functions<false>* > phi(order);
-//==     for (int i = 0; i < order; i++) {
-//==         phi[i] = new Wave_functions<false>(kp__->num_gkvec_loc(), num_bands, pu);
-//==     }
-//==
-//==     Wave_functions<false> hphi(kp__->num_gkvec_loc(), num_bands, pu);
-//==
-//==     /* trial basis functions */
-//==     phi[0]->copy_from(psi, 0, num_bands);
-//==
-//==     /* apply Hamiltonian to the basis functions */
-//==     apply_h<T>(kp__, ispn__, 0, num_bands, *phi[0], hphi, h_op__, d_op__);
-//==
-//==     /* compute Rayleight quotients */
-//==     std::vector<double> e0(num_bands, 0.0);
-//==     if (pu == CPU) {
-//==         #pragma omp parallel for schedule(static)
-//==         for (int i = 0; i < num_bands; i++) {
-//==             for (int igk = 0; igk < kp__->num_gkvec_loc(); igk++) {
-//==                 e0[i] += std::real(std::conj((*phi[0])(igk, i)) * hphi(igk, i));
-//==             }
-//==         }
-//==     }
-//==     kp__->comm().allreduce(e0);
-//==
-//==     //== if (parameters_.processing_unit() == GPU)
-//==     //== {
-//==     //==     #ifdef __GPU
-//==     //==     mdarray<double, 1> e0_loc(kp__->spl_fv_states().local_size());
-//==     //==     e0_loc.allocate_on_device();
-//==     //==     e0_loc.zero_on_device();
-//==
-//==     //==     compute_inner_product_gpu(kp__->num_gkvec_row(),
-//==     //==                               (int)kp__->spl_fv_states().local_size(),
-//==     //==                               phi[0].at<GPU>(),
-//==     //==                               hphi.at<GPU>(),
-//==     //==                               e0_loc.at<GPU>());
-//==     //==     e0_loc.copy_to_host();
-//==     //==     for (int iloc = 0; iloc < (int)kp__->spl_fv_states().local_size(); iloc++)
-//==     //==     {
-//==     //==         int i = kp__->spl_fv_states(iloc);
-//==     //==         e0[i] = e0_loc(iloc);
-//==     //==     }
-//==     //==     #endif
-//==     //== }
-//==     //==
-//==
-//==     /* estimate low and upper bounds of the Chebyshev filter */
-//==     double lambda0 = -1e10;
-//==     //double emin = 1e100;
-//==     for (int i = 0; i < num_bands; i++)
-//==     {
-//==         lambda0 = std::max(lambda0, e0[i]);
-//==         //emin = std::min(emin, e0[i]);
-//==     }
-//==     double lambda1 = 0.5 * std::pow(ctx_.gk_cutoff(), 2);
-//==
-//==     double r = (lambda1 - lambda0) / 2.0;
-//==     double c = (lambda1 + lambda0) / 2.0;
-//==
-//==     auto apply_p = [kp__, &p_op__, num_bands](Wave_functions<false>& phi, Wave_functions<false>& op_phi) {
-//==         op_phi.copy_from(phi, 0, num_bands);
-//==         //for (int i = 0; i < kp__->beta_projectors().num_beta_chunks(); i++) {
-//==         //    kp__->beta_projectors().generate(i);
-//==
-//==         //    kp__->beta_projectors().inner<T>(i, phi, 0, num_bands);
-//==
-//==         //    p_op__.apply(i, 0, op_phi, 0, num_bands);
-//==         //}
-//==     };
-//==
-//==     apply_p(hphi, *phi[1]);
-//==
-//==     /* compute \psi_1 = (S^{-1}H\psi_0 - c\psi_0) / r */
-//==     if (pu == CPU) {
-//==         #pragma omp parallel for schedule(static)
-//==         for (int i = 0; i < num_bands; i++) {
-//==             for (int igk = 0; igk < kp__->num_gkvec_loc(); igk++) {
-//==                 (*phi[1])(igk, i) = ((*phi[1])(igk, i) - (*phi[0])(igk, i) * c) / r;
-//==             }
-//==         }
-//==     }
-//== //==     //if (parameters_.processing_unit() == GPU)
-//== //==     //{
-//== //==     //    #ifdef __GPU
-//== //==     //    compute_chebyshev_polynomial_gpu(kp__->num_gkvec_row(), (int)kp__->spl_fv_states().local_size(), c, r,
-//== //==     //                                     phi[0].at<GPU>(), phi[1].at<GPU>(), NULL);
-//== //==     //    phi[1].panel().copy_to_host();
-//== //==     //    #endif
-//== //==     //}
-//== //==
-//==
-//==     /* compute higher polynomial orders */
-//==     for (int k = 2; k < order; k++) {
-//==
-//==         apply_h<T>(kp__, ispn__, 0, num_bands, *phi[k - 1], hphi, h_op__, d_op__);
-//==
-//==         apply_p(hphi, *phi[k]);
-//==
-//==         if (pu == CPU) {
-//==             #pragma omp parallel for schedule(static)
-//==             for (int i = 0; i < num_bands; i++) {
-//==                 for (int igk = 0; igk < kp__->num_gkvec_loc(); igk++) {
-//==                     (*phi[k])(igk, i) = ((*phi[k])(igk, i) - c * (*phi[k - 1])(igk, i)) * 2.0 / r - (*phi[k - 2])(igk, i);
-//==                 }
-//==             }
-//==         }
-//==         //== if (parameters_.processing_unit() == GPU)
-//==         //== {
-//==         //==     #ifdef __GPU
-//==         //==     compute_chebyshev_polynomial_gpu(kp__->num_gkvec(), num_bands, c, r,
-//==         //==                                      phi[k - 2].at<GPU>(), phi[k - 1].at<GPU>(), phi[k].at<GPU>());
-//==         //==     phi[k].copy_to_host();
-//==         //==     #endif
-//==         //== }
-//==     }
-//==
-//==     /* allocate Hamiltonian and overlap */
-//==     matrix<T> hmlt(num_bands, num_bands);
-//==     matrix<T> ovlp(num_bands, num_bands);
-//==     matrix<T> evec(num_bands, num_bands);
-//==     matrix<T> hmlt_old;
-//==     matrix<T> ovlp_old;
-//==
-//==     int bs = ctx_.cyclic_block_size();
-//==
-//==     dmatrix<T> hmlt_dist;
-//==     dmatrix<T> ovlp_dist;
-//==     dmatrix<T> evec_dist;
-//==     if (kp__->comm().size() == 1) {
-//==         hmlt_dist = dmatrix<T>(&hmlt(0, 0), num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
-//==         ovlp_dist = dmatrix<T>(&ovlp(0, 0), num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
-//==         evec_dist = dmatrix<T>(&evec(0, 0), num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
-//==     } else {
-//==         hmlt_dist = dmatrix<T>(num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
-//==         ovlp_dist = dmatrix<T>(num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
-//==         evec_dist = dmatrix<T>(num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
-//==     }
-//==
-//==     std::vector<double> eval(num_bands);
-//==
-//==     /* apply Hamiltonian and overlap operators to the new basis functions */
-//==     apply_h_o<T>(kp__, ispn__, 0, num_bands, *phi[order - 1], hphi, *phi[0], h_op__, d_op__, q_op__);
-//==
-//==     //orthogonalize<T>(kp__, N, n, phi, hphi, ophi, ovlp);
-//==
-//==     /* setup eigen-value problem */
-//==     set_h_o<T>(kp__, 0, num_bands, *phi[order - 1], hphi, *phi[0], hmlt, ovlp, hmlt_old, ovlp_old);
-//==
-//==     /* solve generalized eigen-value problem with the size N */
-//==     diag_h_o<T>(kp__, num_bands, num_bands, hmlt, ovlp, evec, hmlt_dist, ovlp_dist, evec_dist, eval);
-//==
-//==     /* recompute wave-functions */
-//==     /* \Psi_{i} = \sum_{mu} \phi_{mu} * Z_{mu, i} */
-//==     psi.transform_from<T>(*phi[order - 1], num_bands, evec, num_bands);
-//==
-//==     for (int j = 0; j < ctx_.num_fv_states(); j++) {
-//==         kp__->band_energy(j + ispn__ * ctx_.num_fv_states()) = eval[j];
-//==     }
-//==
-//==     for (int i = 0; i < order; i++) {
-//==         delete phi[i];
-//==     }
+    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+        if (unit_cell_.atom_type(iat).augment()) {
+            TERMINATE("Chebyshev solver is implemented only for norm-conserving pseudopotentials");
+        }
+    }
+    if (ctx_.processing_unit() == device_t::GPU) {
+        TERMINATE("Chebyshev solver is not implemented for GPU");
+    }
+
+    auto& itso = ctx_.iterative_solver_input();
+
+    /* true if this is a non-collinear case */
+    const bool nc_mag = (ctx_.num_mag_dims() == 3);
+
+    /* number of spin components, treated simultaneously */
+    const int num_sc = nc_mag ? 2 : 1;
+
+    /* short notation for number of target wave-functions */
+    const int num_bands = ctx_.num_bands();
+
+    /* short notation for target wave-functions */
+    auto& psi = kp__->spinor_wave_functions();
+
+    auto mem = ctx_.preferred_memory_t();
+    auto la  = ctx_.blas_linalg_t();
+
+    /* spin index of the auxiliary wave-functions */
+    const int ispn_wf = nc_mag ? 2 : 0;
+
+    Wave_functions phi0(kp__->gkvec_partition(), num_bands, mem, num_sc);
+    Wave_functions phi1(kp__->gkvec_partition(), num_bands, mem, num_sc);
+    Wave_functions hphi(kp__->gkvec_partition(), num_bands, mem, num_sc);
+    Wave_functions res(kp__->gkvec_partition(), num_bands, mem, num_sc);
+
+    /* Lanczos vectors */
+    Wave_functions v0(kp__->gkvec_partition(), 1, mem, num_sc);
+    Wave_functions v1(kp__->gkvec_partition(), 1, mem, num_sc);
+    Wave_functions f(kp__->gkvec_partition(), 1, mem, num_sc);
+
+    const int bs = ctx_.cyclic_block_size();
+    dmatrix<T> hmlt(num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
+    dmatrix<T> ovlp(num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
+    dmatrix<T> evec(num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
+
+    auto& std_solver = ctx_.std_evp_solver();
+
+    /* y <- a * x + b * y for the first n wave-functions */
+    auto axpby = [num_sc](int n, double a, Wave_functions& x, double b, Wave_functions& y)
+    {
+        for (int is = 0; is < num_sc; is++) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < n; i++) {
+                for (int ig = 0; ig < y.pw_coeffs(is).num_rows_loc(); ig++) {
+                    y.pw_coeffs(is).prime(ig, i) = (b == 0) ? a * x.pw_coeffs(is).prime(ig, i) :
+                        a * x.pw_coeffs(is).prime(ig, i) + b * y.pw_coeffs(is).prime(ig, i);
+                }
+            }
+        }
+    };
+
+    /* real part of <x|y> */
+    auto dot = [&](Wave_functions& x, Wave_functions& y)
+    {
+        dmatrix<T> s(1, 1);
+        inner(mem, la, ispn_wf, x, 0, 1, y, 0, 1, s, 0, 0);
+        return std::real(s(0, 0));
+    };
+
+    /* Rayleigh-Ritz step in the subspace of phi; hphi is the Hamiltonian applied to phi */
+    auto rayleigh_ritz = [&](int ispin_step, Wave_functions& phi)
+    {
+        orthogonalize<T>(mem, la, ispn_wf, phi, hphi, 0, num_bands, ovlp, res,
+                         get_ortho_method_t(itso.orthogonalization_method_));
+        set_subspace_mtrx(0, num_bands, phi, hphi, hmlt);
+
+        std::vector<double> eval(num_bands);
+        if (std_solver.solve(num_bands, num_bands, hmlt, eval.data(), evec)) {
+            TERMINATE("error in diagonalziation");
+        }
+        evp_work_count() += 1;
+
+        transform<T>(mem, la, nc_mag ? 2 : ispin_step, {&phi}, 0, num_bands, evec, 0, 0, {&psi}, 0, num_bands);
+        for (int j = 0; j < num_bands; j++) {
+            kp__->band_energy(j, ispin_step, eval[j]);
+        }
+    };
+
+    kp__->beta_projectors().prepare();
+
+    int niter{0};
+
+    for (int ispin_step = 0; ispin_step < ctx_.num_spin_dims(); ispin_step++) {
+        /* spin index of the Hamiltonian */
+        const int ispn_h = nc_mag ? 2 : ispin_step;
+
+        for (int ispn = 0; ispn < num_sc; ispn++) {
+            phi0.copy_from(psi, num_bands, nc_mag ? ispn : ispin_step, 0, ispn, 0);
+        }
+
+        /* the subspace was just initialized: get the Ritz values first */
+        if (std::abs(kp__->band_energy(num_bands - 1, ispin_step) - kp__->band_energy(0, ispin_step)) < 1e-12) {
+            H__.apply_h_s<T>(kp__, ispn_h, 0, num_bands, phi0, &hphi, nullptr);
+            rayleigh_ritz(ispin_step, phi0);
+            for (int ispn = 0; ispn < num_sc; ispn++) {
+                phi0.copy_from(psi, num_bands, nc_mag ? ispn : ispin_step, 0, ispn, 0);
+            }
+        }
+
+        /* estimate the upper bound of the spectrum with a few steps of Lanczos algorithm */
+        for (int is = 0; is < num_sc; is++) {
+            for (int ig = 0; ig < v1.pw_coeffs(is).num_rows_loc(); ig++) {
+                v1.pw_coeffs(is).prime(ig, 0) = utils::random<double_complex>();
+            }
+            /* coefficient of G=0 must be real in the reduced G-vector set */
+            if (kp__->gkvec().reduced() && kp__->comm().rank() == 0) {
+                v1.pw_coeffs(is).prime(0, 0) = v1.pw_coeffs(is).prime(0, 0).real();
+            }
+        }
+        v1.scale(memory_t::host, ispn_wf, 0, 1, 1.0 / v1.l2norm(device_t::CPU, ispn_wf, 1)[0]);
+
+        int nlanczos = std::max(2, itso.chebyshev_lanczos_steps_);
+        dmatrix<double> tmtrx(nlanczos, nlanczos);
+        tmtrx.zero();
+        double beta{0};
+        for (int j = 0; j < nlanczos; j++) {
+            if (j) {
+                beta = f.l2norm(device_t::CPU, ispn_wf, 1)[0];
+                tmtrx(j, j - 1) = tmtrx(j - 1, j) = beta;
+                v0.copy_from(v1, 1, 0, 0, 0, 0);
+                if (num_sc == 2) {
+                    v0.copy_from(v1, 1, 1, 0, 1, 0);
+                }
+                axpby(1, 1.0 / beta, f, 0, v1);
+            }
+            H__.apply_h_s<T>(kp__, ispn_h, 0, 1, v1, &f, nullptr);
+            if (j) {
+                axpby(1, -beta, v0, 1, f);
+            }
+            double alpha = dot(v1, f);
+            tmtrx(j, j) = alpha;
+            axpby(1, -alpha, v1, 1, f);
+        }
+        std::vector<double> tval(nlanczos);
+        dmatrix<double> tvec(nlanczos, nlanczos);
+        Eigensolver_factory(ev_solver_t::lapack)->solve(nlanczos, tmtrx, tval.data(), tvec);
+        double b_up = tval[nlanczos - 1] + f.l2norm(device_t::CPU, ispn_wf, 1)[0];
+
+        /* the lowest Ritz value and the upper bound of the wanted part of the spectrum */
+        double a0 = kp__->band_energy(0, ispin_step);
+        double a  = std::min(kp__->band_energy(num_bands - 1, ispin_step), b_up - 1e-6);
+
+        /* residuals of the current Ritz pairs */
+        H__.apply_h_s<T>(kp__, ispn_h, 0, num_bands, phi0, &hphi, nullptr);
+        for (int is = 0; is < num_sc; is++) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < num_bands; i++) {
+                double e = kp__->band_energy(i, ispin_step);
+                for (int ig = 0; ig < res.pw_coeffs(is).num_rows_loc(); ig++) {
+                    res.pw_coeffs(is).prime(ig, i) = hphi.pw_coeffs(is).prime(ig, i) - e * phi0.pw_coeffs(is).prime(ig, i);
+                }
+            }
+        }
+        auto res_norm = res.l2norm(device_t::CPU, ispn_wf, num_bands);
+        double res_max{0};
+        for (int i = 0; i < num_bands; i++) {
+            res_max = std::max(res_max, res_norm[i]);
+        }
+        if (res_max < itso.residual_tolerance_) {
+            continue;
+        }
+
+        /* center and half-width of the interval of the unwanted spectrum */
+        double c = 0.5 * (b_up + a);
+        double e = 0.5 * (b_up - a);
+
+        /* degree of the filter: damping of the unwanted components relative to the lowest state grows as
+         * cosh(m * acosh((c - a0) / e)); choose m to reduce the largest residual down to the tolerance */
+        double gamma = std::max((c - a0) / e, 1 + 1e-12);
+        int m = static_cast<int>(std::ceil(std::acosh(res_max / itso.residual_tolerance_) / std::acosh(gamma)));
+        m = std::max(2, std::min(m, itso.chebyshev_max_degree_));
+
+        if (ctx_.control().verbosity_ >= 2 && kp__->comm().rank() == 0) {
+            printf("Chebyshev filter: bounds [%f, %f, %f], degree: %i, max. residual: %e\n", a0, a, b_up, m, res_max);
+        }
+
+        /* scaled Chebyshev filter (Y. Zhou et al., J. Comput. Phys. 219, 172 (2006)) */
+        double sigma  = e / (a0 - c);
+        double tau    = 2 / sigma;
+        Wave_functions* px = &phi0;
+        Wave_functions* py = &phi1;
+        /* Y = (H - c) X * sigma / e */
+        axpby(num_bands, sigma / e, hphi, 0, *py);
+        axpby(num_bands, -c * sigma / e, *px, 1, *py);
+        for (int k = 2; k <= m; k++) {
+            double sigma_new = 1.0 / (tau - sigma);
+            H__.apply_h_s<T>(kp__, ispn_h, 0, num_bands, *py, &hphi, nullptr);
+            /* X = (H - c) Y * 2 * sigma_new / e - sigma * sigma_new * X */
+            axpby(num_bands, 2 * sigma_new / e, hphi, -sigma * sigma_new, *px);
+            axpby(num_bands, -2 * c * sigma_new / e, *py, 1, *px);
+            std::swap(px, py);
+            sigma = sigma_new;
+        }
+        niter += m;
+
+        /* single Rayleigh-Ritz step in the filtered subspace */
+        H__.apply_h_s<T>(kp__, ispn_h, 0, num_bands, *py, &hphi, nullptr);
+        rayleigh_ritz(ispin_step, *py);
+    }
+
+    kp__->beta_projectors().dismiss();
+
+    return niter;
 }
 
 //template <typename T>
@@ -893,379 +924,284 @@ inline void Band::diag_pseudo_potential_chebyshev(K_point* kp__,
 //}
 
 template <typename T>
-inline void Band::diag_pseudo_potential_rmm_diis(K_point* kp__,
-                                                 int ispn__,
-                                                 Hamiltonian &H__) const
-
+inline int Band::diag_pseudo_potential_rmm_diis(K_point* kp__, Hamiltonian& H__) const
 {
-    //auto& itso = ctx_.iterative_solver_input();
+    auto& itso = ctx_.iterative_solver_input();
     double tol = ctx_.iterative_solver_tolerance();
 
-    if (tol > 1e-4) {
-        diag_pseudo_potential_davidson<T>(kp__, H__);
-        return;
+    /* short notation for number of target wave-functions */
+    const int num_bands = ctx_.num_bands();
+
+    /* the subspace was just initialized and has no Ritz values */
+    bool init_subspace{false};
+    for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+        if (std::abs(kp__->band_energy(num_bands - 1, ispn) - kp__->band_energy(0, ispn)) < 1e-12) {
+            init_subspace = true;
+        }
+    }
+
+    /* warm-up: RMM-DIIS converges to the nearest eigen-state, so the wave-functions must be already close to the
+     * solution; use Davidson solver at the beginning of the SCF cycle */
+    if (tol > 1e-4 || init_subspace) {
+        return diag_pseudo_potential_davidson<T>(kp__, H__);
     }
 
     PROFILE("sirius::Band::diag_pseudo_potential_rmm_diis");
 
+    if (is_device_memory(ctx_.preferred_memory_t())) {
+        TERMINATE("RMM-DIIS solver is not implemented for GPU");
+    }
+
+    /* true if this is a non-collinear case */
+    const bool nc_mag = (ctx_.num_mag_dims() == 3);
+
+    /* number of spin components, treated simultaneously */
+    const int num_sc = nc_mag ? 2 : 1;
+
+    /* short notation for target wave-functions */
+    auto& psi = kp__->spinor_wave_functions();
+
+    auto mem = ctx_.preferred_memory_t();
+    auto la  = ctx_.blas_linalg_t();
+
+    /* spin index of the auxiliary wave-functions */
+    const int ispn_wf = nc_mag ? 2 : 0;
+
+    /* maximum number of DIIS steps */
+    const int num_steps = std::max(1, itso.rmm_diis_num_steps_);
+    /* number of bands in a block */
+    const int nbk_max = (itso.rmm_diis_block_size_ > 0) ? std::min(num_bands, itso.rmm_diis_block_size_) : num_bands;
+
+    /* history of trial wave-functions, S applied to them and residuals; column p * nbk_max + i stores step p of
+     * band i of the current block */
+    Wave_functions phi_hist(kp__->gkvec_partition(), (num_steps + 1) * nbk_max, mem, num_sc);
+    Wave_functions sphi_hist(kp__->gkvec_partition(), (num_steps + 1) * nbk_max, mem, num_sc);
+    Wave_functions res_hist(kp__->gkvec_partition(), (num_steps + 1) * nbk_max, mem, num_sc);
+
+    /* working wave-functions; they must hold all bands for the final Rayleigh-Ritz step */
+    Wave_functions phi(kp__->gkvec_partition(), num_bands, mem, num_sc);
+    Wave_functions hphi(kp__->gkvec_partition(), num_bands, mem, num_sc);
+    Wave_functions sphi(kp__->gkvec_partition(), num_bands, mem, num_sc);
+    Wave_functions res(kp__->gkvec_partition(), num_bands, mem, num_sc);
+
+    const int bs = ctx_.cyclic_block_size();
+    dmatrix<T> hmlt(num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
+    dmatrix<T> ovlp(num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
+    dmatrix<T> evec(num_bands, num_bands, ctx_.blacs_grid(), bs, bs);
+
+    auto& std_solver = ctx_.std_evp_solver();
+
     /* get diagonal elements for preconditioning */
-    //auto h_diag = get_h_diag(kp__, ispn__, local_op_->v0(ispn__), d_op__);
-    //auto o_diag = get_o_diag(kp__, q_op__);
-    STOP();
+    auto h_diag = H__.get_h_diag<T>(kp__);
+    auto o_diag = H__.get_o_diag<T>(kp__);
 
-//    /* short notation for number of target wave-functions */
-//    int num_bands = ctx_.num_fv_states();
-//
-//    //auto pu = ctx_.processing_unit();
-//
-//    /* short notation for target wave-functions */
-//    auto& psi = kp__->spinor_wave_functions(ispn__);
-//
-//    int niter = itso.num_steps_;
-//
-//    Eigenproblem_lapack evp_solver(2 * linalg_base::dlamch('S'));
-//
-//    std::vector<wave_functions*> phi(niter);
-//    std::vector<wave_functions*> res(niter);
-//    std::vector<wave_functions*> ophi(niter);
-//    std::vector<wave_functions*> hphi(niter);
-//
-//    for (int i = 0; i < niter; i++) {
-//        phi[i]  = new wave_functions(ctx_.processing_unit(), kp__->gkvec(), num_bands);
-//        res[i]  = new wave_functions(ctx_.processing_unit(), kp__->gkvec(), num_bands);
-//        hphi[i] = new wave_functions(ctx_.processing_unit(), kp__->gkvec(), num_bands);
-//        ophi[i] = new wave_functions(ctx_.processing_unit(), kp__->gkvec(), num_bands);
-//    }
-//
-//    wave_functions  phi_tmp(ctx_.processing_unit(), kp__->gkvec(), num_bands);
-//    wave_functions hphi_tmp(ctx_.processing_unit(), kp__->gkvec(), num_bands);
-//    wave_functions ophi_tmp(ctx_.processing_unit(), kp__->gkvec(), num_bands);
-//
-//    auto mem_type = (gen_evp_solver_->type() == ev_magma) ? memory_t::host_pinned : memory_t::host;
-//
-//    int bs = ctx_.cyclic_block_size();
-//
-//    dmatrix<T> hmlt(num_bands, num_bands, ctx_.blacs_grid(), bs, bs, mem_type);
-//    dmatrix<T> ovlp(num_bands, num_bands, ctx_.blacs_grid(), bs, bs, mem_type);
-//    dmatrix<T> evec(num_bands, num_bands, ctx_.blacs_grid(), bs, bs, mem_type);
-//    dmatrix<T> hmlt_old;
-//    dmatrix<T> ovlp_old;
-//
-//    std::vector<double> eval(num_bands);
-//    for (int i = 0; i < num_bands; i++) {
-//        eval[i] = kp__->band_energy(i);
-//    }
-//    std::vector<double> eval_old(num_bands);
-//
-//    /* trial basis functions */
-//    phi[0]->copy_from(psi, 0, num_bands);
-//
-//    std::vector<int> last(num_bands, 0);
-//    std::vector<bool> conv_band(num_bands, false);
-//    std::vector<double> res_norm(num_bands);
-//    std::vector<double> res_norm_start(num_bands);
-//    std::vector<double> lambda(num_bands, 0);
-//
-//    auto update_res = [kp__, num_bands, &phi, &res, &hphi, &ophi, &last, &conv_band]
-//                      (std::vector<double>& res_norm__, std::vector<double>& eval__) -> void
-//    {
-//        utils::timer t("sirius::Band::diag_pseudo_potential_rmm_diis|res");
-//        std::vector<double> e_tmp(num_bands, 0), d_tmp(num_bands, 0);
-//
-//        #pragma omp parallel for
-//        for (int i = 0; i < num_bands; i++) {
-//            if (!conv_band[i]) {
-//                e_tmp[i] = std::real(inner_local<T>(kp__, *phi[last[i]], i, *hphi[last[i]], i));
-//                d_tmp[i] = std::real(inner_local<T>(kp__, *phi[last[i]], i, *ophi[last[i]], i));
-//            }
-//        }
-//        kp__->comm().allreduce(e_tmp);
-//        kp__->comm().allreduce(d_tmp);
-//
-//        res_norm__ = std::vector<double>(num_bands, 0);
-//        #pragma omp parallel for
-//        for (int i = 0; i < num_bands; i++) {
-//            if (!conv_band[i]) {
-//                eval__[i] = e_tmp[i] / d_tmp[i];
-//
-//                /* compute residual r_{i} = H\Psi_{i} - E_{i}O\Psi_{i} */
-//                for (int igk = 0; igk < kp__->num_gkvec_loc(); igk++) {
-//                    (*res[last[i]]).pw_coeffs().prime(igk, i) = (*hphi[last[i]]).pw_coeffs().prime(igk, i) - eval__[i] * (*ophi[last[i]]).pw_coeffs().prime(igk, i);
-//                }
-//                res_norm__[i] = std::real(inner_local<T>(kp__, *res[last[i]], i, *res[last[i]], i));
-//            }
-//        }
-//        kp__->comm().allreduce(res_norm__);
-//        for (int i = 0; i < num_bands; i++) {
-//            if (!conv_band[i]) {
-//                res_norm__[i] = std::sqrt(res_norm__[i]);
-//            }
-//        }
-//    };
-//
-//    auto apply_h_o = [this, kp__, num_bands, &phi, &phi_tmp, &hphi, &hphi_tmp, &ophi, &ophi_tmp, &conv_band, &last,
-//                      &d_op__, &q_op__, ispn__]() -> int
-//    {
-//        utils::timer t("sirius::Band::diag_pseudo_potential_rmm_diis|h_o");
-//        int n{0};
-//        for (int i = 0; i < num_bands; i++) {
-//            if (!conv_band[i]) {
-//                std::memcpy(&phi_tmp.pw_coeffs().prime(0, n), &(*phi[last[i]]).pw_coeffs().prime(0, i), kp__->num_gkvec_loc() * sizeof(double_complex));
-//                n++;
-//            }
-//        }
-//
-//        if (n == 0) {
-//            return 0;
-//        }
-//
-//        /* apply Hamiltonian and overlap operators to the initial basis functions */
-//        this->apply_h_o<T>(kp__, ispn__, 0, n, phi_tmp, hphi_tmp, ophi_tmp, d_op__, q_op__);
-//
-//        n = 0;
-//        for (int i = 0; i < num_bands; i++) {
-//            if (!conv_band[i]) {
-//                std::memcpy(&(*hphi[last[i]]).pw_coeffs().prime(0, i), &hphi_tmp.pw_coeffs().prime(0, n), kp__->num_gkvec_loc() * sizeof(double_complex));
-//                std::memcpy(&(*ophi[last[i]]).pw_coeffs().prime(0, i), &ophi_tmp.pw_coeffs().prime(0, n), kp__->num_gkvec_loc() * sizeof(double_complex));
-//                n++;
-//            }
-//        }
-//        return n;
-//    };
-//
-//    STOP();
-//
-//    //auto apply_preconditioner = [kp__, num_bands, &h_diag, &o_diag, &eval, &conv_band]
-//    //                            (std::vector<double> lambda,
-//    //                             wave_functions& res__,
-//    //                             double alpha,
-//    //                             wave_functions& kres__) -> void
-//    //{
-//    //    utils::timer t("sirius::Band::diag_pseudo_potential_rmm_diis|pre");
-//    //    #pragma omp parallel for
-//    //    for (int i = 0; i < num_bands; i++) {
-//    //        if (!conv_band[i]) {
-//    //            for (int igk = 0; igk < kp__->num_gkvec_loc(); igk++) {
-//    //                double p = h_diag[igk] - eval[i] * o_diag[igk];
-//
-//    //                p *= 2; // QE formula is in Ry; here we convert to Ha
-//    //                p = 0.25 * (1 + p + std::sqrt(1 + (p - 1) * (p - 1)));
-//    //                kres__.pw_coeffs().prime(igk, i) = alpha * kres__.pw_coeffs().prime(igk, i) + lambda[i] * res__.pw_coeffs().prime(igk, i) / p;
-//    //            }
-//    //        }
-//
-//    //        //== double Ekin = 0;
-//    //        //== double norm = 0;
-//    //        //== for (int igk = 0; igk < kp__->num_gkvec(); igk++)
-//    //        //== {
-//    //        //==     Ekin += 0.5 * std::pow(std::abs(res__(igk, i)), 2) * std::pow(kp__->gkvec_cart(igk).length(), 2);
-//    //        //==     norm += std::pow(std::abs(res__(igk, i)), 2);
-//    //        //== }
-//    //        //== Ekin /= norm;
-//    //        //== for (int igk = 0; igk < kp__->num_gkvec(); igk++)
-//    //        //== {
-//    //        //==     double x = std::pow(kp__->gkvec_cart(igk).length(), 2) / 3 / Ekin;
-//    //        //==     kres__(igk, i) = alpha * kres__(igk, i) + lambda[i] * res__(igk, i) *
-//    //        //==         (4.0 / 3 / Ekin) * (27 + 18 * x + 12 * x * x + 8 * x * x * x) / (27 + 18 * x + 12 * x * x + 8 * x * x * x + 16 * x * x * x * x);
-//    //        //== }
-//    //    }
-//    //};
-//
-//    /* apply Hamiltonian and overlap operators to the initial basis functions */
-//    this->apply_h_o<T>(kp__, ispn__, 0, num_bands, *phi[0], *hphi[0], *ophi[0], d_op__, q_op__);
-//
-//    /* compute initial residuals */
-//    update_res(res_norm_start, eval);
-//
-//    bool conv{true};
-//    for (int i = 0; i < num_bands; i++) {
-//        if (res_norm_start[i] > itso.residual_tolerance_) {
-//            conv = false;
-//        }
-//    }
-//    if (conv) {
-//        DUMP("all bands are converged at stage#0");
-//        return;
-//    }
-//
-//    last = std::vector<int>(num_bands, 1);
-//
-//    phi[1]->pw_coeffs().prime().zero();
-//    /* apply preconditioner to the initial residuals */
-//    //apply_preconditioner(std::vector<double>(num_bands, 1), *res[0], 0.0, *phi[1]);
-//    STOP();
-//
-//    /* apply H and O to the preconditioned residuals */
-//    apply_h_o();
-//
-//    /* estimate lambda */
-//    std::vector<double> f1(num_bands, 0);
-//    std::vector<double> f2(num_bands, 0);
-//    std::vector<double> f3(num_bands, 0);
-//    std::vector<double> f4(num_bands, 0);
-//
-//    #pragma omp parallel for
-//    for (int i = 0; i < num_bands; i++) {
-//        if (!conv_band[i]) {
-//            f1[i] = std::real(inner_local<T>(kp__, *phi[1], i, *ophi[1], i));     //  <KR_i | OKR_i>
-//            f2[i] = std::real(inner_local<T>(kp__, *phi[0], i, *ophi[1], i)) * 2; // <phi_i | OKR_i>
-//            f3[i] = std::real(inner_local<T>(kp__, *phi[1], i, *hphi[1], i));     //  <KR_i | HKR_i>
-//            f4[i] = std::real(inner_local<T>(kp__, *phi[0], i, *hphi[1], i)) * 2; // <phi_i | HKR_i>
-//        }
-//    }
-//    kp__->comm().allreduce(f1);
-//    kp__->comm().allreduce(f2);
-//    kp__->comm().allreduce(f3);
-//    kp__->comm().allreduce(f4);
-//
-//    #pragma omp parallel for
-//    for (int i = 0; i < num_bands; i++) {
-//        if (!conv_band[i]) {
-//            double a = f1[i] * f4[i] - f2[i] * f3[i];
-//            double b = f3[i] - eval[i] * f1[i];
-//            double c = eval[i] * f2[i] - f4[i];
-//
-//            lambda[i] = (b - std::sqrt(b * b - 4.0 * a * c)) / 2.0 / a;
-//            if (std::abs(lambda[i]) > 2.0) {
-//                lambda[i] = 2.0 * Utils::sign(lambda[i]);
-//            }
-//            if (std::abs(lambda[i]) < 0.5) {
-//                lambda[i] = 0.5 * Utils::sign(lambda[i]);
-//            }
-//
-//            /* construct new basis functions */
-//            for (int igk = 0; igk < kp__->num_gkvec_loc(); igk++) {
-//                 (*phi[1]).pw_coeffs().prime(igk, i) =  (*phi[0]).pw_coeffs().prime(igk, i) + lambda[i] *  (*phi[1]).pw_coeffs().prime(igk, i);
-//                (*hphi[1]).pw_coeffs().prime(igk, i) = (*hphi[0]).pw_coeffs().prime(igk, i) + lambda[i] * (*hphi[1]).pw_coeffs().prime(igk, i);
-//                (*ophi[1]).pw_coeffs().prime(igk, i) = (*ophi[0]).pw_coeffs().prime(igk, i) + lambda[i] * (*ophi[1]).pw_coeffs().prime(igk, i);
-//            }
-//        }
-//    }
-//    /* compute new residuals */
-//    update_res(res_norm, eval);
-//    /* check which bands have converged */
-//    for (int i = 0; i < num_bands; i++) {
-//        if (res_norm[i] < itso.residual_tolerance_) {
-//            conv_band[i] = true;
-//        }
-//    }
-//
-//    mdarray<T, 3> A(niter, niter, num_bands);
-//    mdarray<T, 3> B(niter, niter, num_bands);
-//    mdarray<T, 2> V(niter, num_bands);
-//    std::vector<double> ev(niter);
-//
-//    /* start adjusting residuals */
-//    for (int iter = 2; iter < niter; iter++) {
-//        utils::timer t1("sirius::Band::diag_pseudo_potential_rmm_diis|AB");
-//        A.zero();
-//        B.zero();
-//        for (int i = 0; i < num_bands; i++) {
-//            if (!conv_band[i]) {
-//                for (int i1 = 0; i1 < iter; i1++) {
-//                    for (int i2 = 0; i2 < iter; i2++) {
-//                        A(i1, i2, i) = inner_local<T>(kp__, *res[i1], i, *res[i2], i);
-//                        B(i1, i2, i) = inner_local<T>(kp__, *phi[i1], i, *ophi[i2], i);
-//                    }
-//                }
-//            }
-//        }
-//        kp__->comm().allreduce(A.template at<CPU>(), (int)A.size());
-//        kp__->comm().allreduce(B.template at<CPU>(), (int)B.size());
-//        t1.stop();
-//
-//        utils::timer t2("sirius::Band::diag_pseudo_potential_rmm_diis|phi");
-//        for (int i = 0; i < num_bands; i++) {
-//            if (!conv_band[i]) {
-//                if (evp_solver.solve(iter, 1, &A(0, 0, i), A.ld(), &B(0, 0, i), B.ld(), &ev[0], &V(0, i), V.ld()) == 0) {
-//                    /* zero phi */
-//                    std::memset(&(*phi[iter]).pw_coeffs().prime(0, i), 0, kp__->num_gkvec_loc() * sizeof(double_complex));
-//                    /* zero residual */
-//                    std::memset(&(*res[iter]).pw_coeffs().prime(0, i), 0, kp__->num_gkvec_loc() * sizeof(double_complex));
-//                    /* make linear combinations */
-//                    for (int i1 = 0; i1 < iter; i1++) {
-//                        for (int igk = 0; igk < kp__->num_gkvec_loc(); igk++) {
-//                            (*phi[iter]).pw_coeffs().prime(igk, i) += (*phi[i1]).pw_coeffs().prime(igk, i) * V(i1, i);
-//                            (*res[iter]).pw_coeffs().prime(igk, i) += (*res[i1]).pw_coeffs().prime(igk, i) * V(i1, i);
-//                        }
-//                    }
-//                    last[i] = iter;
-//                } else {
-//                    conv_band[i] = true;
-//                }
-//            }
-//        }
-//        t2.stop();
-//
-//        //apply_preconditioner(lambda, *res[iter], 1.0, *phi[iter]);
-//        STOP();
-//
-//        apply_h_o();
-//
-//        eval_old = eval;
-//
-//        update_res(res_norm, eval);
-//
-//        for (int i = 0; i < num_bands; i++) {
-//            if (!conv_band[i]) {
-//                if (res_norm[i] < itso.residual_tolerance_) {
-//                    conv_band[i] = true;
-//                }
-//                //if (kp__->band_occupancy(i) <= 1e-2) {
-//                //    conv_band[i] = true;
-//                //}
-//                //if (kp__->band_occupancy(i) > 1e-2 && std::abs(eval[i] - eval_old[i]) < tol) {
-//                //    conv_band[i] = true;
-//                //}
-//                //if (kp__->band_occupancy(i) > 1e-2 && res_norm[i] < itso.residual_tolerance_) {
-//                //    conv_band[i] = true;
-//                //}
-//                //if (kp__->band_occupancy(i) <= 1e-2 ||
-//                //    res_norm[i] / res_norm_start[i] < 0.7 ||
-//                //    (kp__->band_occupancy(i) > 1e-2 && std::abs(eval[i] - eval_old[i]) < tol)) {
-//                //    conv_band[i] = true;
-//                //}
-//            }
-//        }
-//        if (std::all_of(conv_band.begin(), conv_band.end(), [](bool e){return e;})) {
-//            std::cout << "early exit from the diis loop" << std::endl;
-//            break;
-//        }
-//    }
-//
-//    #pragma omp parallel for
-//    for (int i = 0; i < num_bands; i++) {
-//        std::memcpy(&phi_tmp.pw_coeffs().prime(0, i),  &(*phi[last[i]]).pw_coeffs().prime(0, i),  kp__->num_gkvec_loc() * sizeof(double_complex));
-//        std::memcpy(&hphi_tmp.pw_coeffs().prime(0, i), &(*hphi[last[i]]).pw_coeffs().prime(0, i), kp__->num_gkvec_loc() * sizeof(double_complex));
-//        std::memcpy(&ophi_tmp.pw_coeffs().prime(0, i), &(*ophi[last[i]]).pw_coeffs().prime(0, i), kp__->num_gkvec_loc() * sizeof(double_complex));
-//    }
-//    orthogonalize<T>(0, num_bands, phi_tmp, hphi_tmp, ophi_tmp, ovlp, *res[0]);
-//
-//    /* setup eigen-value problem
-//     * N is the number of previous basis functions
-//     * n is the number of new basis functions */
-//    set_subspace_mtrx(0, num_bands, phi_tmp, hphi_tmp, hmlt, hmlt_old);
-//
-//    if (std_evp_solver().solve(num_bands, num_bands, hmlt.template at<CPU>(), hmlt.ld(),
-//                               eval.data(), evec.template at<CPU>(), evec.ld(),
-//                               hmlt.num_rows_local(), hmlt.num_cols_local())) {
-//        std::stringstream s;
-//        s << "error in diagonalziation";
-//        TERMINATE(s);
-//    }
-//
-//    /* recompute wave-functions */
-//    /* \Psi_{i} = \sum_{mu} \phi_{mu} * Z_{mu, i} */
-//    transform<T>(phi_tmp, 0, num_bands, evec, 0, 0, psi, 0, num_bands);
-//
-//    for (int j = 0; j < ctx_.num_fv_states(); j++) {
-//        kp__->band_energy(j + ispn__ * ctx_.num_fv_states()) = eval[j];
-//    }
-//
-//    for (int i = 0; i < niter; i++) {
-//        delete phi[i];
-//        delete res[i];
-//        delete hphi[i];
-//        delete ophi[i];
-//    }
+    const bool reduced = kp__->gkvec().reduced();
+
+    /* <x_{ix0 + i}|y_{iy0 + i}> for i = 0..n-1; local contribution, not yet reduced */
+    auto dot_local = [&](Wave_functions& x, int ix0, Wave_functions& y, int iy0, int n, double_complex* out)
+    {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n; i++) {
+            double_complex z(0, 0);
+            for (int is = 0; is < num_sc; is++) {
+                for (int ig = 0; ig < x.pw_coeffs(is).num_rows_loc(); ig++) {
+                    z += std::conj(x.pw_coeffs(is).prime(ig, ix0 + i)) * y.pw_coeffs(is).prime(ig, iy0 + i);
+                }
+            }
+            /* reduced G-vector set is used only for a single spin component */
+            if (reduced) {
+                z = 2 * z.real();
+                if (kp__->comm().rank() == 0) {
+                    z -= (std::conj(x.pw_coeffs(0).prime(0, ix0 + i)) * y.pw_coeffs(0).prime(0, iy0 + i)).real();
+                }
+            }
+            out[i] = z;
+        }
+    };
+
+    /* copy n columns of wave-functions */
+    auto copy = [&](Wave_functions& src, int i0, Wave_functions& dest, int j0, int n)
+    {
+        for (int is = 0; is < num_sc; is++) {
+            dest.copy_from(src, n, is, i0, is, j0);
+        }
+    };
+
+    kp__->beta_projectors().prepare();
+
+    int niter{0};
+
+    for (int ispin_step = 0; ispin_step < ctx_.num_spin_dims(); ispin_step++) {
+        /* spin index of the Hamiltonian */
+        const int ispn_h = nc_mag ? 2 : ispin_step;
+
+        for (int ispn = 0; ispn < num_sc; ispn++) {
+            phi.copy_from(psi, num_bands, nc_mag ? ispn : ispin_step, 0, ispn, 0);
+        }
+
+        /* loop over blocks of bands; bands are independent of each other, so no orthogonalization is needed */
+        for (int ib0 = 0; ib0 < num_bands; ib0 += nbk_max) {
+            const int nbk = std::min(nbk_max, num_bands - ib0);
+
+            mdarray<double, 1> eval(nbk);
+            mdarray<double, 1> lambda(nbk);
+            /* DIIS matrix <R_p|R_q> for each band */
+            mdarray<double_complex, 3> rr(num_steps + 1, num_steps + 1, nbk);
+            /* DIIS coefficients for each band */
+            mdarray<double_complex, 2> alpha(num_steps + 1, nbk);
+            mdarray<double_complex, 1> buf(3 * (num_steps + 1) * nbk);
+
+            /* residuals of the current block: R = (H - e S)phi with Rayleigh quotient e */
+            auto compute_block_res = [&](int p)
+            {
+                H__.apply_h_s<T>(kp__, ispn_h, ib0, nbk, phi, &hphi, &sphi);
+                /* one reduction for <phi|H|phi> and <phi|S|phi> */
+                dot_local(phi, ib0, hphi, ib0, nbk, &buf[0]);
+                dot_local(phi, ib0, sphi, ib0, nbk, &buf[nbk]);
+                kp__->comm().allreduce(&buf[0], 2 * nbk);
+                for (int i = 0; i < nbk; i++) {
+                    eval[i] = buf[i].real() / buf[nbk + i].real();
+                }
+                for (int is = 0; is < num_sc; is++) {
+                    #pragma omp parallel for schedule(static)
+                    for (int i = 0; i < nbk; i++) {
+                        for (int ig = 0; ig < res.pw_coeffs(is).num_rows_loc(); ig++) {
+                            res.pw_coeffs(is).prime(ig, i) = hphi.pw_coeffs(is).prime(ig, ib0 + i) -
+                                eval[i] * sphi.pw_coeffs(is).prime(ig, ib0 + i);
+                        }
+                    }
+                }
+                copy(phi, ib0, phi_hist, p * nbk_max, nbk);
+                copy(sphi, ib0, sphi_hist, p * nbk_max, nbk);
+                copy(res, 0, res_hist, p * nbk_max, nbk);
+            };
+
+            compute_block_res(0);
+
+            /* preconditioned residuals K R_0 define the initial search direction */
+            apply_p(device_t::CPU, ispn_h, nbk, res, h_diag, o_diag, eval);
+            copy(res, 0, phi, ib0, nbk);
+            H__.apply_h_s<T>(kp__, ispn_h, ib0, nbk, phi, &hphi, &sphi);
+            /* optimal step length along K R_0: lambda = -<R_0|(H - eS) K R_0> / |(H - eS) K R_0|^2 */
+            for (int is = 0; is < num_sc; is++) {
+                #pragma omp parallel for schedule(static)
+                for (int i = 0; i < nbk; i++) {
+                    for (int ig = 0; ig < hphi.pw_coeffs(is).num_rows_loc(); ig++) {
+                        hphi.pw_coeffs(is).prime(ig, ib0 + i) -= eval[i] * sphi.pw_coeffs(is).prime(ig, ib0 + i);
+                    }
+                }
+            }
+            dot_local(res_hist, 0, hphi, ib0, nbk, &buf[0]);
+            dot_local(hphi, ib0, hphi, ib0, nbk, &buf[nbk]);
+            kp__->comm().allreduce(&buf[0], 2 * nbk);
+            for (int i = 0; i < nbk; i++) {
+                lambda[i] = (buf[nbk + i].real() > 1e-16) ? -buf[i].real() / buf[nbk + i].real() : -1.0;
+                /* limit the magnitude of the step, but keep its sign (normally lambda is close to -1) */
+                lambda[i] = std::copysign(std::max(0.1, std::min(std::abs(lambda[i]), 1.0)), lambda[i]);
+            }
+            niter++;
+
+            for (int k = 0; k <= num_steps; k++) {
+                if (k) {
+                    compute_block_res(k);
+                }
+                /* update DIIS matrix and check the convergence; single reduction per step */
+                for (int p = 0; p <= k; p++) {
+                    dot_local(res_hist, p * nbk_max, res_hist, k * nbk_max, nbk, &buf[p * nbk]);
+                }
+                kp__->comm().allreduce(&buf[0], (k + 1) * nbk);
+                int num_unconverged{0};
+                for (int i = 0; i < nbk; i++) {
+                    for (int p = 0; p <= k; p++) {
+                        rr(p, k, i) = buf[p * nbk + i];
+                        rr(k, p, i) = std::conj(buf[p * nbk + i]);
+                    }
+                    if (std::sqrt(std::abs(rr(k, k, i))) > itso.residual_tolerance_) {
+                        num_unconverged++;
+                    }
+                }
+
+                /* minimize the norm of the residual in the space of previous trial vectors:
+                 * sum_q <R_p|R_q> alpha_q = mu, sum_q alpha_q = 1 */
+                for (int i = 0; i < nbk; i++) {
+                    int n = k + 2;
+                    mdarray<double_complex, 2> a(n, n);
+                    a.zero();
+                    std::vector<double_complex> b(n, 0);
+                    for (int p = 0; p <= k; p++) {
+                        for (int q = 0; q <= k; q++) {
+                            a(p, q) = rr(p, q, i);
+                        }
+                        a(p, k + 1) = a(k + 1, p) = 1;
+                    }
+                    b[k + 1] = 1;
+                    for (int p = 0; p <= num_steps; p++) {
+                        alpha(p, i) = 0;
+                    }
+                    if (linalg<CPU>::gesv<double_complex>(n, 1, a.at(memory_t::host), a.ld(), b.data(), n)) {
+                        /* fall back to the last trial vector */
+                        alpha(k, i) = 1;
+                    } else {
+                        for (int p = 0; p <= k; p++) {
+                            alpha(p, i) = b[p];
+                        }
+                    }
+                }
+
+                /* phi = sum_p alpha_p phi_p, R = sum_p alpha_p R_p */
+                for (int is = 0; is < num_sc; is++) {
+                    #pragma omp parallel for schedule(static)
+                    for (int i = 0; i < nbk; i++) {
+                        for (int ig = 0; ig < phi.pw_coeffs(is).num_rows_loc(); ig++) {
+                            double_complex z1(0, 0);
+                            double_complex z2(0, 0);
+                            for (int p = 0; p <= k; p++) {
+                                z1 += alpha(p, i) * phi_hist.pw_coeffs(is).prime(ig, p * nbk_max + i);
+                                z2 += alpha(p, i) * res_hist.pw_coeffs(is).prime(ig, p * nbk_max + i);
+                            }
+                            phi.pw_coeffs(is).prime(ig, ib0 + i) = z1;
+                            res.pw_coeffs(is).prime(ig, i)       = z2;
+                        }
+                    }
+                }
+
+                if (num_unconverged == 0 || k == num_steps) {
+                    break;
+                }
+
+                /* new trial vector: phi_{k+1} = phi + lambda K R */
+                apply_p(device_t::CPU, ispn_h, nbk, res, h_diag, o_diag, eval);
+                for (int is = 0; is < num_sc; is++) {
+                    #pragma omp parallel for schedule(static)
+                    for (int i = 0; i < nbk; i++) {
+                        for (int ig = 0; ig < phi.pw_coeffs(is).num_rows_loc(); ig++) {
+                            phi.pw_coeffs(is).prime(ig, ib0 + i) += lambda[i] * res.pw_coeffs(is).prime(ig, i);
+                        }
+                    }
+                }
+                niter++;
+            }
+        } /* loop over blocks of bands */
+
+        /* orthonormalize the bands and do the subspace rotation once at the end of the step */
+        H__.apply_h_s<T>(kp__, ispn_h, 0, num_bands, phi, &hphi, &sphi);
+        orthogonalize<T>(mem, la, ispn_wf, phi, hphi, sphi, 0, num_bands, ovlp, res,
+                         get_ortho_method_t(itso.orthogonalization_method_));
+        set_subspace_mtrx(0, num_bands, phi, hphi, hmlt);
+
+        std::vector<double> eval(num_bands);
+        if (std_solver.solve(num_bands, num_bands, hmlt, eval.data(), evec)) {
+            TERMINATE("error in diagonalziation");
+        }
+        evp_work_count() += 1;
+
+        transform<T>(mem, la, nc_mag ? 2 : ispin_step, {&phi}, 0, num_bands, evec, 0, 0, {&psi}, 0, num_bands);
+        for (int j = 0; j < num_bands; j++) {
+            kp__->band_energy(j, ispin_step, eval[j]);
+        }
+    } /* loop over ispin_step */
+
+    kp__->beta_projectors().dismiss();
+
+    return niter;
 }
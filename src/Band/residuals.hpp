@@ -210,6 +210,92 @@ static void normalize_res(device_t            pu__,
     }
 }
 
+/// Compute preconditioned and normalized residuals together with their norms in a single pass (CPU only).
+/** Residuals \f$ r_{i} = H\Psi_{i} - E_{i}O\Psi_{i} \f$ are computed, preconditioned and stored in one sweep over
+ *  hpsi and opsi; the norms of the bare and preconditioned residuals are accumulated on the fly and reduced with a
+ *  single MPI call. A second sweep only rescales the residuals. On return p_norm holds the inverse norms of the
+ *  preconditioned residuals. */
+static void compute_res_fused(int                 ispn__,
+                              int                 num_bands__,
+                              mdarray<double, 1>& eval__,
+                              Wave_functions&     hpsi__,
+                              Wave_functions&     opsi__,
+                              Wave_functions&     res__,
+                              mdarray<double, 2>& h_diag__,
+                              mdarray<double, 1>& o_diag__,
+                              bool                reduced__,
+                              Communicator const& comm__,
+                              mdarray<double, 1>& res_norm__,
+                              mdarray<double, 1>& p_norm__)
+{
+    auto spins = get_spins(ispn__);
+
+    /* squared norms of bare and preconditioned residuals */
+    mdarray<double, 1> nrm(2 * num_bands__);
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < num_bands__; i++) {
+        double e = eval__[i];
+        double s1{0};
+        double s2{0};
+        for (int ispn: spins) {
+            int ngv = res__.pw_coeffs(ispn).num_rows_loc();
+            for (int ig = 0; ig < ngv; ig++) {
+                auto r = hpsi__.pw_coeffs(ispn).prime(ig, i) - e * opsi__.pw_coeffs(ispn).prime(ig, i);
+                double p = h_diag__(ig, ispn) - o_diag__[ig] * e;
+                p = 0.5 * (1 + p + std::sqrt(1 + (p - 1) * (p - 1)));
+                s1 += std::norm(r);
+                r /= p;
+                s2 += std::norm(r);
+                res__.pw_coeffs(ispn).prime(ig, i) = r;
+            }
+            /* G-vectors of the reduced set are counted twice, except G=0 */
+            if (reduced__) {
+                s1 *= 2;
+                s2 *= 2;
+                if (comm__.rank() == 0) {
+                    s1 -= std::norm(hpsi__.pw_coeffs(ispn).prime(0, i) - e * opsi__.pw_coeffs(ispn).prime(0, i));
+                    s2 -= std::norm(res__.pw_coeffs(ispn).prime(0, i));
+                }
+            }
+            if (res__.has_mt()) {
+                for (int j = 0; j < res__.mt_coeffs(ispn).num_rows_loc(); j++) {
+                    auto r = hpsi__.mt_coeffs(ispn).prime(j, i) - e * opsi__.mt_coeffs(ispn).prime(j, i);
+                    double p = h_diag__(ngv + j, ispn) - o_diag__[ngv + j] * e;
+                    p = 0.5 * (1 + p + std::sqrt(1 + (p - 1) * (p - 1)));
+                    s1 += std::norm(r);
+                    r /= p;
+                    s2 += std::norm(r);
+                    res__.mt_coeffs(ispn).prime(j, i) = r;
+                }
+            }
+        }
+        nrm[i]               = s1;
+        nrm[num_bands__ + i] = s2;
+    }
+    comm__.allreduce(nrm.at(memory_t::host), 2 * num_bands__);
+
+    for (int i = 0; i < num_bands__; i++) {
+        res_norm__[i] = std::sqrt(nrm[i]);
+        p_norm__[i]   = 1.0 / std::sqrt(nrm[num_bands__ + i]);
+    }
+
+    /* normalize preconditioned residuals */
+    for (int ispn: spins) {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < num_bands__; i++) {
+            for (int ig = 0; ig < res__.pw_coeffs(ispn).num_rows_loc(); ig++) {
+                res__.pw_coeffs(ispn).prime(ig, i) *= p_norm__[i];
+            }
+            if (res__.has_mt()) {
+                for (int j = 0; j < res__.mt_coeffs(ispn).num_rows_loc(); j++) {
+                    res__.mt_coeffs(ispn).prime(j, i) *= p_norm__[i];
+                }
+            }
+        }
+    }
+}
+
 inline mdarray<double, 1>
 Band::residuals_aux(K_point*             kp__,
                     int                  ispn__,
@@ -232,24 +318,32 @@ Band::residuals_aux(K_point*             kp__,
         eval.allocate(memory_t::device).copy_to(memory_t::device);
     }
 
-    /* compute residuals */
-    compute_res(pu, ispn__, num_bands__, eval, hpsi__, opsi__, res__);
+    mdarray<double, 1> res_norm;
+    mdarray<double, 1> p_norm;
 
-    /* compute norm */
-    auto res_norm = res__.l2norm(pu, ispn__, num_bands__);
+    if (pu == device_t::CPU) {
+        res_norm = mdarray<double, 1>(num_bands__);
+        p_norm   = mdarray<double, 1>(num_bands__);
+        compute_res_fused(ispn__, num_bands__, eval, hpsi__, opsi__, res__, h_diag__, o_diag__,
+                          kp__->gkvec().reduced(), kp__->comm(), res_norm, p_norm);
+    } else {
+        /* compute residuals */
+        compute_res(pu, ispn__, num_bands__, eval, hpsi__, opsi__, res__);
 
-    apply_p(pu, ispn__, num_bands__, res__, h_diag__, o_diag__, eval);
+        /* compute norm */
+        res_norm = res__.l2norm(pu, ispn__, num_bands__);
 
-    auto p_norm = res__.l2norm(pu, ispn__, num_bands__);
-    for (int i = 0; i < num_bands__; i++) {
-        p_norm[i] = 1.0 / p_norm[i];
-    }
-    if (pu == device_t::GPU) {
+        apply_p(pu, ispn__, num_bands__, res__, h_diag__, o_diag__, eval);
+
+        p_norm = res__.l2norm(pu, ispn__, num_bands__);
+        for (int i = 0; i < num_bands__; i++) {
+            p_norm[i] = 1.0 / p_norm[i];
+        }
         p_norm.copy_to(memory_t::device);
-    }
 
-    /* normalize preconditioned residuals */
-    normalize_res(pu, ispn__, num_bands__, res__, p_norm);
+        /* normalize preconditioned residuals */
+        normalize_res(pu, ispn__, num_bands__, res__, p_norm);
+    }
 
     if (ctx_.control().verbosity_ >= 5) {
         auto n_norm = res__.l2norm(pu, ispn__, num_bands__);
@@ -281,7 +375,9 @@ inline int Band::residuals(K_point*             kp__,
                            Wave_functions&      opsi__,
                            Wave_functions&      res__,
                            mdarray<double, 2>&  h_diag__,
-                           mdarray<double, 1>&  o_diag__) const
+                           mdarray<double, 1>&  o_diag__,
+                           int                  i0__,
+                           std::vector<int>*    converged__) const
 {
     PROFILE("sirius::Band::residuals");
 
@@ -292,6 +388,10 @@ inline int Band::residuals(K_point*             kp__,
 
     auto spins = get_spins(ispn__);
 
+    if (converged__) {
+        converged__->assign(num_bands__, 1);
+    }
+
     int n{0};
     if (converge_by_energy) {
 
@@ -301,7 +401,7 @@ inline int Band::residuals(K_point*             kp__,
             std::vector<int> ev_idx;
             int s = ispn__ == 2 ? 0 : ispn__;
             for (int i = 0; i < num_bands__; i++) {
-                double o1 = std::abs(kp__->band_occupancy(i, s) / ctx_.max_occupancy());
+                double o1 = std::abs(kp__->band_occupancy(i0__ + i, s) / ctx_.max_occupancy());
                 double o2 = std::abs(1 - o1);
 
                 double tol = o1 * tol__ + o2 * (tol__ + itso.empty_states_tolerance_);
@@ -370,6 +470,9 @@ inline int Band::residuals(K_point*             kp__,
             for (int i = 0; i < nmax; i++) {
                 /* take the residual if it's norm is above the threshold */
                 if (res_norm[i] > itso.residual_tolerance_) {
+                    if (converged__) {
+                        (*converged__)[ev_idx[i]] = 0;
+                    }
                     /* shift unconverged residuals to the beginning of array */
                     if (n != i) {
                         for (int ispn: spins) {
@@ -394,6 +497,9 @@ inline int Band::residuals(K_point*             kp__,
             double tol = itso.residual_tolerance_;// + 1e-3 * std::abs(kp__->band_occupancy(i + s * ctx_.num_fv_states()) / ctx_.max_occupancy() - 1);
             /* take the residual if its norm is above the threshold */
             if (res_norm[i] > tol) {
+                if (converged__) {
+                    (*converged__)[i] = 0;
+                }
                 /* shift unconverged residuals to the beginning of array */
                 if (n != i) {
                     for (int ispn: spins) {
@@ -65,9 +65,10 @@ inline void Band::set_subspace_mtrx(int N__,
         }
     }
 
-    /* <{phi,phi_new}|Op|phi_new> */
+    /* <{phi,phi_new}|Op|phi_new>; Op is Hermitian, so the lower part of the new n x n block is restored by
+       conjugation inside inner() */
     inner(ctx_.preferred_memory_t(), ctx_.blas_linalg_t(), (ctx_.num_mag_dims() == 3) ? 2 : 0, phi__, 0, N__ + n__,
-          op_phi__, N__, n__, mtrx__, 0, N__);
+          op_phi__, N__, n__, mtrx__, 0, N__, true);
 
     /* restore lower part */
     if (N__ > 0) {
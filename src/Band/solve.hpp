@@ -66,22 +66,9 @@ inline int Band::solve_pseudo_potential(K_point& kp__, Hamiltonian& hamiltonian_
     } else if (itso.type_ == "davidson") {
         niter = diag_pseudo_potential_davidson<T>(&kp__, hamiltonian__);
     } else if (itso.type_ == "rmm-diis") {
-        if (ctx_.num_mag_dims() != 3) {
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                diag_pseudo_potential_rmm_diis<T>(&kp__, ispn, hamiltonian__);
-            }
-        } else {
-            STOP();
-        }
+        niter = diag_pseudo_potential_rmm_diis<T>(&kp__, hamiltonian__);
     } else if (itso.type_ == "chebyshev") {
-        P_operator<T> p_op(ctx_, kp__.p_mtrx());
-        if (ctx_.num_mag_dims() != 3) {
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                diag_pseudo_potential_chebyshev<T>(&kp__, ispn, hamiltonian__, p_op);
-            }
-        } else {
-            STOP();
-        }
+        niter = diag_pseudo_potential_chebyshev<T>(&kp__, hamiltonian__);
     } else {
         TERMINATE("unknown iterative solver type");
     }
@@ -94,6 +81,11 @@ inline int Band::solve_pseudo_potential(K_point& kp__, Hamiltonian& hamiltonian_
 
     ctx_.fft_coarse().dismiss();
 
+    /* Hubbard orbitals generated per chunk of atoms are kept only for the band solution of this k-point */
+    if (ctx_.hubbard_correction()) {
+        hamiltonian__.U().release_hubbard_orbitals(kp__);
+    }
+
     ctx_.print_memory_usage(__FILE__, __LINE__);
 
     return niter;
@@ -121,15 +113,21 @@ inline void Band::solve(K_point_set& kset__, Hamiltonian& hamiltonian__, bool pr
         int ik  = kset__.spl_num_kpoints(ikloc);
         auto kp = kset__[ik];
 
+        utils::timer t1("sirius::Band::solve|kp");
         if (ctx_.full_potential()) {
             solve_full_potential(*kp, hamiltonian__);
         } else {
+            int niter;
             if (ctx_.gamma_point() && (ctx_.so_correction() == false)) {
-                num_dav_iter += solve_pseudo_potential<double>(*kp, hamiltonian__);
+                niter = solve_pseudo_potential<double>(*kp, hamiltonian__);
             } else {
-                num_dav_iter += solve_pseudo_potential<double_complex>(*kp, hamiltonian__);
+                niter = solve_pseudo_potential<double_complex>(*kp, hamiltonian__);
             }
+            kp->num_diag_iter(niter);
+            num_dav_iter += niter;
         }
+        /* measured time is used to balance the distribution of k-points */
+        kp->solve_time(t1.stop());
     }
     kset__.comm().allreduce(&num_dav_iter, 1);
     if (ctx_.comm().rank() == 0 && !ctx_.full_potential() && ctx_.control().verbosity_ >= 1) {
@@ -52,24 +52,29 @@ class Beta_projectors : public Beta_projectors_base
         }
 
         /* compute <G+k|beta> */
-        #pragma omp parallel for
-        for (int igkloc = 0; igkloc < num_gkvec_loc(); igkloc++) {
-            int igk = igk__[igkloc];
-            /* vs = {r, theta, phi} */
-            auto vs = SHT::spherical_coordinates(gkvec_.gkvec_cart<index_domain_t::global>(igk));
-            /* compute real spherical harmonics for G+k vector */
+        #pragma omp parallel
+        {
             std::vector<double> gkvec_rlm(utils::lmmax(ctx_.unit_cell().lmax()));
-            SHT::spherical_harmonics(ctx_.unit_cell().lmax(), vs[1], vs[2], &gkvec_rlm[0]);
-            for (int iat = 0; iat < ctx_.unit_cell().num_atom_types(); iat++) {
-                auto& atom_type = ctx_.unit_cell().atom_type(iat);
-                /* get all values of radial integrals */
-                auto ri_val = beta_radial_integrals.values(iat, vs[0]);
-                for (int xi = 0; xi < atom_type.mt_basis_size(); xi++) {
-                    int l     = atom_type.indexb(xi).l;
-                    int lm    = atom_type.indexb(xi).lm;
-                    int idxrf = atom_type.indexb(xi).idxrf;
-
-                    pw_coeffs_t_(igkloc, atom_type.offset_lo() + xi, 0) = z[l] * gkvec_rlm[lm] * ri_val(idxrf);
+            std::vector<double> ri_val(ctx_.unit_cell().max_mt_radial_basis_size());
+
+            #pragma omp for
+            for (int igkloc = 0; igkloc < num_gkvec_loc(); igkloc++) {
+                int igk = igk__[igkloc];
+                /* vs = {r, theta, phi} */
+                auto vs = SHT::spherical_coordinates(gkvec_.gkvec_cart<index_domain_t::global>(igk));
+                /* compute real spherical harmonics for G+k vector */
+                SHT::spherical_harmonics(ctx_.unit_cell().lmax(), vs[1], vs[2], &gkvec_rlm[0]);
+                for (int iat = 0; iat < ctx_.unit_cell().num_atom_types(); iat++) {
+                    auto& atom_type = ctx_.unit_cell().atom_type(iat);
+                    /* get all values of radial integrals */
+                    beta_radial_integrals.packed_values(iat, vs[0], ri_val.data());
+                    for (int xi = 0; xi < atom_type.mt_basis_size(); xi++) {
+                        int l     = atom_type.indexb(xi).l;
+                        int lm    = atom_type.indexb(xi).lm;
+                        int idxrf = atom_type.indexb(xi).idxrf;
+
+                        pw_coeffs_t_(igkloc, atom_type.offset_lo() + xi, 0) = z[l] * gkvec_rlm[lm] * ri_val[idxrf];
+                    }
                 }
             }
         }
@@ -84,6 +89,17 @@ class Beta_projectors : public Beta_projectors_base
 
     }
 
+    /// Generate beta-projectors of all atoms in the big host array.
+    void generate_all_atoms()
+    {
+        for (int ichunk = 0; ichunk < num_chunks(); ichunk++) {
+            /* wrap the the pointer in the big array beta_pw_all_atoms */
+            pw_coeffs_a_ = matrix<double_complex>(&beta_pw_all_atoms_(0, chunk(ichunk).offset_),
+                                                  num_gkvec_loc(), chunk(ichunk).num_beta_);
+            Beta_projectors_base::generate(ichunk, 0);
+        }
+    }
+
   public:
     Beta_projectors(Simulation_context& ctx__, Gvec const& gkvec__, std::vector<int>& igk__)
         : Beta_projectors_base(ctx__, gkvec__, igk__, 1)
@@ -102,17 +118,24 @@ class Beta_projectors : public Beta_projectors_base
             /* generate beta projectors for all atoms */
             case device_t::CPU: {
                 beta_pw_all_atoms_ = matrix<double_complex>(num_gkvec_loc(), ctx_.unit_cell().mt_lo_basis_size());
-                for (int ichunk = 0; ichunk < num_chunks(); ichunk++) {
-                    /* wrap the the pointer in the big array beta_pw_all_atoms */
-                    pw_coeffs_a_ = matrix<double_complex>(&beta_pw_all_atoms_(0, chunk(ichunk).offset_),
-                                                          num_gkvec_loc(), chunk(ichunk).num_beta_);
-                    Beta_projectors_base::generate(ichunk, 0);
-                }
+                generate_all_atoms();
                 break;
             }
         }
     }
 
+    /// Update beta-projectors after the change of atomic positions.
+    /** Plane-wave coefficients of the atom types don't depend on atomic positions and are kept. */
+    void update_positions()
+    {
+        PROFILE("sirius::Beta_projectors::update_positions");
+
+        split_in_chunks();
+        if (ctx_.processing_unit() == device_t::CPU) {
+            generate_all_atoms();
+        }
+    }
+
     void prepare()
     {
         switch (ctx_.processing_unit()) {
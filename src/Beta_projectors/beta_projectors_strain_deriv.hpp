@@ -64,6 +64,14 @@ class Beta_projectors_strain_deriv : public Beta_projectors_base
             SHT::dRlm_dr(lmax, gvc, rlm_dg_tmp);
         }
 
+        /* buffers for the radial integrals of one atom type at one |G+k| */
+        std::vector<std::vector<double>> ri0_buf(omp_get_max_threads());
+        std::vector<std::vector<double>> ri1_buf(omp_get_max_threads());
+        for (int i = 0; i < omp_get_max_threads(); i++) {
+            ri0_buf[i] = std::vector<double>(ctx_.unit_cell().max_mt_radial_basis_size());
+            ri1_buf[i] = std::vector<double>(ctx_.unit_cell().max_mt_radial_basis_size());
+        }
+
         /* compute d <G+k|beta> / d epsilon_{mu, nu} */
         #pragma omp parallel for schedule(static)
         for (int igkloc = 0; igkloc < num_gkvec_loc(); igkloc++) {
@@ -102,8 +110,10 @@ class Beta_projectors_strain_deriv : public Beta_projectors_base
             for (int iat = 0; iat < ctx_.unit_cell().num_atom_types(); iat++) {
                 auto& atom_type = ctx_.unit_cell().atom_type(iat);
 
-                auto ri0 = beta_ri0.values(iat, gvs[0]);
-                auto ri1 = beta_ri1.values(iat, gvs[0]);
+                auto& ri0 = ri0_buf[omp_get_thread_num()];
+                auto& ri1 = ri1_buf[omp_get_thread_num()];
+                beta_ri0.packed_values(iat, gvs[0], ri0.data());
+                beta_ri1.packed_values(iat, gvs[0], ri1.data());
 
                 for (int nu = 0; nu < 3; nu++) {
                     for (int mu = 0; mu < 3; mu++) {
@@ -116,9 +126,9 @@ class Beta_projectors_strain_deriv : public Beta_projectors_base
 
                             auto z = std::pow(double_complex(0, -1), l) * fourpi / std::sqrt(ctx_.unit_cell().omega());
 
-                            auto d1 = ri0(idxrf) * (-gvc[mu] * rlm_dg(lm, nu, igkloc) - p * rlm_g(lm, igkloc));
+                            auto d1 = ri0[idxrf] * (-gvc[mu] * rlm_dg(lm, nu, igkloc) - p * rlm_g(lm, igkloc));
 
-                            auto d2 = ri1(idxrf) * rlm_g(lm, igkloc) * (-gvc[mu] * gvc[nu] / gvs[0]);
+                            auto d2 = ri1[idxrf] * rlm_g(lm, igkloc) * (-gvc[mu] * gvc[nu] / gvs[0]);
 
                             pw_coeffs_t_(igkloc, atom_type.offset_lo() + xi, mu + nu * 3) = z * (d1 + d2);
                         }
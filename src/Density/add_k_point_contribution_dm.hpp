@@ -55,7 +55,7 @@ inline void Density::add_k_point_contribution_dm(K_point* kp__, mdarray<double_c
                 }
             }
         } else {
-            int nbnd = kp__->num_occupied_bands();
+            int nbnd = kp__->num_occupied_bands(0);
 
             mdarray<double_complex, 3> wf1(unit_cell_.max_mt_basis_size(), nbnd, ctx_.num_spins());
             mdarray<double_complex, 3> wf2(unit_cell_.max_mt_basis_size(), nbnd, ctx_.num_spins());
@@ -152,7 +152,7 @@ inline void Density::add_k_point_contribution_dm(K_point* kp__, mdarray<double_c
                 int nbeta = kp__->beta_projectors().chunk(chunk).num_beta_;
 
                 /* total number of occupied bands */
-                int nbnd = kp__->num_occupied_bands();
+                int nbnd = kp__->num_occupied_bands(0);
 
                 splindex<block> spl_nbnd(nbnd, kp__->comm().size(), kp__->comm().rank());
                 int nbnd_loc = spl_nbnd.local_size();
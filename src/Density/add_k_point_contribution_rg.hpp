@@ -22,7 +22,6 @@
  *  \brief Contains implementation of sirius::Density::add_k_point_contribution_rg() function.
  */
 
-//TODO: in case of Gamma-point transfrom two wave functions at once
 //TODO: use GPU pointer
 
 inline void Density::add_k_point_contribution_rg(K_point* kp__)
@@ -53,7 +52,48 @@ inline void Density::add_k_point_contribution_rg(K_point* kp__)
                 continue;
             }
 
-            for (int i = 0; i < kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col().local_size(); i++) {
+            /* local number of bands in the extra-storage distribution */
+            int num_wf_loc = kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col().local_size();
+
+            int first{0};
+            /* If G-vectors are reduced, wave-functions are real and we can transform two of them at once.
+               The result of the transformation is psi_1(r) + i psi_2(r). */
+            if (kp__->gkvec().reduced()) {
+                for (int i = 0; i < num_wf_loc / 2; i++) {
+                    int j1 = kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col()[2 * i];
+                    int j2 = kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col()[2 * i + 1];
+                    double w1 = kp__->band_occupancy(j1, ispn) * kp__->weight() / omega;
+                    double w2 = kp__->band_occupancy(j2, ispn) * kp__->weight() / omega;
+
+                    /* transform two bands to real space; in case of GPU wave-functions stay in GPU memory */
+                    fft.transform<1>(kp__->spinor_wave_functions().pw_coeffs(ispn).extra().at(memory_t::host, 0, 2 * i),
+                                     kp__->spinor_wave_functions().pw_coeffs(ispn).extra().at(memory_t::host, 0, 2 * i + 1));
+                    /* add to density */
+                    switch (fft.pu()) {
+                        case CPU: {
+                            #pragma omp parallel for schedule(static)
+                            for (int ir = 0; ir < fft.local_size(); ir++) {
+                                auto z = fft.buffer(ir);
+                                density_rg(ir, ispn) += w1 * std::pow(z.real(), 2) + w2 * std::pow(z.imag(), 2);
+                            }
+                            break;
+                        }
+                        case GPU: {
+#ifdef __GPU
+                            update_density_rg_gamma_gpu(fft.local_size(), fft.buffer().at(memory_t::device), w1, w2,
+                                                        density_rg.at(memory_t::device, 0, ispn));
+#else
+                            TERMINATE_NO_GPU
+#endif
+                            break;
+                        }
+                    }
+                }
+                /* last band which had no pair is done in a normal way */
+                first = num_wf_loc - num_wf_loc % 2;
+            }
+
+            for (int i = first; i < num_wf_loc; i++) {
                 int j = kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col()[i];
                 double w = kp__->band_occupancy(j, ispn) * kp__->weight() / omega;
 
@@ -97,38 +97,46 @@ class Augmentation_operator
         /* number of beta-projectors */
         int nbf = atom_type_.mt_basis_size();
 
+        /* number of radial beta-functions */
+        int nbrf = atom_type_.mt_radial_basis_size();
+
         /* array of plane-wave coefficients */
         q_pw_ = mdarray<double, 2>(mp__, nbf * (nbf + 1) / 2, 2 * gvec_count, "q_pw_");
-        #pragma omp parallel for schedule(static)
-        for (int igloc = 0; igloc < gvec_count; igloc++) {
-            int    ig = gvec_offset + igloc;
-            double g  = gvec_.gvec_len(ig);
-
+        #pragma omp parallel
+        {
+            /* thread-private buffers; radial integrals are written in place for each G-vector */
             std::vector<double_complex> v(lmmax);
+            mdarray<double, 2> ri(nbrf * (nbrf + 1) / 2, 2 * lmax_beta + 1);
 
-            auto ri = radial_integrals__.values(atom_type_.id(), g);
+            #pragma omp for schedule(static)
+            for (int igloc = 0; igloc < gvec_count; igloc++) {
+                int    ig = gvec_offset + igloc;
+                double g  = gvec_.gvec_len(ig);
 
-            for (int xi2 = 0; xi2 < nbf; xi2++) {
-                int lm2    = atom_type_.indexb(xi2).lm;
-                int idxrf2 = atom_type_.indexb(xi2).idxrf;
+                radial_integrals__.packed_values(atom_type_.id(), g, ri.at(memory_t::host));
 
-                for (int xi1 = 0; xi1 <= xi2; xi1++) {
-                    int lm1    = atom_type_.indexb(xi1).lm;
-                    int idxrf1 = atom_type_.indexb(xi1).idxrf;
+                for (int xi2 = 0; xi2 < nbf; xi2++) {
+                    int lm2    = atom_type_.indexb(xi2).lm;
+                    int idxrf2 = atom_type_.indexb(xi2).idxrf;
 
-                    /* packed orbital index */
-                    int idx12 = utils::packed_index(xi1, xi2);
-                    /* packed radial-function index */
-                    int idxrf12 = utils::packed_index(idxrf1, idxrf2);
+                    for (int xi1 = 0; xi1 <= xi2; xi1++) {
+                        int lm1    = atom_type_.indexb(xi1).lm;
+                        int idxrf1 = atom_type_.indexb(xi1).idxrf;
 
-                    for (int lm3 = 0; lm3 < lmmax; lm3++) {
-                        v[lm3] = std::conj(zilm[lm3]) * gvec_rlm(lm3, igloc) * ri(idxrf12, l_by_lm[lm3]);
-                    }
+                        /* packed orbital index */
+                        int idx12 = utils::packed_index(xi1, xi2);
+                        /* packed radial-function index */
+                        int idxrf12 = utils::packed_index(idxrf1, idxrf2);
 
-                    double_complex z = fourpi_omega * gaunt_coefs.sum_L3_gaunt(lm2, lm1, &v[0]);
+                        for (int lm3 = 0; lm3 < lmmax; lm3++) {
+                            v[lm3] = std::conj(zilm[lm3]) * gvec_rlm(lm3, igloc) * ri(idxrf12, l_by_lm[lm3]);
+                        }
 
-                    q_pw_(idx12, 2 * igloc)     = z.real();
-                    q_pw_(idx12, 2 * igloc + 1) = z.imag();
+                        double_complex z = fourpi_omega * gaunt_coefs.sum_L3_gaunt(lm2, lm1, &v[0]);
+
+                        q_pw_(idx12, 2 * igloc)     = z.real();
+                        q_pw_(idx12, 2 * igloc + 1) = z.imag();
+                    }
                 }
             }
         }
@@ -320,43 +328,51 @@ class Augmentation_operator_gvec_deriv
 
         /* number of beta-projectors */
         int nbf = atom_type__.mt_basis_size();
+        /* number of radial beta-functions */
+        int nbrf = atom_type__.mt_radial_basis_size();
 
         /* array of plane-wave coefficients */
         q_pw_ = mdarray<double, 2>(mp__, nbf * (nbf + 1) / 2, 2 * gvec_count, "q_pw_dg_");
-        utils::timer t2("sirius::Augmentation_operator_gvec_deriv::generate_pw_coeffs|qpw");
-        #pragma omp parallel for schedule(static)
-        for (int igloc = 0; igloc < gvec_count; igloc++) {
-            int    ig  = gvec_offset + igloc;
-            double g   = gvec_.gvec_len(ig);
-            auto   gvc = gvec_.gvec_cart<index_domain_t::local>(igloc);
 
+        utils::timer t2("sirius::Augmentation_operator_gvec_deriv::generate_pw_coeffs|qpw");
+        #pragma omp parallel
+        {
             std::vector<double_complex> v(lmmax);
+            mdarray<double, 2> ri(nbrf * (nbrf + 1) / 2, 2 * lmax_beta + 1);
+            mdarray<double, 2> ri_dg(nbrf * (nbrf + 1) / 2, 2 * lmax_beta + 1);
 
-            auto ri    = ri__.values(atom_type__.id(), g);
-            auto ri_dg = ri_dq__.values(atom_type__.id(), g);
+            #pragma omp for schedule(static)
+            for (int igloc = 0; igloc < gvec_count; igloc++) {
+                int    ig  = gvec_offset + igloc;
+                double g   = gvec_.gvec_len(ig);
+                auto   gvc = gvec_.gvec_cart<index_domain_t::local>(igloc);
 
-            for (int xi2 = 0; xi2 < nbf; xi2++) {
-                int lm2    = atom_type__.indexb(xi2).lm;
-                int idxrf2 = atom_type__.indexb(xi2).idxrf;
+                ri__.packed_values(atom_type__.id(), g, ri.at(memory_t::host));
+                ri_dq__.packed_values(atom_type__.id(), g, ri_dg.at(memory_t::host));
 
-                for (int xi1 = 0; xi1 <= xi2; xi1++) {
-                    int lm1    = atom_type__.indexb(xi1).lm;
-                    int idxrf1 = atom_type__.indexb(xi1).idxrf;
+                for (int xi2 = 0; xi2 < nbf; xi2++) {
+                    int lm2    = atom_type__.indexb(xi2).lm;
+                    int idxrf2 = atom_type__.indexb(xi2).idxrf;
 
-                    /* packed orbital index */
-                    int idx12 = xi2 * (xi2 + 1) / 2 + xi1;
-                    /* packed radial-function index */
-                    int idxrf12 = idxrf2 * (idxrf2 + 1) / 2 + idxrf1;
+                    for (int xi1 = 0; xi1 <= xi2; xi1++) {
+                        int lm1    = atom_type__.indexb(xi1).lm;
+                        int idxrf1 = atom_type__.indexb(xi1).idxrf;
 
-                    for (int lm3 = 0; lm3 < lmmax; lm3++) {
-                        v[lm3] = std::conj(zilm[lm3]) * (rlm_dg_(lm3, nu__, igloc) * ri(idxrf12, l_by_lm[lm3]) +
-                                                         rlm_g_(lm3, igloc) * ri_dg(idxrf12, l_by_lm[lm3]) * gvc[nu__]);
-                    }
+                        /* packed orbital index */
+                        int idx12 = xi2 * (xi2 + 1) / 2 + xi1;
+                        /* packed radial-function index */
+                        int idxrf12 = idxrf2 * (idxrf2 + 1) / 2 + idxrf1;
 
-                    double_complex z = fourpi * gaunt_coefs_->sum_L3_gaunt(lm2, lm1, &v[0]);
+                        for (int lm3 = 0; lm3 < lmmax; lm3++) {
+                            v[lm3] = std::conj(zilm[lm3]) * (rlm_dg_(lm3, nu__, igloc) * ri(idxrf12, l_by_lm[lm3]) +
+                                                             rlm_g_(lm3, igloc) * ri_dg(idxrf12, l_by_lm[lm3]) * gvc[nu__]);
+                        }
 
-                    q_pw_(idx12, 2 * igloc)     = z.real();
-                    q_pw_(idx12, 2 * igloc + 1) = z.imag();
+                        double_complex z = fourpi * gaunt_coefs_->sum_L3_gaunt(lm2, lm1, &v[0]);
+
+                        q_pw_(idx12, 2 * igloc)     = z.real();
+                        q_pw_(idx12, 2 * igloc + 1) = z.imag();
+                    }
                 }
             }
         }
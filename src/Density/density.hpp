@@ -37,6 +37,12 @@ extern "C" void update_density_rg_1_gpu(int                   size__,
                                         double                wt__,
                                         double*               density_rg__);
 
+extern "C" void update_density_rg_gamma_gpu(int                   size__,
+                                            double_complex const* psi_rg__,
+                                            double                wt1__,
+                                            double                wt2__,
+                                            double*               density_rg__);
+
 extern "C" void update_density_rg_2_gpu(int                   size__,
                                         double_complex const* psi_rg_up__,
                                         double_complex const* psi_rg_dn__,
@@ -603,8 +609,12 @@ class Density : public Field4D
         if (ngv != ctx_.gvec().num_gvec()) {
             TERMINATE("wrong number of G-vectors");
         }
-        mdarray<int, 2> gv(3, ngv);
-        fin.read("/parameters/gvec", gv);
+        /* the list of G-vectors is only needed for files without the per-rank slabs */
+        mdarray<int, 2> gv;
+        if (!fin["density"].exist("num_slabs")) {
+            gv = mdarray<int, 2>(3, ngv);
+            fin.read("/parameters/gvec", gv);
+        }
 
         rho().hdf5_read(fin["density"], gv);
         rho().fft_transform(1);
@@ -614,6 +624,17 @@ class Density : public Field4D
         }
     }
 
+    /// Load density and magnetization from the set of per-rank checkpoint files.
+    void load_checkpoint(std::string const& prefix__)
+    {
+        rho().hdf5_read_checkpoint(prefix__, "density");
+        rho().fft_transform(1);
+        for (int j = 0; j < ctx_.num_mag_dims(); j++) {
+            magnetization(j).hdf5_read_checkpoint(prefix__, "magnetization/" + std::to_string(j));
+            magnetization(j).fft_transform(1);
+        }
+    }
+
     void save_to_xsf()
     {
         //== FILE* fout = fopen("unit_cell.xsf", "w");
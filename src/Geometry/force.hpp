@@ -29,6 +29,7 @@
 #include "Density/augmentation_operator.hpp"
 #include "Beta_projectors/beta_projectors.hpp"
 #include "Beta_projectors/beta_projectors_gradient.hpp"
+#include "Beta_projectors/beta_projectors_strain_deriv.hpp"
 #include "non_local_functor.hpp"
 
 namespace sirius {
@@ -73,22 +74,35 @@ class Force
 
     mdarray<double, 2> forces_total_;
 
+    /// Add k-point contribution to the non-local forces.
+    /** If stress__ is not null, the non-local contribution of each atom to the stress tensor is computed in the same
+     *  pass over the <beta|psi> blocks. */
     template <typename T>
-    void add_k_point_contribution(K_point& kpoint, mdarray<double, 2>& forces__) const
+    void add_k_point_contribution(K_point& kpoint, mdarray<double, 2>& forces__,
+                                  mdarray<double, 2>* stress__ = nullptr) const
     {
         Beta_projectors_gradient bp_grad(ctx_, kpoint.gkvec(), kpoint.igk_loc(), kpoint.beta_projectors());
         if (is_device_memory(ctx_.preferred_memory_t())) {
-            int nbnd = ctx_.num_bands();
             for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                /* only occupied bands are needed */
+                int nbnd = kpoint.num_occupied_bands(ispn);
                 /* allocate GPU memory */
                 kpoint.spinor_wave_functions().pw_coeffs(ispn).allocate(memory_t::device);
                 kpoint.spinor_wave_functions().pw_coeffs(ispn).copy_to(memory_t::device, 0, nbnd);
             }
         }
 
-        Non_local_functor<T> nlf(ctx_, bp_grad);
+        if (stress__) {
+            Beta_projectors_strain_deriv bp_strain_deriv(ctx_, kpoint.gkvec(), kpoint.igk_loc());
 
-        nlf.add_k_point_contribution(kpoint, forces__);
+            Non_local_functor<T> nlf(ctx_, {&bp_grad, &bp_strain_deriv});
+
+            nlf.add_k_point_contribution(kpoint, {&forces__, stress__});
+        } else {
+            Non_local_functor<T> nlf(ctx_, bp_grad);
+
+            nlf.add_k_point_contribution(kpoint, forces__);
+        }
         if (is_device_memory(ctx_.preferred_memory_t())) {
             for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
                 /* deallocate GPU memory */
@@ -457,6 +471,14 @@ class Force
     }
 
     inline mdarray<double, 2> const& calc_forces_nonloc()
+    {
+        return calc_forces_nonloc(nullptr);
+    }
+
+    /// Compute non-local forces and, optionally, the non-local contribution of each atom to the stress tensor.
+    /** If not null, the array stress_nonloc__ of the dimensions (9, num_atoms) is accumulated locally on each MPI rank
+     *  in the same pass over <beta|psi> blocks, see Stress::calc_stress_nonloc(Force&). */
+    inline mdarray<double, 2> const& calc_forces_nonloc(mdarray<double, 2>* stress_nonloc__)
     {
         PROFILE("sirius::Force::calc_forces_nonloc");
 
@@ -469,9 +491,9 @@ class Force
             K_point* kp = kset_[spl_num_kp[ikploc]];
 
             if (ctx_.gamma_point()) {
-                add_k_point_contribution<double>(*kp, forces_nonloc_);
+                add_k_point_contribution<double>(*kp, forces_nonloc_, stress_nonloc__);
             } else {
-                add_k_point_contribution<double_complex>(*kp, forces_nonloc_);
+                add_k_point_contribution<double_complex>(*kp, forces_nonloc_, stress_nonloc__);
             }
         }
 
@@ -914,6 +936,14 @@ class Force
     }
 
     inline mdarray<double, 2> const& calc_forces_total()
+    {
+        return calc_forces_total(true);
+    }
+
+    /// Compute total forces.
+    /** If compute_nonloc__ is false, the non-local forces which were already computed together with the stress
+     *  tensor in Stress::calc_stress_total(Force&) are reused. */
+    inline mdarray<double, 2> const& calc_forces_total(bool compute_nonloc__)
     {
         forces_total_ = mdarray<double, 2>(3, ctx_.unit_cell().num_atoms());
         if (ctx_.full_potential()) {
@@ -928,7 +958,9 @@ class Force
         } else {
             calc_forces_vloc();
             calc_forces_us();
-            calc_forces_nonloc();
+            if (compute_nonloc__) {
+                calc_forces_nonloc();
+            }
             calc_forces_core();
             calc_forces_ewald();
             calc_forces_scf_corr();
@@ -36,10 +36,17 @@ class Non_local_functor
 {
   private:
     Simulation_context& ctx_;
-    Beta_projectors_base& bp_base_;
+    /// Derivatives of beta-projectors (gradient, strain derivative) which share the same <beta|psi> blocks.
+    std::vector<Beta_projectors_base*> bp_base_;
   public:
 
     Non_local_functor(Simulation_context& ctx__, Beta_projectors_base& bp_base__)
+        : ctx_(ctx__)
+        , bp_base_({&bp_base__})
+    {
+    }
+
+    Non_local_functor(Simulation_context& ctx__, std::vector<Beta_projectors_base*> bp_base__)
         : ctx_(ctx__)
         , bp_base_(bp_base__)
     {
@@ -48,13 +55,31 @@ class Non_local_functor
     /// collect summation result in an array
     void add_k_point_contribution(K_point& kpoint__, mdarray<double, 2>& collect_res__)
     {
+        add_k_point_contribution(kpoint__, std::vector<mdarray<double, 2>*>({&collect_res__}));
+    }
+
+    /// Collect summation result for each set of beta-projector derivatives.
+    /** The <beta|psi> blocks and their contraction with \f$ D_{ij} - \varepsilon_n Q_{ij} \f$ are computed once
+     *  per chunk of atoms and then reused for all components of all derivatives. */
+    void add_k_point_contribution(K_point& kpoint__, std::vector<mdarray<double, 2>*> collect_res__)
+    {
+        PROFILE("sirius::Non_local_functor::add_k_point_contribution");
+
+        if (collect_res__.size() != bp_base_.size()) {
+            TERMINATE("wrong number of result arrays");
+        }
+
         auto& unit_cell = ctx_.unit_cell();
 
         auto& bp = kpoint__.beta_projectors();
 
         double main_two_factor{-2};
 
-        for (int icnk = 0; icnk < bp_base_.num_chunks(); icnk++) {
+        for (auto b: bp_base_) {
+            b->prepare();
+        }
+
+        for (int icnk = 0; icnk < bp_base_[0]->num_chunks(); icnk++) {
 
             bp.prepare();
             /* generate chunk for inner product of beta */
@@ -69,105 +94,141 @@ class Non_local_functor
             }
             bp.dismiss();
 
-            bp_base_.prepare();
-            for (int x = 0; x < bp_base_.num_comp(); x++) {
-                /* generate chunk for inner product of beta gradient */
-                bp_base_.generate(icnk, x);
+            auto& chunk = bp_base_[0]->chunk(icnk);
 
-                for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                    int spin_factor = (ispn == 0 ? 1 : -1);
+            /* - 2 occ(k,n) weight(k) [ Dij - E(n)Qij]^{*} beta_phi*(j,n) for spin up and down */
+            matrix<double_complex> dq_beta_phi[2];
 
-                    int nbnd = kpoint__.num_occupied_bands(ispn);
+            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                int spin_factor = (ispn == 0 ? 1 : -1);
 
-                    /* inner product of beta gradient and WF */
-                    auto bp_base_phi_chunk = bp_base_.template inner<T>(icnk, kpoint__.spinor_wave_functions(), ispn, 0, nbnd);
+                int nbnd = kpoint__.num_occupied_bands(ispn);
 
-                    splindex<block> spl_nbnd(nbnd, kpoint__.comm().size(), kpoint__.comm().rank());
+                splindex<block> spl_nbnd(nbnd, kpoint__.comm().size(), kpoint__.comm().rank());
 
-                    int nbnd_loc = spl_nbnd.local_size();
+                int nbnd_loc = spl_nbnd.local_size();
 
-                    #pragma omp parallel for
-                    for (int ia_chunk = 0; ia_chunk < bp_base_.chunk(icnk).num_atoms_; ia_chunk++) {
-                        int ia   = bp_base_.chunk(icnk).desc_(beta_desc_idx::ia, ia_chunk);
-                        int offs = bp_base_.chunk(icnk).desc_(beta_desc_idx::offset, ia_chunk);
-                        int nbf  = bp_base_.chunk(icnk).desc_(beta_desc_idx::nbf, ia_chunk);
-                        int iat  = unit_cell.atom(ia).type_id();
+                dq_beta_phi[ispn] = matrix<double_complex>(chunk.num_beta_, nbnd_loc);
+                dq_beta_phi[ispn].zero();
 
-                        if (unit_cell.atom(ia).type().spin_orbit_coupling()) {
-                            TERMINATE("stress and forces with SO coupling are not upported");
-                        }
+                #pragma omp parallel for
+                for (int ia_chunk = 0; ia_chunk < chunk.num_atoms_; ia_chunk++) {
+                    int ia   = chunk.desc_(beta_desc_idx::ia, ia_chunk);
+                    int offs = chunk.desc_(beta_desc_idx::offset, ia_chunk);
+                    int nbf  = chunk.desc_(beta_desc_idx::nbf, ia_chunk);
+                    int iat  = unit_cell.atom(ia).type_id();
 
-                        /* helper lambda to calculate for sum loop over bands for different beta_phi and dij combinations*/
-                        auto for_bnd = [&](int ibf, int jbf, double_complex dij, double_complex qij, matrix<T>& beta_phi_chunk)
-                        {
-                            /* gather everything = - 2  Re[ occ(k,n) weight(k) beta_phi*(i,n) [ Dij - E(n)Qij] beta_base_phi(j,n) ]*/
-                            for (int ibnd_loc = 0; ibnd_loc < nbnd_loc; ibnd_loc++) {
-                                int ibnd = spl_nbnd[ibnd_loc];
+                    if (unit_cell.atom(ia).type().spin_orbit_coupling()) {
+                        TERMINATE("stress and forces with SO coupling are not upported");
+                    }
 
-                                double_complex scalar_part = main_two_factor * kpoint__.band_occupancy(ibnd, ispn) * kpoint__.weight() *
-                                        std::conj(beta_phi_chunk(offs + jbf, ibnd)) * bp_base_phi_chunk(offs + ibf, ibnd) *
-                                        (dij - kpoint__.band_energy(ibnd, ispn) * qij);
+                    /* helper lambda to calculate for sum loop over bands for different beta_phi and dij combinations*/
+                    auto for_bnd = [&](int ibf, int jbf, double_complex dij, double_complex qij, matrix<T>& beta_phi_chunk)
+                    {
+                        for (int ibnd_loc = 0; ibnd_loc < nbnd_loc; ibnd_loc++) {
+                            int ibnd = spl_nbnd[ibnd_loc];
 
-                                /* get real part and add to the result array*/
-                                collect_res__(x, ia) += scalar_part.real();
-                            }
-                        };
-
-                        for (int ibf = 0; ibf < nbf; ibf++) {
-                            int lm2    = unit_cell.atom(ia).type().indexb(ibf).lm;
-                            int idxrf2 = unit_cell.atom(ia).type().indexb(ibf).idxrf;
-                            for (int jbf = 0; jbf < nbf; jbf++) {
-                                int lm1    = unit_cell.atom(ia).type().indexb(jbf).lm;
-                                int idxrf1 = unit_cell.atom(ia).type().indexb(jbf).idxrf;
-
-                                /* Qij exists only in the case of ultrasoft/PAW */
-                                double qij = unit_cell.atom(ia).type().augment() ? ctx_.augmentation_op(iat).q_mtrx(ibf, jbf) : 0.0;
-                                double_complex dij = 0.0;
-
-                                /* get non-magnetic or collinear spin parts of dij*/
-                                switch (ctx_.num_spins()) {
-                                    case 1: {
-                                        dij = unit_cell.atom(ia).d_mtrx(ibf, jbf, 0);
-                                        if (lm1 == lm2) {
-                                            dij += unit_cell.atom(ia).type().d_mtrx_ion()(idxrf1, idxrf2);
-                                        }
-                                        break;
+                            dq_beta_phi[ispn](offs + ibf, ibnd_loc) += main_two_factor *
+                                kpoint__.band_occupancy(ibnd, ispn) * kpoint__.weight() *
+                                std::conj(beta_phi_chunk(offs + jbf, ibnd)) *
+                                (dij - kpoint__.band_energy(ibnd, ispn) * qij);
+                        }
+                    };
+
+                    for (int ibf = 0; ibf < nbf; ibf++) {
+                        int lm2    = unit_cell.atom(ia).type().indexb(ibf).lm;
+                        int idxrf2 = unit_cell.atom(ia).type().indexb(ibf).idxrf;
+                        for (int jbf = 0; jbf < nbf; jbf++) {
+                            int lm1    = unit_cell.atom(ia).type().indexb(jbf).lm;
+                            int idxrf1 = unit_cell.atom(ia).type().indexb(jbf).idxrf;
+
+                            /* Qij exists only in the case of ultrasoft/PAW */
+                            double qij = unit_cell.atom(ia).type().augment() ? ctx_.augmentation_op(iat).q_mtrx(ibf, jbf) : 0.0;
+                            double_complex dij = 0.0;
+
+                            /* get non-magnetic or collinear spin parts of dij*/
+                            switch (ctx_.num_spins()) {
+                                case 1: {
+                                    dij = unit_cell.atom(ia).d_mtrx(ibf, jbf, 0);
+                                    if (lm1 == lm2) {
+                                        dij += unit_cell.atom(ia).type().d_mtrx_ion()(idxrf1, idxrf2);
                                     }
+                                    break;
+                                }
 
-                                    case 2: {
-                                        /* Dij(00) = dij + dij_Z ;  Dij(11) = dij - dij_Z*/
-                                        dij = (unit_cell.atom(ia).d_mtrx(ibf, jbf, 0) + spin_factor * unit_cell.atom(ia).d_mtrx(ibf, jbf, 1));
-                                        if (lm1 == lm2) {
-                                            dij += unit_cell.atom(ia).type().d_mtrx_ion()(idxrf1, idxrf2);
-                                        }
-                                        break;
+                                case 2: {
+                                    /* Dij(00) = dij + dij_Z ;  Dij(11) = dij - dij_Z*/
+                                    dij = (unit_cell.atom(ia).d_mtrx(ibf, jbf, 0) + spin_factor * unit_cell.atom(ia).d_mtrx(ibf, jbf, 1));
+                                    if (lm1 == lm2) {
+                                        dij += unit_cell.atom(ia).type().d_mtrx_ion()(idxrf1, idxrf2);
                                     }
+                                    break;
+                                }
 
-                                    default: {
-                                        TERMINATE("Error in non_local_functor, D_aug_mtrx. ");
-                                        break;
-                                    }
+                                default: {
+                                    TERMINATE("Error in non_local_functor, D_aug_mtrx. ");
+                                    break;
                                 }
+                            }
+
+                            /* add non-magnetic or diagonal spin components (or collinear part) */
+                            for_bnd(ibf, jbf, dij, double_complex(qij, 0.0), beta_phi_chunks[ispn]);
+
+                            /* for non-collinear case*/
+                            if (ctx_.num_mag_dims() == 3) {
+                                /* Dij(10) = dij_X + i dij_Y ; Dij(01) = dij_X - i dij_Y */
+                                dij = double_complex( unit_cell.atom(ia).d_mtrx(ibf, jbf, 2), spin_factor * unit_cell.atom(ia).d_mtrx(ibf, jbf, 3));
+                                /* add non-diagonal spin components*/
+                                for_bnd(ibf, jbf, dij, double_complex(0.0, 0.0), beta_phi_chunks[ispn + spin_factor] );
+                            }
+                        } // jbf
+                    } // ibf
+                } // ia_chunk
+            } // ispn
+
+            for (size_t ib = 0; ib < bp_base_.size(); ib++) {
+                auto& bp_base = *bp_base_[ib];
+                auto& collect_res = *collect_res__[ib];
+
+                for (int x = 0; x < bp_base.num_comp(); x++) {
+                    /* generate chunk for inner product of beta gradient */
+                    bp_base.generate(icnk, x);
 
-                                /* add non-magnetic or diagonal spin components (or collinear part) */
-                                for_bnd(ibf, jbf, dij, double_complex(qij, 0.0), beta_phi_chunks[ispn]);
+                    for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                        int nbnd = kpoint__.num_occupied_bands(ispn);
 
-                                /* for non-collinear case*/
-                                if (ctx_.num_mag_dims() == 3) {
-                                    /* Dij(10) = dij_X + i dij_Y ; Dij(01) = dij_X - i dij_Y */
-                                    dij = double_complex( unit_cell.atom(ia).d_mtrx(ibf, jbf, 2), spin_factor * unit_cell.atom(ia).d_mtrx(ibf, jbf, 3));
-                                    /* add non-diagonal spin components*/
-                                    for_bnd(ibf, jbf, dij, double_complex(0.0, 0.0), beta_phi_chunks[ispn + spin_factor] );
+                        /* inner product of beta gradient and WF */
+                        auto bp_base_phi_chunk = bp_base.template inner<T>(icnk, kpoint__.spinor_wave_functions(), ispn, 0, nbnd);
+
+                        splindex<block> spl_nbnd(nbnd, kpoint__.comm().size(), kpoint__.comm().rank());
+
+                        int nbnd_loc = spl_nbnd.local_size();
+
+                        /* gather everything = - 2  Re[ occ(k,n) weight(k) beta_phi*(i,n) [ Dij - E(n)Qij] beta_base_phi(j,n) ]*/
+                        #pragma omp parallel for
+                        for (int ia_chunk = 0; ia_chunk < chunk.num_atoms_; ia_chunk++) {
+                            int ia   = chunk.desc_(beta_desc_idx::ia, ia_chunk);
+                            int offs = chunk.desc_(beta_desc_idx::offset, ia_chunk);
+                            int nbf  = chunk.desc_(beta_desc_idx::nbf, ia_chunk);
+
+                            double res{0};
+                            for (int ibnd_loc = 0; ibnd_loc < nbnd_loc; ibnd_loc++) {
+                                int ibnd = spl_nbnd[ibnd_loc];
+                                for (int ibf = 0; ibf < nbf; ibf++) {
+                                    res += std::real(dq_beta_phi[ispn](offs + ibf, ibnd_loc) *
+                                                     bp_base_phi_chunk(offs + ibf, ibnd));
                                 }
-                            } // jbf
-                        } // ibf
-                    } // ia_chunk
-                } // ispn
-            } // x
+                            }
+                            collect_res(x, ia) += res;
+                        } // ia_chunk
+                    } // ispn
+                } // x
+            } // ib
         }
 
-        //bp.dismiss();
-        bp_base_.dismiss();
+        for (auto b: bp_base_) {
+            b->dismiss();
+        }
     }
 };
 
@@ -27,6 +27,7 @@
 
 #include "Beta_projectors/beta_projectors_strain_deriv.hpp"
 #include "non_local_functor.hpp"
+#include "force.hpp"
 
 namespace sirius {
 
@@ -212,14 +213,13 @@ class Stress {
         mdarray<double, 2> collect_result(9, ctx_.unit_cell().num_atoms());
         collect_result.zero();
 
-        stress_nonloc_.zero();
-
         for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
             int ik = kset_.spl_num_kpoints(ikloc);
             auto kp = kset_[ik];
             if (is_device_memory(ctx_.preferred_memory_t())) {
-                int nbnd = ctx_.num_bands();
                 for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                    /* only occupied bands are needed */
+                    int nbnd = kp->num_occupied_bands(ispn);
                     /* allocate GPU memory */
                     kp->spinor_wave_functions().pw_coeffs(ispn).allocate(memory_t::device);
                     kp->spinor_wave_functions().pw_coeffs(ispn).copy_to(memory_t::device, 0, nbnd);
@@ -239,6 +239,14 @@ class Stress {
             }
         }
 
+        reduce_stress_nonloc(collect_result);
+    }
+
+    /// Sum the non-local contributions of atoms (accumulated locally on each MPI rank) into the stress tensor.
+    inline void reduce_stress_nonloc(mdarray<double, 2> const& collect_result)
+    {
+        stress_nonloc_.zero();
+
         #pragma omp parallel
         {
             matrix3d<double> tmp_stress; // TODO: test pragma omp paralell for reduction(+:stress)
@@ -659,6 +667,22 @@ class Stress {
         return stress_nonloc_;
     }
 
+    /// Compute non-local contribution to the stress tensor together with the non-local forces.
+    /** The <beta|psi> blocks are computed once and shared between the gradient and the strain derivative of
+     *  beta-projectors. The non-local forces are stored in forces__ and can be reused in
+     *  Force::calc_forces_total(false). */
+    inline matrix3d<double> calc_stress_nonloc(Force& forces__)
+    {
+        mdarray<double, 2> collect_result(9, ctx_.unit_cell().num_atoms());
+        collect_result.zero();
+
+        forces__.calc_forces_nonloc(&collect_result);
+
+        reduce_stress_nonloc(collect_result);
+
+        return stress_nonloc_;
+    }
+
     inline matrix3d<double> stress_nonloc() const
     {
         return stress_nonloc_;
@@ -997,6 +1021,17 @@ class Stress {
     }
 
     inline matrix3d<double> calc_stress_total()
+    {
+        return calc_stress_total_aux(nullptr);
+    }
+
+    /// Compute total stress tensor and the non-local forces in a single pass over <beta|psi> blocks.
+    inline matrix3d<double> calc_stress_total(Force& forces__)
+    {
+        return calc_stress_total_aux(&forces__);
+    }
+
+    inline matrix3d<double> calc_stress_total_aux(Force* forces__)
     {
         calc_stress_kin();
         calc_stress_har();
@@ -1005,7 +1040,11 @@ class Stress {
         calc_stress_core();
         calc_stress_xc();
         calc_stress_us();
-        calc_stress_nonloc();
+        if (forces__) {
+            calc_stress_nonloc(*forces__);
+        } else {
+            calc_stress_nonloc();
+        }
         stress_hubbard_.zero();
         if (ctx_.hubbard_correction()) {
             calc_stress_hubbard();
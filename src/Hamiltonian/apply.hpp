@@ -167,11 +167,7 @@ void Hamiltonian::apply_h_s(K_point* kp__,
         // functions on GPU (if needed)
         this->U().apply_hubbard_potential(*kp__, ispn__, N__, n__, phi__, *hphi__);
 
-        if (ctx_.processing_unit() == device_t::GPU) {
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                kp__->hubbard_wave_functions().deallocate(spin_idx(ispn), memory_t::device);
-            }
-        }
+        this->U().deallocate_hubbard_orbitals_on_device(*kp__);
     }
 
     if ((ctx_.control().print_checksum_) && (hphi__ != nullptr) && (sphi__ != nullptr)) {
@@ -34,43 +34,48 @@ void Hubbard::apply_hubbard_potential(K_point&        kp__,
                                       Wave_functions& phi,
                                       Wave_functions& hphi)
 {
-    auto& hub_wf = kp__.hubbard_wave_functions();
-
-    dmatrix<double_complex> dm(this->number_of_hubbard_orbitals(), n__);
-    dm.zero();
+    /* projections and the action of the potential are computed for one chunk of atoms at a time */
+    dmatrix<double_complex> dm(max_chunk_num_wf_, n__);
+    dmatrix<double_complex> Up(max_chunk_num_wf_, n__);
 
     if (ctx_.processing_unit() == device_t::GPU) {
         dm.allocate(memory_t::device);
+        Up.allocate(memory_t::device);
     }
 
-    /* First calculate the local part of the projections
-       dm(i, n) = <phi_i| S |psi_{nk}> */
-    inner(ctx_.preferred_memory_t(),
-          ctx_.blas_linalg_t(),
-          ispn__,
-          hub_wf,
-          0,
-          this->number_of_hubbard_orbitals(),
-          phi,
-          idx__,
-          n__,
-          dm,
-          0,
-          0);
+    const int ld = static_cast<int>(this->hubbard_potential_.size(0));
+
+    for (int ichunk = 0; ichunk < static_cast<int>(hubbard_chunks_.size()); ichunk++) {
+        auto& chunk   = hubbard_chunks_[ichunk];
+        const int nwf = chunk.num_wf_;
+
+        /* S|phi> of the chunk and the index of its first orbital */
+        auto hub      = hubbard_orbitals(kp__, ichunk);
+        auto& hub_wf  = *hub.first;
 
-    // this should be taken care by inner() itself
-    //if (ctx_.processing_unit() == GPU) {
-    //    dm.copy_to(memory_t::host);
-    //}
+        /* First calculate the local part of the projections
+           dm(i, n) = <phi_i| S |psi_{nk}> */
+        inner(ctx_.preferred_memory_t(),
+              ctx_.blas_linalg_t(),
+              ispn__,
+              hub_wf,
+              hub.second,
+              nwf,
+              phi,
+              idx__,
+              n__,
+              dm,
+              0,
+              0);
 
-    dmatrix<double_complex> Up(this->number_of_hubbard_orbitals(), n__);
-    Up.zero();
+        Up.zero();
 
-    #pragma omp parallel for schedule(static)
-    for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ++ia) {
-        const auto& atom = ctx_.unit_cell().atom(ia);
-        if (atom.type().hubbard_correction()) {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < static_cast<int>(chunk.atoms_.size()); i++) {
+            const int ia      = chunk.atoms_[i];
+            const auto& atom  = ctx_.unit_cell().atom(ia);
             const int lmax_at = 2 * atom.type().hubbard_orbital(0).l() + 1;
+            const int i0      = this->offset[ia] - chunk.offset_;
             // we apply the hubbard correction. For now I have no papers
             // giving me the formula for the SO case so I rely on QE for it
             // but I do not like it at all
@@ -78,50 +83,41 @@ void Hubbard::apply_hubbard_potential(K_point&        kp__,
                 for (int s1 = 0; s1 < ctx_.num_spins(); s1++) {
                     for (int s2 = 0; s2 < ctx_.num_spins(); s2++) {
                         const int ind = (s1 == s2) * s1 + (1 + 2 * s2 + s1) * (s1 != s2);
-
-                        // !!! Replace this with matrix matrix multiplication
-
-                        for (int nbd = 0; nbd < n__; nbd++) {
-                            for (int m1 = 0; m1 < lmax_at; m1++) {
-                                for (int m2 = 0; m2 < lmax_at; m2++) {
-                                    Up(this->offset[ia] + s1 * lmax_at + m1, nbd) += this->hubbard_potential_(m2, m1, ind, ia, 0) *
-                                        dm(this->offset[ia] + s2 * lmax_at + m2, nbd);
-                                }
-                            }
-                        }
+                        /* Up(s1 m1, n) += \sum_{m2} U(m2, m1, s1 s2) dm(s2 m2, n) */
+                        linalg<CPU>::gemm(1, 0, lmax_at, n__, lmax_at, linalg_const<double_complex>::one(),
+                                          this->hubbard_potential_.at(memory_t::host, 0, 0, ind, ia, 0), ld,
+                                          dm.at(memory_t::host, i0 + s2 * lmax_at, 0), dm.ld(),
+                                          linalg_const<double_complex>::one(),
+                                          Up.at(memory_t::host, i0 + s1 * lmax_at, 0), Up.ld());
                     }
                 }
             } else {
                 // Conventional LDA or colinear magnetism
-                for (int nbd = 0; nbd < n__; nbd++) {
-                    for (int m1 = 0; m1 < lmax_at; m1++) {
-                        for (int m2 = 0; m2 < lmax_at; m2++) {
-                            Up(this->offset[ia] + m1, nbd) += this->hubbard_potential_(m2, m1, ispn__, ia, 0) *
-                                dm(this->offset[ia] + m2, nbd);
-                        }
-                    }
-                }
+                linalg<CPU>::gemm(1, 0, lmax_at, n__, lmax_at, linalg_const<double_complex>::one(),
+                                  this->hubbard_potential_.at(memory_t::host, 0, 0, ispn__, ia, 0), ld,
+                                  dm.at(memory_t::host, i0, 0), dm.ld(),
+                                  linalg_const<double_complex>::zero(),
+                                  Up.at(memory_t::host, i0, 0), Up.ld());
             }
         }
-    }
 
-    if (ctx_.processing_unit() == device_t::GPU) {
-        Up.allocate(memory_t::device);
-        Up.copy_to(memory_t::device);
-    }
+        if (ctx_.processing_unit() == device_t::GPU) {
+            Up.copy_to(memory_t::device);
+        }
 
-    transform<double_complex>(ctx_.preferred_memory_t(),
-                              ctx_.blas_linalg_t(),
-                              ispn__,
-                              1.0,
-                              {&hub_wf},
-                              0,
-                              this->number_of_hubbard_orbitals(),
-                              Up,
-                              0,
-                              0,
-                              1.0,
-                              {&hphi},
-                              idx__,
-                              n__);
+        transform<double_complex>(ctx_.preferred_memory_t(),
+                                  ctx_.blas_linalg_t(),
+                                  ispn__,
+                                  1.0,
+                                  {&hub_wf},
+                                  hub.second,
+                                  nwf,
+                                  Up,
+                                  0,
+                                  0,
+                                  1.0,
+                                  {&hphi},
+                                  idx__,
+                                  n__);
+    }
 }
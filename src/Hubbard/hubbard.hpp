@@ -84,6 +84,37 @@ class Hubbard
     /// file containing the hubbard wave functions
     std::string wave_function_file_;
 
+    /// Block of Hubbard orbitals of several consecutive atoms.
+    struct hubbard_chunk_t
+    {
+        /// Index of the first orbital of the chunk.
+        int offset_;
+        /// Number of orbitals in the chunk.
+        int num_wf_;
+        /// List of atoms with Hubbard correction in the chunk.
+        std::vector<int> atoms_;
+    };
+
+    /// Hubbard orbitals are processed in chunks of atoms.
+    /** Only the atom-diagonal blocks of <phi|S|psi><psi|S|phi> are needed, so there is no need to keep
+     *  the projections and the occupancy matrix for the whole set of Hubbard orbitals. */
+    std::vector<hubbard_chunk_t> hubbard_chunks_;
+
+    /// Maximum number of orbitals in a chunk.
+    int max_chunk_num_wf_{0};
+
+    /// Overlap operator used to generate S|phi> of a chunk of atoms on demand.
+    std::unique_ptr<Q_operator<double_complex>> q_op_;
+
+    /// True if the Hubbard orbitals are generated for each chunk of atoms separately.
+    /** Orbitals are only normalized (not orthogonalized) in this case, which can be done chunk by chunk. The
+     *  chunks are generated on demand, kept for the band solution of a k-point and released afterwards, so
+     *  the orbitals are stored for one k-point at a time instead of for all local k-points. */
+    inline bool chunked_orbitals() const
+    {
+        return !orthogonalize_hubbard_orbitals_;
+    }
+
     void calculate_initial_occupation_numbers();
 
     void compute_occupancies(K_point&                    kp,
@@ -91,7 +122,6 @@ class Hubbard
                              dmatrix<double_complex>&    dphi_s_psi,
                              Wave_functions&             dphi,
                              mdarray<double_complex, 5>& dn_,
-                             matrix<double_complex>&     dm,
                              const int                   index);
 
     inline void symmetrize_occupancy_matrix_noncolinear_case();
@@ -129,6 +159,27 @@ class Hubbard
         }
 
         this->number_of_hubbard_orbitals_ = counter;
+
+        /* split the atoms with Hubbard correction into chunks */
+        hubbard_chunks_.clear();
+        max_chunk_num_wf_ = 0;
+        for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+            if (offset[ia] < 0) {
+                continue;
+            }
+            if (hubbard_chunks_.empty() ||
+                static_cast<int>(hubbard_chunks_.back().atoms_.size()) == ctx_.control().beta_chunk_size_) {
+                hubbard_chunk_t chunk;
+                chunk.offset_ = offset[ia];
+                hubbard_chunks_.push_back(chunk);
+            }
+            hubbard_chunks_.back().atoms_.push_back(ia);
+        }
+        for (size_t i = 0; i < hubbard_chunks_.size(); i++) {
+            int end = (i + 1 < hubbard_chunks_.size()) ? hubbard_chunks_[i + 1].offset_ : counter;
+            hubbard_chunks_[i].num_wf_ = end - hubbard_chunks_[i].offset_;
+            max_chunk_num_wf_ = std::max(max_chunk_num_wf_, hubbard_chunks_[i].num_wf_);
+        }
     }
 
     /// Compute the strain gradient of the hubbard wave functions.
@@ -149,8 +200,50 @@ class Hubbard
                           const int                   idx0,
                           const int                   num_phi);
 
+    /// Generate S|phi> of num_wf Hubbard orbitals placed at the given offsets.
+    void generate_s_phi(K_point& kp, Q_operator<double_complex>& q_op, std::vector<int>& offset__, int num_wf__,
+                        Wave_functions& s_phi__);
+
     /// orthogonize (normalize) the hubbard wave functions
-    void orthogonalize_atomic_orbitals(K_point& kp, Wave_functions& sphi);
+    void orthogonalize_atomic_orbitals(Wave_functions& sphi, Wave_functions& s_phi__, int num_wf__);
+
+    /// Get S|phi> of the Hubbard orbitals of a chunk of atoms.
+    /** Returns the wave-functions and the index of the first orbital of the chunk in them. The beta-projectors
+     *  of the k-point must be prepared if a chunk has to be generated. */
+    inline std::pair<Wave_functions*, int> hubbard_orbitals(K_point& kp__, int ichunk__)
+    {
+        auto& chunk = hubbard_chunks_[ichunk__];
+        if (!chunked_orbitals()) {
+            return std::make_pair(&kp__.hubbard_wave_functions(), chunk.offset_);
+        }
+
+        auto& chunks = kp__.hubbard_wave_functions_chunks();
+        chunks.resize(hubbard_chunks_.size());
+
+        if (!chunks[ichunk__]) {
+            const int num_sc = (ctx_.num_mag_dims() == 3) ? 2 : 1;
+            chunks[ichunk__] = std::unique_ptr<Wave_functions>(
+                new Wave_functions(kp__.gkvec_partition(), chunk.num_wf_, ctx_.preferred_memory_t(), num_sc));
+            if (!q_op_) {
+                q_op_ = std::unique_ptr<Q_operator<double_complex>>(new Q_operator<double_complex>(ctx_));
+            }
+            std::vector<int> offs(unit_cell_.num_atoms(), -1);
+            for (int ia : chunk.atoms_) {
+                offs[ia] = offset[ia] - chunk.offset_;
+            }
+            generate_s_phi(kp__, *q_op_, offs, chunk.num_wf_, *chunks[ichunk__]);
+        } else if (ctx_.processing_unit() == device_t::GPU) {
+            /* the host copy is up to date; restore the device copy if it was released */
+            auto& phi = *chunks[ichunk__];
+            for (int ispn = 0; ispn < phi.num_sc(); ispn++) {
+                if (!phi.pw_coeffs(ispn).prime().on_device()) {
+                    phi.pw_coeffs(ispn).prime().allocate(memory_t::device);
+                    phi.pw_coeffs(ispn).copy_to(memory_t::device, 0, chunk.num_wf_);
+                }
+            }
+        }
+        return std::make_pair(chunks[ichunk__].get(), 0);
+    }
 
   public:
     std::vector<int> offset;
@@ -222,6 +315,34 @@ class Hubbard
     void generate_atomic_orbitals(K_point& kp, Q_operator<double_complex>& q_op);
     void generate_atomic_orbitals(K_point& kp, Q_operator<double>& q_op);
 
+    /// Release the device copy of the Hubbard orbitals of a k-point.
+    void deallocate_hubbard_orbitals_on_device(K_point& kp__)
+    {
+        if (ctx_.processing_unit() != device_t::GPU) {
+            return;
+        }
+        if (chunked_orbitals()) {
+            for (auto& e : kp__.hubbard_wave_functions_chunks()) {
+                for (int ispn = 0; e && ispn < e->num_sc(); ispn++) {
+                    e->pw_coeffs(ispn).deallocate(memory_t::device);
+                }
+            }
+        } else {
+            for (int ispn = 0; ispn < kp__.hubbard_wave_functions().num_sc(); ispn++) {
+                kp__.hubbard_wave_functions().pw_coeffs(ispn).deallocate(memory_t::device);
+            }
+        }
+    }
+
+    /// Release the Hubbard orbitals of a k-point which are generated per chunk of atoms.
+    /** Called after the band solution and the occupancy of a k-point; the full set of orbitals is kept. */
+    void release_hubbard_orbitals(K_point& kp__)
+    {
+        if (chunked_orbitals()) {
+            kp__.hubbard_wave_functions_chunks().clear();
+        }
+    }
+
     void hubbard_compute_occupation_numbers(K_point_set& kset_);
 
     void compute_occupancies_derivatives(K_point&                    kp,
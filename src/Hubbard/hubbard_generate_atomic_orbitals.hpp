@@ -32,6 +32,12 @@ void Hubbard::generate_atomic_orbitals(K_point& kp, Q_operator<double_complex>&
 
     const int num_sc = (ctx_.num_mag_dims() == 3) ? 2 : 1;
 
+    // without orthogonalization the orbitals are generated for each chunk of atoms on demand by
+    // hubbard_orbitals()
+    if (chunked_orbitals()) {
+        return;
+    }
+
     // return immediately if the wave functions are already allocated
     if (kp.hubbard_wave_functions_calculated()) {
 
@@ -50,10 +56,18 @@ void Hubbard::generate_atomic_orbitals(K_point& kp, Q_operator<double_complex>&
 
     kp.allocate_hubbard_wave_functions(this->number_of_hubbard_orbitals());
 
+    generate_s_phi(kp, q_op, this->offset, this->number_of_hubbard_orbitals(), kp.hubbard_wave_functions());
+}
+
+void Hubbard::generate_s_phi(K_point& kp, Q_operator<double_complex>& q_op, std::vector<int>& offset__, int num_wf__,
+                             Wave_functions& s_phi__)
+{
+    const int num_sc = (ctx_.num_mag_dims() == 3) ? 2 : 1;
+
     // temporary wave functions
-    Wave_functions sphi(kp.gkvec_partition(), this->number_of_hubbard_orbitals(), ctx_.preferred_memory_t(), num_sc);
+    Wave_functions sphi(kp.gkvec_partition(), num_wf__, ctx_.preferred_memory_t(), num_sc);
 
-    kp.generate_atomic_wave_functions_aux(this->number_of_hubbard_orbitals(), sphi, this->offset, true);
+    kp.generate_atomic_wave_functions_aux(num_wf__, sphi, offset__, true);
 
     // check if we have a norm conserving pseudo potential only
     bool augment{false};
@@ -66,15 +80,15 @@ void Hubbard::generate_atomic_orbitals(K_point& kp, Q_operator<double_complex>&
             /* allocate GPU memory */
             sphi.pw_coeffs(ispn).prime().allocate(memory_t::device);
             // can do async copy
-            sphi.pw_coeffs(ispn).copy_to(memory_t::device, 0, this->number_of_hubbard_orbitals());
-            kp.hubbard_wave_functions().pw_coeffs(ispn).prime().allocate(memory_t::device);
+            sphi.pw_coeffs(ispn).copy_to(memory_t::device, 0, num_wf__);
+            s_phi__.pw_coeffs(ispn).prime().allocate(memory_t::device);
         }
     }
 
     for (int s = 0; s < num_sc; s++) {
         // I need to consider the case where all atoms are norm
         // conserving. In that case the S operator is diagonal in orbital space
-        kp.hubbard_wave_functions().copy_from(ctx_.processing_unit(), this->number_of_hubbard_orbitals(), sphi, s, 0, s, 0);
+        s_phi__.copy_from(ctx_.processing_unit(), num_wf__, sphi, s, 0, s, 0);
     }
 
     if (!ctx_.full_potential() && augment) {
@@ -85,31 +99,31 @@ void Hubbard::generate_atomic_orbitals(K_point& kp, Q_operator<double_complex>&
             /* non-collinear case */
             for (int ispn = 0; ispn < num_sc; ispn++) {
 
-                auto beta_phi = kp.beta_projectors().inner<double_complex>(i, sphi, ispn, 0, this->number_of_hubbard_orbitals());
+                auto beta_phi = kp.beta_projectors().inner<double_complex>(i, sphi, ispn, 0, num_wf__);
                 /* apply Q operator (diagonal in spin) */
-                q_op.apply(i, ispn, kp.hubbard_wave_functions(), 0, this->number_of_hubbard_orbitals(), kp.beta_projectors(), beta_phi);
+                q_op.apply(i, ispn, s_phi__, 0, num_wf__, kp.beta_projectors(), beta_phi);
                 /* apply non-diagonal spin blocks */
                 if (ctx_.so_correction()) {
-                    q_op.apply(i, ispn ^ 3, kp.hubbard_wave_functions(), 0, this->number_of_hubbard_orbitals(), kp.beta_projectors(),
+                    q_op.apply(i, ispn ^ 3, s_phi__, 0, num_wf__, kp.beta_projectors(),
                                beta_phi);
                 }
             }
         }
     }
 
-    orthogonalize_atomic_orbitals(kp, sphi);
+    orthogonalize_atomic_orbitals(sphi, s_phi__, num_wf__);
 
     // All calculations on GPU then we need to copy the final result back to the cpus
     if (ctx_.processing_unit() == device_t::GPU) {
         for (int ispn = 0; ispn < num_sc; ispn++) {
             sphi.pw_coeffs(ispn).prime().deallocate(memory_t::device);
             // copy the hubbard wave functions on the host and then deallocate on GPU
-            kp.hubbard_wave_functions().pw_coeffs(ispn).copy_to(memory_t::host, 0, this->number_of_hubbard_orbitals());
+            s_phi__.pw_coeffs(ispn).copy_to(memory_t::host, 0, num_wf__);
         }
     }
 }
 
-void Hubbard::orthogonalize_atomic_orbitals(K_point& kp, Wave_functions& sphi)
+void Hubbard::orthogonalize_atomic_orbitals(Wave_functions& sphi, Wave_functions& s_phi__, int num_wf__)
 {
     // do we orthogonalize the all thing
 
@@ -121,7 +135,7 @@ void Hubbard::orthogonalize_atomic_orbitals(K_point& kp, Wave_functions& sphi)
             augment = ctx_.unit_cell().atom_type(ia).augment();
         }
 
-        dmatrix<double_complex> S(this->number_of_hubbard_orbitals(), this->number_of_hubbard_orbitals());
+        dmatrix<double_complex> S(num_wf__, num_wf__);
         S.zero();
 
         if (ctx_.processing_unit() == device_t::GPU) {
@@ -136,14 +150,14 @@ void Hubbard::orthogonalize_atomic_orbitals(K_point& kp, Wave_functions& sphi)
         }
 
         if (ctx_.num_mag_dims() == 3) {
-            inner<double_complex>(mem, la, 2, sphi, 0, this->number_of_hubbard_orbitals(), kp.hubbard_wave_functions(), 0,
-                                  this->number_of_hubbard_orbitals(), S, 0, 0);
+            inner<double_complex>(mem, la, 2, sphi, 0, num_wf__, s_phi__, 0,
+                                  num_wf__, S, 0, 0);
         } else {
             // we do not need to treat both up and down spins for the
             // colinear case because the up and down components are
             // identical
-            inner<double_complex>(mem, la, 0, sphi, 0, this->number_of_hubbard_orbitals(), kp.hubbard_wave_functions(), 0,
-                                  this->number_of_hubbard_orbitals(), S, 0, 0);
+            inner<double_complex>(mem, la, 0, sphi, 0, num_wf__, s_phi__, 0,
+                                  num_wf__, S, 0, 0);
 
             // for (int m = 0; m < this->number_of_hubbard_orbitals(); m++) {
             //   for (int n = 0; n < this->number_of_hubbard_orbitals(); n++) {
@@ -160,13 +174,13 @@ void Hubbard::orthogonalize_atomic_orbitals(K_point& kp, Wave_functions& sphi)
         // diagonalize the all stuff
 
         if (this->orthogonalize_hubbard_orbitals_) {
-            dmatrix<double_complex> Z(this->number_of_hubbard_orbitals(), this->number_of_hubbard_orbitals());
+            dmatrix<double_complex> Z(num_wf__, num_wf__);
 
             auto ev_solver = Eigensolver_factory(ev_solver_t::lapack);
 
-            std::vector<double> eigenvalues(this->number_of_hubbard_orbitals(), 0.0);
+            std::vector<double> eigenvalues(num_wf__, 0.0);
 
-            ev_solver->solve(number_of_hubbard_orbitals(), S, &eigenvalues[0], Z);
+            ev_solver->solve(num_wf__, S, &eigenvalues[0], Z);
 
             // build the O^{-1/2} operator
             for (int i = 0; i < static_cast<int>(eigenvalues.size()); i++) {
@@ -175,16 +189,16 @@ void Hubbard::orthogonalize_atomic_orbitals(K_point& kp, Wave_functions& sphi)
 
             // // First compute S_{nm} = E_m Z_{nm}
             S.zero();
-            for (int l = 0; l < this->number_of_hubbard_orbitals(); l++) {
-                for (int m = 0; m < this->number_of_hubbard_orbitals(); m++) {
-                    for (int n = 0; n < this->number_of_hubbard_orbitals(); n++) {
+            for (int l = 0; l < num_wf__; l++) {
+                for (int m = 0; m < num_wf__; m++) {
+                    for (int n = 0; n < num_wf__; n++) {
                         S(n, m) += eigenvalues[l] * Z(n, l) * std::conj(Z(m, l));
                     }
                 }
             }
         } else {
-            for (int l = 0; l < this->number_of_hubbard_orbitals(); l++) {
-                for (int m = 0; m < this->number_of_hubbard_orbitals(); m++) {
+            for (int l = 0; l < num_wf__; l++) {
+                for (int m = 0; m < num_wf__; m++) {
                     if (l == m) {
                         S(l, m) = 1.0 / sqrt(S(l, l).real());
                     } else {
@@ -201,14 +215,14 @@ void Hubbard::orthogonalize_atomic_orbitals(K_point& kp, Wave_functions& sphi)
         // only need to do that when in the ultra soft case
         if (augment) {
             for (int s = 0; (s < num_sc) && augment; s++) {
-                sphi.copy_from(ctx_.processing_unit(), this->number_of_hubbard_orbitals(), kp.hubbard_wave_functions(), s, 0, s, 0);
+                sphi.copy_from(ctx_.processing_unit(), num_wf__, s_phi__, s, 0, s, 0);
             }
         }
 
         // now apply the overlap matrix
         // Apply the transform on the wave functions
-        transform<double_complex>(mem, la, (ctx_.num_mag_dims() == 3) ? 2 : 0, sphi, 0, this->number_of_hubbard_orbitals(),
-                                  S, 0, 0, kp.hubbard_wave_functions(), 0, this->number_of_hubbard_orbitals());
+        transform<double_complex>(mem, la, (ctx_.num_mag_dims() == 3) ? 2 : 0, sphi, 0, num_wf__,
+                                  S, 0, 0, s_phi__, 0, num_wf__);
 
     }
 }
@@ -36,7 +36,10 @@ void Hubbard::compute_occupancies_derivatives(K_point&                    kp,
     dn__.zero();
     // check if we have a norm conserving pseudo potential only. OOnly
     // derivatives of the hubbard wave functions are needed.
-    auto& phi = kp.hubbard_wave_functions();
+    /* the raw atomic orbitals of the whole cell are needed; kp.hubbard_wave_functions() keeps S|phi> and
+       might hold only one chunk of atoms */
+    Wave_functions phi(kp.gkvec_partition(), this->number_of_hubbard_orbitals(), ctx_.preferred_memory_t(),
+                       (ctx_.num_mag_dims() == 3) ? 2 : 1);
 
     kp.generate_atomic_wave_functions_aux(this->number_of_hubbard_orbitals(),
                                           phi,
@@ -77,8 +80,6 @@ void Hubbard::compute_occupancies_derivatives(K_point&                    kp,
     */
     dmatrix<double_complex> dphi_s_psi(HowManyBands, this->number_of_hubbard_orbitals() * ctx_.num_spins());
     dmatrix<double_complex> phi_s_psi(HowManyBands, this->number_of_hubbard_orbitals() * ctx_.num_spins());
-    matrix<double_complex>  dm(this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                               this->number_of_hubbard_orbitals() * ctx_.num_spins());
     mdarray<double_complex, 5> dn_tmp(2 * lmax() + 1,
                                       2 * lmax() + 1,
                                       ctx_.num_spins(),
@@ -86,7 +87,6 @@ void Hubbard::compute_occupancies_derivatives(K_point&                    kp,
                                       3);
 
     if (ctx_.processing_unit() == device_t::GPU) {
-        dm.allocate(memory_t::device);
         dn_tmp.allocate(memory_t::device);
 
         /* allocation of the overlap matrices on GPU */
@@ -194,7 +194,6 @@ void Hubbard::compute_occupancies_derivatives(K_point&                    kp,
                                 dphi_s_psi,
                                 dphi,
                                 dn_tmp,
-                                dm, // temporary table
                                 dir);
         } // direction x, y, z
 
@@ -216,16 +215,15 @@ void Hubbard::compute_occupancies_stress_derivatives(K_point&
                                                      Q_operator<double_complex>& q_op__, // Compensnation operator or overlap operator
                                                      mdarray<double_complex, 5>& dn__)  // derivative of the occupation number compared to displacement of atom aton_id
 {
-    auto& phi = kp__.hubbard_wave_functions();
+    /* raw atomic orbitals of the whole cell */
+    Wave_functions phi(kp__.gkvec_partition(), this->number_of_hubbard_orbitals(), ctx_.preferred_memory_t(),
+                       (ctx_.num_mag_dims() == 3) ? 2 : 1);
 
     Wave_functions dphi(kp__.gkvec_partition(), this->number_of_hubbard_orbitals(), ctx_.preferred_memory_t(), 1);
     Wave_functions phitmp(kp__.gkvec_partition(), this->number_of_hubbard_orbitals(), ctx_.preferred_memory_t(), 1);
 
     Beta_projectors_strain_deriv bp_strain_deriv(ctx_, kp__.gkvec(), kp__.igk_loc());
 
-    dmatrix<double_complex> dm(this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                               this->number_of_hubbard_orbitals() * ctx_.num_spins());
-
     // maximum number of occupied bands
     int HowManyBands = kp__.num_occupied_bands(0);
     if (ctx_.num_spins() == 2) {
@@ -258,7 +256,6 @@ void Hubbard::compute_occupancies_stress_derivatives(K_point&
     kp__.generate_atomic_wave_functions_aux(this->number_of_hubbard_orbitals(), phi, this->offset, true);
 
     if (ctx_.processing_unit() == device_t::GPU) {
-        dm.allocate(memory_t::device);
         phi_s_psi.allocate(memory_t::device);
         dphi_s_psi.allocate(memory_t::device);
 
@@ -374,7 +371,6 @@ void Hubbard::compute_occupancies_stress_derivatives(K_point&
                                 dphi_s_psi,
                                 dphi,
                                 dn__,
-                                dm,
                                 3 * nu + mu);
         }
     }
@@ -396,6 +392,14 @@ void Hubbard::compute_gradient_strain_wavefunctions(K_point&                  kp
                                                     const mdarray<double, 3>& rlm_dg,
                                                     const int nu, const int mu)
 {
+    int nwf_max{1};
+    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+        nwf_max = std::max(nwf_max, ctx_.atomic_wf_ri().num_packed_values(iat));
+    }
+    /* per-thread buffers for the values of radial integrals and their derivatives */
+    mdarray<double, 3> ri_values_buf(nwf_max, unit_cell_.num_atom_types(), omp_get_max_threads());
+    mdarray<double, 3> ridjl_values_buf(nwf_max, unit_cell_.num_atom_types(), omp_get_max_threads());
+
     #pragma omp parallel for schedule(static)
     for (int igkloc = 0; igkloc < kp__.num_gkvec_loc(); igkloc++) {
         /* global index of G+k vector */
@@ -403,14 +407,13 @@ void Hubbard::compute_gradient_strain_wavefunctions(K_point&                  kp
         auto gvc = kp__.gkvec().gkvec_cart<index_domain_t::local>(igkloc);
         /* vs = {r, theta, phi} */
         auto gvs = SHT::spherical_coordinates(gvc);
-        std::vector<mdarray<double, 1>> ri_values(unit_cell_.num_atom_types());
-        for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
-            ri_values[iat] = ctx_.atomic_wf_ri().values(iat, gvs[0]);
-        }
-
-        std::vector<mdarray<double, 1>> ridjl_values(unit_cell_.num_atom_types());
+        mdarray<double, 2> ri_values(&ri_values_buf(0, 0, omp_get_thread_num()), nwf_max,
+                                     unit_cell_.num_atom_types());
+        mdarray<double, 2> ridjl_values(&ridjl_values_buf(0, 0, omp_get_thread_num()), nwf_max,
+                                        unit_cell_.num_atom_types());
         for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
-            ridjl_values[iat] = ctx_.atomic_wf_djl().values(iat, gvs[0]);
+            ctx_.atomic_wf_ri().packed_values(iat, gvs[0], &ri_values(0, iat));
+            ctx_.atomic_wf_djl().packed_values(iat, gvs[0], &ridjl_values(0, iat));
         }
 
         const double p = (mu == nu) ? 0.5 : 0.0;
@@ -428,7 +431,7 @@ void Hubbard::compute_gradient_strain_wavefunctions(K_point&                  kp
                     // case |g+k| = 0
                     if (gvs[0] < 1e-10) {
                         if (l == 0) {
-                            auto d1 = ri_values[atom_type.id()][i] * p * y00;
+                            auto d1 = ri_values(i, atom_type.id()) * p * y00;
 
                             dphi.pw_coeffs(0).prime(igkloc, offset__) = -z * d1 * phase_factor;
                         } else {
@@ -439,9 +442,9 @@ void Hubbard::compute_gradient_strain_wavefunctions(K_point&                  kp
                     } else {
                         for (int m = -l; m <= l; m++) {
                             int  lm = utils::lm(l, m);
-                            auto d1 = ri_values[atom_type.id()][i] * (gvc[mu] * rlm_dg(lm, nu, igkloc) +
+                            auto d1 = ri_values(i, atom_type.id()) * (gvc[mu] * rlm_dg(lm, nu, igkloc) +
                                                                       p * rlm_g(lm, igkloc));
-                            auto d2 = ridjl_values[atom_type.id()][i] * rlm_g(lm, igkloc) * gvc[mu] * gvc[nu] / gvs[0];
+                            auto d2 = ridjl_values(i, atom_type.id()) * rlm_g(lm, igkloc) * gvc[mu] * gvc[nu] / gvs[0];
 
                             dphi.pw_coeffs(0).prime(igkloc, offset__ + l + m) = -z * (d1 + d2) * std::conj(phase_factor);
                         }
@@ -458,12 +461,8 @@ void Hubbard::compute_occupancies(K_point&                    kp,
                                   dmatrix<double_complex>&    dphi_s_psi,
                                   Wave_functions&             dphi,
                                   mdarray<double_complex, 5>& dn__,
-                                  matrix<double_complex>&     dm,
                                   const int                   index)
 {
-    #if defined(__GPU)
-    const double_complex weight = double_complex(kp.weight(), 0.0);
-    #endif
     // it is actually <psi | d(S|phi>)
     dphi_s_psi.zero(memory_t::host);
     dphi_s_psi.zero(memory_t::device);
@@ -499,77 +498,30 @@ void Hubbard::compute_occupancies(K_point&                    kp,
             }
         }
     }
-    if (ctx_.processing_unit() == device_t::GPU) {
-        dphi_s_psi.copy_to(memory_t::device);
-    }
 
-    dm.zero(memory_t::host);
-    dm.zero(memory_t::device);
-
-    /* maybe dispatch this on the GPU */
-    switch (ctx_.processing_unit()) {
-        case device_t::CPU: {
-            dm.zero();
-            linalg<CPU>::gemm(2, 0,
-                              this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                              this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                              HowManyBands,
-                              double_complex(kp.weight(), 0.0),
-                              dynamic_cast<matrix<double_complex>&>(dphi_s_psi),
-                              dynamic_cast<matrix<double_complex>&>(phi_s_psi),
-                              linalg_const<double_complex>::zero(),
-                              dm);
-
-            linalg<CPU>::gemm(2, 0,
-                              this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                              this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                              HowManyBands,
-                              double_complex(kp.weight(), 0.0),
-                              dynamic_cast<matrix<double_complex>&>(phi_s_psi),
-                              dynamic_cast<matrix<double_complex>&>(dphi_s_psi),
-                              linalg_const<double_complex>::one(),
-                              dm);
-            break;
-        }
-        case device_t::GPU: {
-#if defined(__GPU)
-            dm.zero(memory_t::device);
-            linalg<GPU>::gemm(2, 0,
-                              this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                              this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                              HowManyBands,
-                              &weight,
-                              dynamic_cast<matrix<double_complex>&>(dphi_s_psi),
-                              dynamic_cast<matrix<double_complex>&>(phi_s_psi),
-                              &linalg_const<double_complex>::zero(),
-                              dm);
-
-            linalg<GPU>::gemm(2, 0,
-                              this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                              this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                              HowManyBands,
-                              &weight,
-                              dynamic_cast<matrix<double_complex>&>(phi_s_psi),
-                              dynamic_cast<matrix<double_complex>&>(dphi_s_psi),
-                              &linalg_const<double_complex>::one(),
-                              dm);
-
-            dm.copy_to(memory_t::host);
-#endif
-            break;
-        }
-    }
+    /* only the atom-diagonal blocks of the occupancy derivative are needed */
+    const double_complex weight(kp.weight(), 0.0);
 
     #pragma omp parallel for schedule(static)
     for (int ia1 = 0; ia1 < ctx_.unit_cell().num_atoms(); ++ia1) {
         const auto& atom = ctx_.unit_cell().atom(ia1);
         if (atom.type().hubbard_correction()) {
             const int lmax_at = 2 * atom.type().hubbard_orbital(0).l() + 1;
+            matrix<double_complex> dm(lmax_at, lmax_at);
             for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
                 const int ispn_offset = ispn * this->number_of_hubbard_orbitals() + this->offset[ia1];
+                /* dm = <d(S phi)|psi> f <psi|S phi> + <S phi|psi> f <psi|d(S phi)> */
+                linalg<CPU>::gemm(2, 0, lmax_at, lmax_at, HowManyBands, weight,
+                                  dphi_s_psi.at(memory_t::host, 0, ispn_offset), dphi_s_psi.ld(),
+                                  phi_s_psi.at(memory_t::host, 0, ispn_offset), phi_s_psi.ld(),
+                                  linalg_const<double_complex>::zero(), dm.at(memory_t::host), dm.ld());
+                linalg<CPU>::gemm(2, 0, lmax_at, lmax_at, HowManyBands, weight,
+                                  phi_s_psi.at(memory_t::host, 0, ispn_offset), phi_s_psi.ld(),
+                                  dphi_s_psi.at(memory_t::host, 0, ispn_offset), dphi_s_psi.ld(),
+                                  linalg_const<double_complex>::one(), dm.at(memory_t::host), dm.ld());
                 for (int m2 = 0; m2 < lmax_at; m2++) {
                     for (int m1 = 0; m1 < lmax_at; m1++) {
-                        dn__(m1, m2, ispn, ia1, index) = dm(ispn_offset + m1, ispn_offset + m2);
+                        dn__(m1, m2, ispn, ia1, index) = dm(m1, m2);
                     }
                 }
             }
@@ -64,9 +64,9 @@ void Hubbard::hubbard_compute_occupation_numbers(K_point_set& kset_)
         Ncf = 2;
     }
 
-    dmatrix<double_complex> dm(HowManyBands, this->number_of_hubbard_orbitals() * Ncf);
-    matrix<double_complex>  dm1(HowManyBands, this->number_of_hubbard_orbitals() * Ncf);
-    matrix<double_complex>  Op(this->number_of_hubbard_orbitals() * Ncf, this->number_of_hubbard_orbitals() * Ncf);
+    /* projections are computed for one chunk of atoms at a time */
+    dmatrix<double_complex> dm(HowManyBands, max_chunk_num_wf_ * Ncf);
+    matrix<double_complex>  dm1(HowManyBands, max_chunk_num_wf_ * Ncf);
 
     dm.zero();
 
@@ -92,7 +92,8 @@ void Hubbard::hubbard_compute_occupation_numbers(K_point_set& kset_)
                 kp->spinor_wave_functions().pw_coeffs(ispn).copy_to(memory_t::device, 0, kp->num_occupied_bands(ispn));
             }
 
-            for (int ispn = 0; ispn < kp->hubbard_wave_functions().num_sc(); ispn++) {
+            /* orbitals generated per chunk are placed on the device by hubbard_orbitals() */
+            for (int ispn = 0; !chunked_orbitals() && ispn < kp->hubbard_wave_functions().num_sc(); ispn++) {
 
                 if (!kp->hubbard_wave_functions().pw_coeffs(ispn).prime().on_device()) {
                     kp->hubbard_wave_functions().pw_coeffs(ispn).prime().allocate(memory_t::device);
@@ -101,111 +102,129 @@ void Hubbard::hubbard_compute_occupation_numbers(K_point_set& kset_)
                 kp->hubbard_wave_functions().pw_coeffs(ispn).copy_to(memory_t::device, 0, this->number_of_hubbard_orbitals());
             }
         }
-        dm.zero();
-        if (ctx_.num_mag_dims() == 3) {
-            inner(mem, la, 2, kp->spinor_wave_functions(), 0, kp->num_occupied_bands(), kp->hubbard_wave_functions(), 0,
-                  this->number_of_hubbard_orbitals(), dm, 0, 0);
-        } else {
-            // SLDA + U, we need to do the explicit calculation. The
-            // hubbard orbitals only have one component while the bloch
-            // wave functions have two. The inner product takes care of
-            // this case internally.
-            for (int ispn_ = 0; ispn_ < ctx_.num_spins(); ispn_++) {
-                inner(mem, la, ispn_, kp->spinor_wave_functions(), 0, kp->num_occupied_bands(ispn_),
-                      kp->hubbard_wave_functions(), 0, this->number_of_hubbard_orbitals(), dm, 0,
-                      ispn_ * this->number_of_hubbard_orbitals());
-            }
+
+        /* beta-projectors are needed to generate S|phi> of a chunk */
+        bool prepare_beta{false};
+        for (int iat = 0; (iat < ctx_.unit_cell().num_atom_types()) && chunked_orbitals(); iat++) {
+            prepare_beta |= ctx_.unit_cell().atom_type(iat).augment();
+        }
+        if (prepare_beta) {
+            kp->beta_projectors().prepare();
         }
 
-        if (ctx_.processing_unit() == GPU) {
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                /* deallocate GPU memory */
-                kp->spinor_wave_functions().pw_coeffs(ispn).deallocate(memory_t::device);
-            }
+        for (int ichunk = 0; ichunk < static_cast<int>(hubbard_chunks_.size()); ichunk++) {
+            auto& chunk   = hubbard_chunks_[ichunk];
+            const int nwf = chunk.num_wf_;
 
-            for (int ispn = 0; ispn < kp->hubbard_wave_functions().num_sc(); ispn++) {
-                kp->hubbard_wave_functions().pw_coeffs(ispn).deallocate(memory_t::device);
+            auto hub     = hubbard_orbitals(*kp, ichunk);
+            auto& hub_wf = *hub.first;
+
+            dm.zero();
+            if (ctx_.num_mag_dims() == 3) {
+                inner(mem, la, 2, kp->spinor_wave_functions(), 0, kp->num_occupied_bands(0), hub_wf,
+                      hub.second, nwf, dm, 0, 0);
+            } else {
+                // SLDA + U, we need to do the explicit calculation. The
+                // hubbard orbitals only have one component while the bloch
+                // wave functions have two. The inner product takes care of
+                // this case internally.
+                for (int ispn_ = 0; ispn_ < ctx_.num_spins(); ispn_++) {
+                    inner(mem, la, ispn_, kp->spinor_wave_functions(), 0, kp->num_occupied_bands(ispn_),
+                          hub_wf, hub.second, nwf, dm, 0, ispn_ * nwf);
+                }
             }
 
-            dm.copy_to(memory_t::host);
-        }
+            if (ctx_.processing_unit() == GPU) {
+                dm.copy_to(memory_t::host);
+            }
 
-        // compute O'_{nk,j} = O_{nk,j} * f_{nk}
-        // NO summation over band yet
+            // compute O'_{nk,j} = O_{nk,j} * f_{nk}
+            // NO summation over band yet
 
-        dm1.zero(); // O'
+            dm1.zero(); // O'
 
-        if (ctx_.num_mag_dims() == 3) {
-            #pragma omp parallel for
-            for (int m = 0; m < this->number_of_hubbard_orbitals(); m++) {
-                for (int nband = 0; nband < kp->num_occupied_bands(0); nband++) {
-                    dm1(nband, m) = dm(nband, m) * kp->band_occupancy(nband, 0);
+            if (ctx_.num_mag_dims() == 3) {
+                #pragma omp parallel for
+                for (int m = 0; m < nwf; m++) {
+                    for (int nband = 0; nband < kp->num_occupied_bands(0); nband++) {
+                        dm1(nband, m) = dm(nband, m) * kp->band_occupancy(nband, 0);
+                    }
                 }
-            }
-        } else {
-            #pragma omp parallel for
-            for (int m = 0; m < this->number_of_hubbard_orbitals(); m++) {
-                for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                    for (int nband = 0; nband < kp->num_occupied_bands(ispn); nband++) {
-                        dm1(nband, ispn * this->number_of_hubbard_orbitals() + m) =
-                            dm(nband, ispn * this->number_of_hubbard_orbitals() + m) * kp->band_occupancy(nband, ispn);
+            } else {
+                #pragma omp parallel for
+                for (int m = 0; m < nwf; m++) {
+                    for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                        for (int nband = 0; nband < kp->num_occupied_bands(ispn); nband++) {
+                            dm1(nband, ispn * nwf + m) = dm(nband, ispn * nwf + m) * kp->band_occupancy(nband, ispn);
+                        }
                     }
                 }
             }
-        }
 
-        // now compute O_{ij}^{sigma,sigma'} = \sum_{nk} <psi_nk|phi_{i,sigma}><phi_{j,sigma^'}|psi_nk> f_{nk}
-        const double scal = (ctx_.num_mag_dims() == 0) ? 0.5 : 1.0;
-        linalg<CPU>::gemm(2, 0, this->number_of_hubbard_orbitals() * Ncf, this->number_of_hubbard_orbitals() * Ncf, HowManyBands,
-                          double_complex(kp->weight() * scal, 0.0), dynamic_cast<matrix<double_complex>&>(dm), dm1,
-                          linalg_const<double_complex>::zero(), Op);
+            // now compute O_{ij}^{sigma,sigma'} = \sum_{nk} <psi_nk|phi_{i,sigma}><phi_{j,sigma^'}|psi_nk> f_{nk}
+            // only for the atom-diagonal blocks
+            const double scal = (ctx_.num_mag_dims() == 0) ? 0.5 : 1.0;
+            const double_complex alpha(kp->weight() * scal, 0.0);
 
-        if (ctx_.num_mag_dims() == 3) {
-            // there must be a way to do that with matrix multiplication
             #pragma omp parallel for schedule(static)
-            for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
-                const auto& atom = unit_cell_.atom(ia);
-                if (atom.type().hubbard_correction()) {
-                    const int lmax_at = 2 * atom.type().hubbard_orbital(0).l() + 1;
+            for (int i = 0; i < static_cast<int>(chunk.atoms_.size()); i++) {
+                const int ia      = chunk.atoms_[i];
+                const auto& atom  = unit_cell_.atom(ia);
+                const int lmax_at = 2 * atom.type().hubbard_orbital(0).l() + 1;
+                const int i0      = this->offset[ia] - chunk.offset_;
+
+                if (ctx_.num_mag_dims() == 3) {
+                    matrix<double_complex> Op(2 * lmax_at, 2 * lmax_at);
+                    linalg<CPU>::gemm(2, 0, 2 * lmax_at, 2 * lmax_at, HowManyBands, alpha,
+                                      dm.at(memory_t::host, 0, i0), dm.ld(), dm1.at(memory_t::host, 0, i0), dm1.ld(),
+                                      linalg_const<double_complex>::zero(), Op.at(memory_t::host), Op.ld());
                     for (int s1 = 0; s1 < ctx_.num_spins(); s1++) {
                         for (int s2 = 0; s2 < ctx_.num_spins(); s2++) {
                             int s = (s1 == s2) * s1 + (s1 != s2) * (1 + 2 * s2 + s1);
                             for (int mp = 0; mp < lmax_at; mp++) {
                                 for (int m = 0; m < lmax_at; m++) {
-                                    this->occupancy_number_(m, mp, s, ia, 0) +=
-                                        Op(this->offset[ia] + m + s1 * lmax_at, this->offset[ia] + mp + s2 * lmax_at);
+                                    this->occupancy_number_(m, mp, s, ia, 0) += Op(m + s1 * lmax_at, mp + s2 * lmax_at);
                                 }
                             }
                         }
                     }
-                }
-            }
-        } else {
-            // Well we need to apply a factor 1/2 (the constant scal
-            // above) when we compute the occupancies for the boring LDA
-            // + U. It is because the calculations of E and U consider
-            // occupancies <= 1.  Sirius for the boring lda+U has a
-            // factor 2 in the kp band occupancies. We need to
-            // compensate for it because it is taken into account in the
-            // calculation of the hubbard potential
-
-            #pragma omp parallel for schedule(static)
-            for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
-                const auto& atom = unit_cell_.atom(ia);
-                if (atom.type().hubbard_correction()) {
-                    const int lmax_at = 2 * atom.type().hubbard_orbital(0).l() + 1;
+                } else {
+                    // Well we need to apply a factor 1/2 (the constant scal
+                    // above) when we compute the occupancies for the boring LDA
+                    // + U. It is because the calculations of E and U consider
+                    // occupancies <= 1.  Sirius for the boring lda+U has a
+                    // factor 2 in the kp band occupancies. We need to
+                    // compensate for it because it is taken into account in the
+                    // calculation of the hubbard potential
+                    matrix<double_complex> Op(lmax_at, lmax_at);
                     for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                        const int j0 = i0 + ispn * nwf;
+                        linalg<CPU>::gemm(2, 0, lmax_at, lmax_at, HowManyBands, alpha,
+                                          dm.at(memory_t::host, 0, j0), dm.ld(), dm1.at(memory_t::host, 0, j0), dm1.ld(),
+                                          linalg_const<double_complex>::zero(), Op.at(memory_t::host), Op.ld());
                         for (int mp = 0; mp < lmax_at; mp++) {
-                            const int mmp = this->offset[ia] + mp + ispn * this->number_of_hubbard_orbitals();
                             for (int m = 0; m < lmax_at; m++) {
-                                const int mm = this->offset[ia] + m + ispn * this->number_of_hubbard_orbitals();
-                                this->occupancy_number_(m, mp, ispn, ia, 0) += Op(mm, mmp);
+                                this->occupancy_number_(m, mp, ispn, ia, 0) += Op(m, mp);
                             }
                         }
                     }
                 }
             }
         }
+
+        if (prepare_beta) {
+            kp->beta_projectors().dismiss();
+        }
+
+        if (ctx_.processing_unit() == GPU) {
+            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                /* deallocate GPU memory */
+                kp->spinor_wave_functions().pw_coeffs(ispn).deallocate(memory_t::device);
+            }
+
+            deallocate_hubbard_orbitals_on_device(*kp);
+        }
+        release_hubbard_orbitals(*kp);
     }
 
     /* global reduction over k points */
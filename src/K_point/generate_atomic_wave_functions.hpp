@@ -46,6 +46,13 @@ inline void K_point::generate_atomic_wave_functions_aux(const int         num_ao
         phi.pw_coeffs(ispn).prime().zero();
     }
 
+    int nwf_max{1};
+    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+        nwf_max = std::max(nwf_max, ctx_.atomic_wf_ri().num_packed_values(iat));
+    }
+    /* per-thread buffers for the values of radial integrals */
+    mdarray<double, 3> ri_values_buf(nwf_max, unit_cell_.num_atom_types(), omp_get_max_threads());
+
     #pragma omp parallel for schedule(static)
     for (int igk_loc = 0; igk_loc < this->num_gkvec_loc(); igk_loc++) {
         /* global index of G+k vector */
@@ -56,9 +63,9 @@ inline void K_point::generate_atomic_wave_functions_aux(const int         num_ao
         std::vector<double> rlm(utils::lmmax(lmax));
         SHT::spherical_harmonics(lmax, vs[1], vs[2], &rlm[0]);
         /* get values of radial integrals for a given G+k vector length */
-        std::vector<mdarray<double, 1>> ri_values(unit_cell_.num_atom_types());
+        mdarray<double, 2> ri_values(&ri_values_buf(0, 0, omp_get_thread_num()), nwf_max, unit_cell_.num_atom_types());
         for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
-            ri_values[iat] = ctx_.atomic_wf_ri().values(iat, vs[0]);
+            ctx_.atomic_wf_ri().packed_values(iat, vs[0], &ri_values(0, iat));
         }
 
         int n{0};
@@ -72,12 +79,13 @@ inline void K_point::generate_atomic_wave_functions_aux(const int         num_ao
                     auto z = std::pow(double_complex(0, -1), l) * fourpi / std::sqrt(unit_cell_.omega());
                     for (int m = -l; m <= l; m++) {
                         int lm = utils::lm(l, m);
-                        phi.pw_coeffs(0).prime(igk_loc, n) = z * std::conj(phase_factor) * rlm[lm] * ri_values[atom_type.id()][i];
+                        phi.pw_coeffs(0).prime(igk_loc, n) = z * std::conj(phase_factor) * rlm[lm] * ri_values(i, atom_type.id());
                         n++;
                     }
                 } // i
             } else {
-                if (atom_type.hubbard_correction()) {
+                /* atoms with negative offset are skipped (no Hubbard correction or not in the current chunk) */
+                if (atom_type.hubbard_correction() && offset[ia] >= 0) {
                     if (atom_type.spin_orbit_coupling()) {
                         // one channel only now
                         for (int i = 0; i < 2; i++) {
@@ -86,8 +94,8 @@ inline void K_point::generate_atomic_wave_functions_aux(const int         num_ao
                             auto z = std::pow(double_complex(0, -1), l) * fourpi / std::sqrt(unit_cell_.omega());
                             for (int m = -l; m <= l; m++) {
                                 int lm = utils::lm(l, m);
-                                phi.pw_coeffs(0).prime(igk_loc, offset[ia] + l + m) += 0.5 * z * std::conj(phase_factor) * rlm[lm] * ri_values[atom_type.id()][orb.rindex()];
-                                phi.pw_coeffs(1).prime(igk_loc, offset[ia] + 3 * l + m + 1) += 0.5 * z * std::conj(phase_factor) * rlm[lm] * ri_values[atom_type.id()][orb.rindex()];
+                                phi.pw_coeffs(0).prime(igk_loc, offset[ia] + l + m) += 0.5 * z * std::conj(phase_factor) * rlm[lm] * ri_values(orb.rindex(), atom_type.id());
+                                phi.pw_coeffs(1).prime(igk_loc, offset[ia] + 3 * l + m + 1) += 0.5 * z * std::conj(phase_factor) * rlm[lm] * ri_values(orb.rindex(), atom_type.id());
                             }
                         }
                     } else {
@@ -98,9 +106,9 @@ inline void K_point::generate_atomic_wave_functions_aux(const int         num_ao
                             auto z = std::pow(double_complex(0, -1), l) * fourpi / std::sqrt(unit_cell_.omega());
                             for (int m = -l; m <= l; m++) {
                                 int lm = utils::lm(l, m);
-                                phi.pw_coeffs(0).prime(igk_loc, offset[ia] + offset__  + l + m) = z * std::conj(phase_factor) * rlm[lm] * ri_values[atom_type.id()][orb.rindex()];
+                                phi.pw_coeffs(0).prime(igk_loc, offset[ia] + offset__  + l + m) = z * std::conj(phase_factor) * rlm[lm] * ri_values(orb.rindex(), atom_type.id());
                                 if (ctx_.num_mag_dims() == 3) {
-                                    phi.pw_coeffs(1).prime(igk_loc, offset[ia] + offset__  + 3 * l + m + 1) = z * std::conj(phase_factor) * rlm[lm] * ri_values[atom_type.id()][orb.rindex()];
+                                    phi.pw_coeffs(1).prime(igk_loc, offset[ia] + offset__  + 3 * l + m + 1) = z * std::conj(phase_factor) * rlm[lm] * ri_values(orb.rindex(), atom_type.id());
                                 }
                             }
                             offset__ += (ctx_.num_mag_dims() == 3) ? (2 * (2 * l + 1)) : (2 * l + 1);
@@ -86,12 +86,25 @@ class K_point
         /// Two-component (spinor) hubbard wave functions where the S matrix is applied (if ppus).
         std::unique_ptr<Wave_functions> hubbard_wave_functions_{nullptr};
 
+        /// Hubbard wave functions (with S applied) of each chunk of atoms, if they are generated per chunk.
+        std::vector<std::unique_ptr<Wave_functions>> hubbard_wave_functions_chunks_;
+
         /// Band occupation numbers.
         mdarray<double, 2> band_occupancies_;
 
+        /// Number of bands with non-negligible occupancy for each spin channel (-1 if not yet computed).
+        /** Computed on the first request after the occupancies have changed. */
+        mutable std::array<int, 2> num_occupied_bands_{{-1, -1}};
+
         /// Band energies.
         mdarray<double, 2> band_energies_;
 
+        /// Wall-clock time of the last solution of the eigen-value problem for this k-point.
+        double solve_time_{0};
+
+        /// Number of iterations of the iterative solver in the last solution of the eigen-value problem.
+        int num_diag_iter_{0};
+
         /// LAPW matching coefficients for the row G+k vectors.
         /** Used to setup the distributed LAPW Hamiltonian and overlap matrices. */
         std::unique_ptr<Matching_coefficients> alm_coeffs_row_{nullptr};
@@ -258,8 +271,13 @@ class K_point
         {
             PROFILE("sirius::K_point::update");
 
+            /* projectors of atom types are kept if only the atomic positions were changed */
+            bool lattice_changed = gkvec_->lattice_vectors_changed(ctx_.unit_cell().reciprocal_lattice_vectors());
             gkvec_->lattice_vectors(ctx_.unit_cell().reciprocal_lattice_vectors());
 
+            /* Hubbard orbitals of the chunks of atoms depend on the atomic positions and are regenerated on demand */
+            hubbard_wave_functions_chunks_.clear();
+
             if (ctx_.full_potential()) {
                 if (ctx_.iterative_solver_input().type_ == "exact") {
                     alm_coeffs_row_ = std::unique_ptr<Matching_coefficients>(
@@ -271,7 +289,13 @@ class K_point
                     new Matching_coefficients(unit_cell_, ctx_.lmax_apw(), num_gkvec_loc(), igk_loc_, gkvec()));
             }
 
-            if (!ctx_.full_potential()) {
+            if (!ctx_.full_potential() && !lattice_changed && beta_projectors_) {
+                beta_projectors_->update_positions();
+                if (beta_projectors_row_) {
+                    beta_projectors_row_->update_positions();
+                    beta_projectors_col_->update_positions();
+                }
+            } else if (!ctx_.full_potential()) {
                 /* compute |beta> projectors for atom types */
                 beta_projectors_ = std::unique_ptr<Beta_projectors>(new Beta_projectors(ctx_, gkvec(), igk_loc_));
 
@@ -361,6 +385,9 @@ class K_point
         /// Generate two-component spinor wave functions
         inline void generate_spinor_wave_functions();
 
+        /// Initialize wave-functions and band energies from the solution at a neighbouring k-point.
+        inline void initialize_from(K_point const& kp__);
+
         inline void generate_atomic_wave_functions(const int num_ao__, Wave_functions &phi);
 
         inline void generate_atomic_wave_functions_aux(const int num_ao__, Wave_functions &phi, std::vector<int> &offset, bool hubbard);
@@ -449,14 +476,26 @@ class K_point
         }
 
         /// Get the number of occupied bands for each spin channel.
-        inline int num_occupied_bands(int ispn__ = -1) const
+        /** Bands above the last band with the weighted occupancy larger than settings.min_occupancy don't contribute
+         *  to the density, forces and stress and are skipped by these calculations. In the non-collinear case
+         *  there is a single channel and the spin index is ignored. */
+        inline int num_occupied_bands(int ispn__) const
         {
-            for (int j = ctx_.num_bands() - 1; j >= 0; j--) {
-                if (std::abs(band_occupancy(j, ispn__) * weight()) > 1e-14) {
-                    return j + 1;
+            if (ctx_.num_mag_dims() == 3) {
+                ispn__ = 0;
+            }
+            assert(ispn__ >= 0 && ispn__ < ctx_.num_spin_dims());
+            if (num_occupied_bands_[ispn__] < 0) {
+                double tol = ctx_.settings().min_occupancy_;
+                num_occupied_bands_[ispn__] = 0;
+                for (int j = ctx_.num_bands() - 1; j >= 0; j--) {
+                    if (std::abs(band_occupancy(j, ispn__) * weight()) > tol) {
+                        num_occupied_bands_[ispn__] = j + 1;
+                        break;
+                    }
                 }
             }
-            return 0;
+            return num_occupied_bands_[ispn__];
         }
 
         /// Total number of G+k vectors within the cutoff distance
@@ -499,6 +538,31 @@ class K_point
                 ispn__ = 0;
             }
             band_occupancies_(j__, ispn__) = occ__;
+            num_occupied_bands_[ispn__] = -1;
+        }
+
+        /// Get the time of the last solution of the eigen-value problem.
+        inline double solve_time() const
+        {
+            return solve_time_;
+        }
+
+        /// Set the time of the last solution of the eigen-value problem.
+        inline void solve_time(double t__)
+        {
+            solve_time_ = t__;
+        }
+
+        /// Get the number of iterations of the iterative solver in the last solution of the eigen-value problem.
+        inline int num_diag_iter() const
+        {
+            return num_diag_iter_;
+        }
+
+        /// Set the number of iterations of the iterative solver.
+        inline void num_diag_iter(int n__)
+        {
+            num_diag_iter_ = n__;
         }
 
         inline double fv_eigen_value(int i) const
@@ -558,6 +622,12 @@ class K_point
             return (hubbard_wave_functions_ != nullptr);
         }
 
+        /// Hubbard wave functions of the chunks of atoms; empty entries are not generated yet.
+        inline std::vector<std::unique_ptr<Wave_functions>>& hubbard_wave_functions_chunks()
+        {
+            return hubbard_wave_functions_chunks_;
+        }
+
         inline Wave_functions& singular_components()
         {
             return *singular_components_;
@@ -1236,6 +1306,46 @@ inline void K_point::save(std::string const& name__, int id__) const
     }
 }
 
+/** Plane-wave coefficients of the periodic part of Bloch functions change smoothly with k, so they are matched
+ *  by the Miller indices of G-vectors. Coefficients of the G-vectors that are missing at the neighbouring k-point
+ *  are set to zero. Both k-points must be stored by the same group of MPI ranks. The resulting wave-functions are
+ *  not orthonormal; they are used as a starting guess for the iterative solver. */
+inline void K_point::initialize_from(K_point const& kp__)
+{
+    PROFILE("sirius::K_point::initialize_from");
+
+    auto& src_gkvec = kp__.gkvec();
+
+    /* global index of the neighbour's G+k vector for each local G+k vector of this k-point */
+    std::vector<int> idx(gkvec().count());
+    for (int igloc = 0; igloc < gkvec().count(); igloc++) {
+        auto G = gkvec().gvec(gkvec().offset() + igloc);
+        idx[igloc] = src_gkvec.index_by_gvec(G);
+    }
+
+    std::vector<double_complex> wf_tmp(src_gkvec.num_gvec());
+    for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+        for (int i = 0; i < ctx_.num_bands(); i++) {
+            /* gather full column of PW coefficients of the neighbour */
+            comm().allgather(&kp__.spinor_wave_functions_->pw_coeffs(ispn).prime(0, i), wf_tmp.data(),
+                             src_gkvec.offset(), src_gkvec.count());
+            #pragma omp parallel for schedule(static)
+            for (int igloc = 0; igloc < gkvec().count(); igloc++) {
+                spinor_wave_functions_->pw_coeffs(ispn).prime(igloc, i) =
+                    (idx[igloc] >= 0) ? wf_tmp[idx[igloc]] : double_complex(0, 0);
+            }
+        }
+    }
+
+    for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+        for (int j = 0; j < ctx_.num_bands(); j++) {
+            band_energies_(j, ispn)    = kp__.band_energies_(j, ispn);
+            band_occupancies_(j, ispn) = kp__.band_occupancies_(j, ispn);
+        }
+    }
+    num_occupied_bands_ = {{-1, -1}};
+}
+
 inline void K_point::load(HDF5_tree h5in, int id)
 {
     STOP();
@@ -196,14 +196,88 @@ class K_point_set
     {
     }
 
+    /// Split a list of k-points into contiguous chunks with the balanced total cost.
+    /** The maximum cost per rank is found by bisection; each rank gets at least one k-point if there are enough
+     *  of them. */
+    static std::vector<int> balanced_counts(std::vector<double> const& cost__, int num_ranks__)
+    {
+        int nk = static_cast<int>(cost__.size());
+
+        /* greedy partition for a given maximum load; returns empty vector if the k-points don't fit */
+        auto partition = [&](double max_load) -> std::vector<int>
+        {
+            std::vector<int> counts(num_ranks__, 0);
+            int r{0};
+            double load{0};
+            for (int ik = 0; ik < nk; ik++) {
+                /* move to the next rank if the load is exceeded or if the remaining ranks would stay empty */
+                if (counts[r] > 0 && (load + cost__[ik] > max_load || nk - ik <= num_ranks__ - 1 - r)) {
+                    if (++r == num_ranks__) {
+                        return std::vector<int>();
+                    }
+                    load = 0;
+                }
+                counts[r]++;
+                load += cost__[ik];
+            }
+            return counts;
+        };
+
+        double lo{0}, hi{0};
+        for (auto c : cost__) {
+            lo = std::max(lo, c);
+            hi += c;
+        }
+        for (int i = 0; i < 60 && hi - lo > 1e-12 * hi; i++) {
+            double m = 0.5 * (lo + hi);
+            if (partition(m).empty()) {
+                lo = m;
+            } else {
+                hi = m;
+            }
+        }
+        return partition(hi);
+    }
+
+    /// Estimate the relative cost of the band solution for each k-point.
+    /** The cost is taken proportional to the number of G+k vectors, which are counted using the coarse G-vectors. */
+    std::vector<double> estimate_cost() const
+    {
+        PROFILE("sirius::K_point_set::estimate_cost");
+
+        auto& gv   = ctx_.gvec_coarse();
+        double gk2 = std::pow(ctx_.gk_cutoff(), 2);
+
+        std::vector<double> cost(num_kpoints(), 0);
+        #pragma omp parallel for
+        for (int ik = 0; ik < num_kpoints(); ik++) {
+            auto vkc = unit_cell_.reciprocal_lattice_vectors() * kpoints_[ik]->vk();
+            int n{0};
+            for (int igloc = 0; igloc < gv.count(); igloc++) {
+                if ((gv.gvec_cart<index_domain_t::local>(igloc) + vkc).length2() <= gk2) {
+                    n++;
+                }
+            }
+            cost[ik] = n;
+        }
+        ctx_.comm().allreduce(cost.data(), num_kpoints());
+
+        return cost;
+    }
+
     /// Initialize the k-point set
     void initialize(std::vector<int> const& counts = {})
     {
         PROFILE("sirius::K_point_set::initialize");
         /* distribute k-points along the 1-st dimension of the MPI grid */
         if (counts.empty()) {
-            splindex<block> spl_tmp(num_kpoints(), comm().size(), comm().rank());
-            spl_num_kpoints_ = splindex<chunk>(num_kpoints(), comm().size(), comm().rank(), spl_tmp.counts());
+            if (ctx_.control().kpoint_distribution_ == "block") {
+                splindex<block> spl_tmp(num_kpoints(), comm().size(), comm().rank());
+                spl_num_kpoints_ = splindex<chunk>(num_kpoints(), comm().size(), comm().rank(), spl_tmp.counts());
+            } else {
+                spl_num_kpoints_ = splindex<chunk>(num_kpoints(), comm().size(), comm().rank(),
+                                                   balanced_counts(estimate_cost(), comm().size()));
+            }
         } else {
             spl_num_kpoints_ = splindex<chunk>(num_kpoints(), comm().size(), comm().rank(), counts);
         }
@@ -221,6 +295,87 @@ class K_point_set
         }
     }
 
+    /// Redistribute k-points between MPI ranks using the measured time of the band solution.
+    /** The k-points are moved only if the maximum load per rank decreases by more than 10%. The new owner of
+     *  a k-point initializes it and receives the wave-functions from the old owner; the old owner releases
+     *  the k-point data. Only the pseudopotential case is supported.
+     *
+     *  \return True if the distribution of k-points has changed. */
+    inline bool rebalance()
+    {
+        PROFILE("sirius::K_point_set::rebalance");
+
+        if (ctx_.full_potential() || comm().size() == 1) {
+            return false;
+        }
+
+        std::vector<double> cost(num_kpoints(), 0);
+        for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+            int ik   = spl_num_kpoints_[ikloc];
+            cost[ik] = kpoints_[ik]->solve_time();
+        }
+        comm().allreduce(cost.data(), num_kpoints());
+        /* all ranks of a k-point group must take the same decision */
+        ctx_.comm_band().bcast(cost.data(), num_kpoints(), 0);
+
+        auto counts = balanced_counts(cost, comm().size());
+        splindex<chunk> spl_new(num_kpoints(), comm().size(), comm().rank(), counts);
+
+        std::vector<double> load_old(comm().size(), 0), load_new(comm().size(), 0);
+        for (int ik = 0; ik < num_kpoints(); ik++) {
+            load_old[spl_num_kpoints_.local_rank(ik)] += cost[ik];
+            load_new[spl_new.local_rank(ik)] += cost[ik];
+        }
+        double max_old = *std::max_element(load_old.begin(), load_old.end());
+        double max_new = *std::max_element(load_new.begin(), load_new.end());
+
+        if (max_new > 0.9 * max_old) {
+            return false;
+        }
+
+        if (ctx_.comm().rank() == 0 && ctx_.control().verbosity_ >= 1) {
+            printf("rebalancing k-points: maximum load per rank %f -> %f sec.\n", max_old, max_new);
+        }
+
+        for (int ik = 0; ik < num_kpoints(); ik++) {
+            int r_old = spl_num_kpoints_.local_rank(ik);
+            int r_new = spl_new.local_rank(ik);
+            if (r_old == r_new) {
+                continue;
+            }
+            if (comm().rank() == r_new) {
+                kpoints_[ik]->initialize();
+            }
+            if (comm().rank() == r_old || comm().rank() == r_new) {
+                /* ranks of the k-point groups with the same position have the same distribution of G+k vectors */
+                auto& wf = kpoints_[ik]->spinor_wave_functions();
+                for (int ispn = 0; ispn < wf.num_sc(); ispn++) {
+                    auto& pw = wf.pw_coeffs(ispn).prime();
+                    if (comm().rank() == r_old) {
+                        comm().send(pw.at(memory_t::host), static_cast<int>(pw.size()), r_new, ik);
+                    } else {
+                        comm().recv(pw.at(memory_t::host), static_cast<int>(pw.size()), r_old, ik);
+                    }
+                }
+            }
+            if (comm().rank() == r_old) {
+                /* replace the k-point by the uninitialized copy to release the memory */
+                auto vk = kpoints_[ik]->vk();
+                std::unique_ptr<K_point> kp(new K_point(ctx_, &vk[0], kpoints_[ik]->weight()));
+                for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+                    for (int j = 0; j < ctx_.num_bands(); j++) {
+                        kp->band_energy(j, ispn, kpoints_[ik]->band_energy(j, ispn));
+                        kp->band_occupancy(j, ispn, kpoints_[ik]->band_occupancy(j, ispn));
+                    }
+                }
+                kpoints_[ik] = std::move(kp);
+            }
+        }
+        spl_num_kpoints_ = spl_new;
+
+        return true;
+    }
+
     /// Update k-points after moving atoms or changing the lattice vectors.
     void update()
     {
@@ -42,7 +42,7 @@ inline void Potential::generate_pw_coefs()
             if (ctx_.fft().pu() == device_t::GPU) {
                 ctx_.fft().buffer().copy_to(memory_t::device);
             }
-            ctx_.fft().transform<-1>(&fpw_fft[0]);
+            ctx_.fft().transform_real<-1>(&fpw_fft[0]);
             ctx_.gvec_partition().gather_pw_global(&fpw_fft[0], &rm2_inv_pw_[0]);
         }
         case relativity_t::zora: {
@@ -53,7 +53,7 @@ inline void Potential::generate_pw_coefs()
             if (ctx_.fft().pu() == device_t::GPU) {
                 ctx_.fft().buffer().copy_to(memory_t::device);
             }
-            ctx_.fft().transform<-1>(&fpw_fft[0]);
+            ctx_.fft().transform_real<-1>(&fpw_fft[0]);
             ctx_.gvec_partition().gather_pw_global(&fpw_fft[0], &rm_inv_pw_[0]);
         }
         default: {
@@ -63,7 +63,7 @@ inline void Potential::generate_pw_coefs()
             if (ctx_.fft().pu() == device_t::GPU) {
                 ctx_.fft().buffer().copy_to(memory_t::device);
             }
-            ctx_.fft().transform<-1>(&fpw_fft[0]);
+            ctx_.fft().transform_real<-1>(&fpw_fft[0]);
             ctx_.gvec_partition().gather_pw_global(&fpw_fft[0], &veff_pw_[0]);
         }
     }
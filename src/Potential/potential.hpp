@@ -892,8 +892,12 @@ class Potential : public Field4D
         if (ngv != ctx_.gvec().num_gvec()) {
             TERMINATE("wrong number of G-vectors");
         }
-        mdarray<int, 2> gv(3, ngv);
-        fin.read("/parameters/gvec", gv);
+        /* the list of G-vectors is only needed for files without the per-rank slabs */
+        mdarray<int, 2> gv;
+        if (!fin["effective_potential"].exist("num_slabs")) {
+            gv = mdarray<int, 2>(3, ngv);
+            fin.read("/parameters/gvec", gv);
+        }
 
         effective_potential().hdf5_read(fin["effective_potential"], gv);
 
@@ -913,6 +917,24 @@ class Potential : public Field4D
         }
     }
 
+    /// Load effective potential and magnetic field from the set of per-rank checkpoint files.
+    inline void load_checkpoint(std::string const& prefix__)
+    {
+        effective_potential().hdf5_read_checkpoint(prefix__, "effective_potential");
+        for (int j = 0; j < ctx_.num_mag_dims(); j++) {
+            effective_magnetic_field(j).hdf5_read_checkpoint(prefix__, "effective_magnetic_field/" + std::to_string(j));
+        }
+
+        if (ctx_.full_potential()) {
+            update_atomic_potential();
+        } else {
+            HDF5_tree fin(checkpoint_file_name(prefix__, 0), hdf5_access_t::read_only);
+            for (int j = 0; j < ctx_.unit_cell().num_atoms(); j++) {
+                fin["unit_cell"]["atoms"][j].read("D_operator", ctx_.unit_cell().atom(j).d_mtrx());
+            }
+        }
+    }
+
     inline void update_atomic_potential()
     {
         for (int ic = 0; ic < unit_cell_.num_atom_symmetry_classes(); ic++) {
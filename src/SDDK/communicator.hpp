@@ -95,6 +95,24 @@ struct mpi_type_wrapper<double>
     }
 };
 
+template <>
+struct mpi_type_wrapper<float>
+{
+    static MPI_Datatype kind()
+    {
+        return MPI_FLOAT;
+    }
+};
+
+template <>
+struct mpi_type_wrapper<std::complex<float>>
+{
+    static MPI_Datatype kind()
+    {
+        return MPI_C_FLOAT_COMPLEX;
+    }
+};
+
 template <>
 struct mpi_type_wrapper<long double>
 {
@@ -223,24 +241,196 @@ struct block_data_descriptor
     }
 };
 
+/// Handler of a non-blocking MPI operation.
+/** The request is movable but not copyable. A request that is still active when the handler is destroyed is
+ *  completed (non-blocking collectives) or released to the MPI library (point-to-point operations). Persistent
+ *  requests are created by the *_init() methods of Communicator, started with start() and freed in the
+ *  destructor. */
 class Request
 {
   private:
-    MPI_Request handler_;
+    /// Raw MPI request.
+    MPI_Request handler_{MPI_REQUEST_NULL};
+
+    /// True if this is a persistent request.
+    bool persistent_{false};
+
+    /// True if the persistent request was started and not yet completed.
+    bool active_{false};
+
+    /// True if this is a request of non-blocking collective operation.
+    /** MPI does not allow to free such requests before they are completed. */
+    bool collective_{false};
+
+    /* copy is not allowed */
+    Request(Request const& src__) = delete;
+    /* assigment is not allowed */
+    Request& operator=(Request const& src__) = delete;
+
+    /// Complete or free the request.
+    void release()
+    {
+        if (is_mpi_finalized()) {
+            return;
+        }
+        if (persistent_) {
+            if (active_) {
+                wait();
+            }
+            if (handler_ != MPI_REQUEST_NULL) {
+                CALL_MPI(MPI_Request_free, (&handler_));
+            }
+        } else if (handler_ != MPI_REQUEST_NULL) {
+            if (collective_) {
+                wait();
+            } else {
+                CALL_MPI(MPI_Request_free, (&handler_));
+            }
+        }
+        handler_ = MPI_REQUEST_NULL;
+        active_  = false;
+    }
+
+    static bool is_mpi_finalized()
+    {
+        int mpi_finalized_flag;
+        MPI_Finalized(&mpi_finalized_flag);
+        return mpi_finalized_flag == true;
+    }
+
   public:
+    /// Default constructor creates a null request.
+    Request()
+    {
+    }
+
+    /// Constructor for a specific kind of request.
+    Request(bool persistent__, bool collective__)
+        : persistent_(persistent__)
+        , collective_(collective__)
+    {
+    }
+
+    /// Move constructor.
+    Request(Request&& src__) noexcept
+    {
+        *this = std::move(src__);
+    }
+
+    /// Move assigment operator.
+    Request& operator=(Request&& src__) noexcept
+    {
+        if (this != &src__) {
+            release();
+            handler_    = src__.handler_;
+            persistent_ = src__.persistent_;
+            active_     = src__.active_;
+            collective_ = src__.collective_;
+            src__.handler_ = MPI_REQUEST_NULL;
+            src__.active_  = false;
+        }
+        return *this;
+    }
+
     ~Request()
     {
-        //CALL_MPI(MPI_Request_free, (&handler_));
+        release();
     }
+
+    /// Wait for the completion of the operation.
     void wait()
     {
         CALL_MPI(MPI_Wait, (&handler_, MPI_STATUS_IGNORE));
+        active_ = false;
+    }
+
+    /// Check if the operation is completed.
+    bool test()
+    {
+        int flag;
+        CALL_MPI(MPI_Test, (&handler_, &flag, MPI_STATUS_IGNORE));
+        if (flag) {
+            active_ = false;
+        }
+        return flag;
+    }
+
+    /// Start the persistent request.
+    void start()
+    {
+        assert(persistent_);
+        assert(!active_);
+        CALL_MPI(MPI_Start, (&handler_));
+        active_ = true;
+    }
+
+    /// True if this request is a null request (nothing to wait for).
+    bool is_null() const
+    {
+        return (handler_ == MPI_REQUEST_NULL);
     }
 
     MPI_Request& handler()
     {
         return handler_;
     }
+
+    /// Wait for the completion of all requests in the list.
+    static void waitall(std::vector<Request>& req__)
+    {
+        std::vector<MPI_Request> h(req__.size());
+        for (size_t i = 0; i < req__.size(); i++) {
+            h[i] = req__[i].handler_;
+        }
+        CALL_MPI(MPI_Waitall, (static_cast<int>(h.size()), h.data(), MPI_STATUSES_IGNORE));
+        for (size_t i = 0; i < req__.size(); i++) {
+            req__[i].handler_ = h[i];
+            req__[i].active_  = false;
+        }
+    }
+
+    /// Check if all requests in the list are completed.
+    static bool testall(std::vector<Request>& req__)
+    {
+        std::vector<MPI_Request> h(req__.size());
+        for (size_t i = 0; i < req__.size(); i++) {
+            h[i] = req__[i].handler_;
+        }
+        int flag;
+        CALL_MPI(MPI_Testall, (static_cast<int>(h.size()), h.data(), &flag, MPI_STATUSES_IGNORE));
+        if (flag) {
+            for (size_t i = 0; i < req__.size(); i++) {
+                req__[i].handler_ = h[i];
+                req__[i].active_  = false;
+            }
+        }
+        return flag;
+    }
+
+    /// Wait for the completion of any request in the list and return its index.
+    /** MPI_UNDEFINED is returned if the list contains only null requests. */
+    static int waitany(std::vector<Request>& req__)
+    {
+        std::vector<MPI_Request> h(req__.size());
+        for (size_t i = 0; i < req__.size(); i++) {
+            h[i] = req__[i].handler_;
+        }
+        int idx;
+        CALL_MPI(MPI_Waitany, (static_cast<int>(h.size()), h.data(), &idx, MPI_STATUS_IGNORE));
+        if (idx != MPI_UNDEFINED) {
+            req__[idx].handler_ = h[idx];
+            req__[idx].active_  = false;
+        }
+        return idx;
+    }
+
+    /// Start all persistent requests in the list.
+    static void startall(std::vector<Request>& req__)
+    {
+        for (auto& r : req__) {
+            r.start();
+        }
+    }
 };
 
 struct mpi_comm_deleter
@@ -514,6 +704,29 @@ class Communicator
                                   mpi_op_wrapper<mpi_op__>::kind(), mpi_comm(), req__));
     }
 
+    /// Perform the in-place non-blocking all-to-all reduction.
+    template <typename T, mpi_op_t mpi_op__ = mpi_op_t::sum>
+    inline Request iallreduce(T* buffer__, int count__) const
+    {
+        Request req(false, true);
+        iallreduce<T, mpi_op__>(buffer__, count__, &req.handler());
+        return std::move(req);
+    }
+
+    /// Perform the non-blocking reduction followed by the scatter of the result.
+    /** Block r of the reduced sendbuf (recvcounts[r] elements) is stored in recvbuf of rank r. */
+    template <typename T, mpi_op_t mpi_op__ = mpi_op_t::sum>
+    inline Request ireduce_scatter(T const* sendbuf__, T* recvbuf__, int const* recvcounts__) const
+    {
+        Request req(false, true);
+#if defined(__PROFILE_MPI)
+        PROFILE("MPI_Ireduce_scatter");
+#endif
+        CALL_MPI(MPI_Ireduce_scatter, (sendbuf__, recvbuf__, recvcounts__, mpi_type_wrapper<T>::kind(),
+                                       mpi_op_wrapper<mpi_op__>::kind(), mpi_comm(), &req.handler()));
+        return std::move(req);
+    }
+
     /// Perform buffer broadcast.
     template <typename T>
     inline void bcast(T* buffer__, int count__, int root__) const
@@ -524,6 +737,18 @@ class Communicator
         CALL_MPI(MPI_Bcast, (buffer__, count__, mpi_type_wrapper<T>::kind(), root__, mpi_comm()));
     }
 
+    /// Perform non-blocking buffer broadcast.
+    template <typename T>
+    inline Request ibcast(T* buffer__, int count__, int root__) const
+    {
+        Request req(false, true);
+#if defined(__PROFILE_MPI)
+        PROFILE("MPI_Ibcast");
+#endif
+        CALL_MPI(MPI_Ibcast, (buffer__, count__, mpi_type_wrapper<T>::kind(), root__, mpi_comm(), &req.handler()));
+        return std::move(req);
+    }
+
     inline void bcast(std::string& str__, int root__) const
     {
         int sz;
@@ -563,6 +788,33 @@ class Communicator
                                   displs__, mpi_type_wrapper<T>::kind(), mpi_comm()));
     }
 
+    /// In-place non-blocking MPI_Allgatherv.
+    template <typename T>
+    Request iallgather(T* buffer__, int const* recvcounts__, int const* displs__) const
+    {
+        Request req(false, true);
+#if defined(__PROFILE_MPI)
+        PROFILE("MPI_Iallgatherv");
+#endif
+        CALL_MPI(MPI_Iallgatherv, (MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, buffer__, recvcounts__, displs__,
+                                   mpi_type_wrapper<T>::kind(), mpi_comm(), &req.handler()));
+        return std::move(req);
+    }
+
+    /// Out-of-place non-blocking MPI_Allgatherv.
+    template <typename T>
+    Request
+    iallgather(T const* sendbuf__, int sendcount__, T* recvbuf__, int const* recvcounts__, int const* displs__) const
+    {
+        Request req(false, true);
+#if defined(__PROFILE_MPI)
+        PROFILE("MPI_Iallgatherv");
+#endif
+        CALL_MPI(MPI_Iallgatherv, (sendbuf__, sendcount__, mpi_type_wrapper<T>::kind(), recvbuf__, recvcounts__,
+                                   displs__, mpi_type_wrapper<T>::kind(), mpi_comm(), &req.handler()));
+        return std::move(req);
+    }
+
     template <typename T>
     void allgather(T const* sendbuf__, T* recvbuf__, int offset__, int count__) const
     {
@@ -647,6 +899,27 @@ class Communicator
         return std::move(req);
     }
 
+    /// Create a persistent send request.
+    /** The request is started with Request::start() and can be reused after completion. */
+    template <typename T>
+    Request send_init(T const* buffer__, int count__, int dest__, int tag__) const
+    {
+        Request req(true, false);
+        CALL_MPI(MPI_Send_init, (buffer__, count__, mpi_type_wrapper<T>::kind(), dest__, tag__, mpi_comm(),
+                                 &req.handler()));
+        return std::move(req);
+    }
+
+    /// Create a persistent receive request.
+    template <typename T>
+    Request recv_init(T* buffer__, int count__, int source__, int tag__) const
+    {
+        Request req(true, false);
+        CALL_MPI(MPI_Recv_init, (buffer__, count__, mpi_type_wrapper<T>::kind(), source__, tag__, mpi_comm(),
+                                 &req.handler()));
+        return std::move(req);
+    }
+
     template <typename T>
     void gather(T const* sendbuf__, T* recvbuf__, int const* recvcounts__, int const* displs__, int root__) const
     {
@@ -721,6 +994,26 @@ class Communicator
                                  recvcounts__, rdispls__, mpi_type_wrapper<T>::kind(), mpi_comm()));
     }
 
+    /// Non-blocking version of alltoallv.
+    /** Counts and displacements must stay valid until the request is completed. */
+    template <typename T>
+    Request ialltoall(T const* sendbuf__,
+                      int const* sendcounts__,
+                      int const* sdispls__,
+                      T* recvbuf__,
+                      int const* recvcounts__,
+                      int const* rdispls__) const
+    {
+        Request req(false, true);
+#if defined(__PROFILE_MPI)
+        PROFILE("MPI_Ialltoallv");
+#endif
+        CALL_MPI(MPI_Ialltoallv, (sendbuf__, sendcounts__, sdispls__, mpi_type_wrapper<T>::kind(), recvbuf__,
+                                  recvcounts__, rdispls__, mpi_type_wrapper<T>::kind(), mpi_comm(),
+                                  &req.handler()));
+        return std::move(req);
+    }
+
     //==alltoall_descriptor map_alltoall(std::vector<int> local_sizes_in, std::vector<int> local_sizes_out) const
     //=={
     //==    alltoall_descriptor a2a;
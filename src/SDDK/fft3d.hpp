@@ -132,6 +132,18 @@ class FFT3D : public FFT3D_grid
     /// FFTW plan for 2D forward transformation.
     std::vector<fftw_plan> plan_forward_xy_;
 
+    /// Internal real buffer for {xy}-transforms of functions which are real in real space.
+    std::vector<double*> fftw_buffer_xy_real_;
+
+    /// FFTW plan for 2D complex-to-real backward transformation.
+    std::vector<fftw_plan> plan_backward_xy_c2r_;
+
+    /// FFTW plan for 2D real-to-complex forward transformation.
+    std::vector<fftw_plan> plan_forward_xy_r2c_;
+
+    /// True if the function which is currently transformed is real in real space.
+    bool is_real_{false};
+
     /// True if GPU-direct is enabled.
     bool is_gpu_direct_{false};
 
@@ -169,6 +181,11 @@ class FFT3D : public FFT3D_grid
     /// Position of z-columns inside 2D FFT buffer.
     mdarray<int, 2> z_col_pos_;
 
+    /// Position of z-columns inside the half-complex 2D buffer of the real-to-complex transformation.
+    /** The second index is 1 if the column itself is stored in the buffer and 0 if the buffer stores its {-x,-y}
+     *  partner, which is the complex conjugate of the column. Only used for the complete set of G-vectors. */
+    mdarray<int, 2> z_col_pos_half_;
+
     /// Type of the memory for CPU buffers.
     memory_t host_memory_type_;
 
@@ -186,6 +203,19 @@ class FFT3D : public FFT3D_grid
 
     block_data_descriptor a2a_recv;
 
+    /// Number of chunks of z-columns in the pipelined all-to-all exchange.
+    /** Value of 1 switches off the pipelining. */
+    int num_a2a_chunks_{1};
+
+    /// Offsets of the chunks of local z-columns in the pipelined all-to-all exchange.
+    std::vector<int> a2a_chunk_zcol_offs_;
+
+    /// Send descriptors of the pipelined all-to-all exchange (one for each chunk).
+    std::vector<block_data_descriptor> a2a_chunk_send_;
+
+    /// Receive descriptors of the pipelined all-to-all exchange (one for each chunk).
+    std::vector<block_data_descriptor> a2a_chunk_recv_;
+
     /// Initialize z-transformation and get the maximum number of z-columns.
     inline int init_plan_z(Gvec_partition const& gvp__, int zcol_count_max__,
                            void** acc_fft_plan__)
@@ -250,16 +280,16 @@ class FFT3D : public FFT3D_grid
         /* local number of z-columns to transform */
         int num_zcol_local = gvec_partition_->zcol_count_fft();
 
-        double norm = 1.0 / size();
-
-        bool is_reduced = gvec_partition_->gvec().reduced();
-
         assert(static_cast<int>(fft_buffer_aux__.size()) >= gvec_partition_->zcol_count_fft() * size(2));
 
         /* input/output data buffer is on device memory */
         if (is_device_memory(mem__)) {
             utils::timer t("sddk::FFT3D::transform_z_serial|gpu");
 #if defined(__GPU)
+            double norm = 1.0 / size();
+
+            bool is_reduced = gvec_partition_->gvec().reduced();
+
             switch (direction) {
                 case 1: {
                     /* load all columns into FFT buffer */
@@ -317,80 +347,161 @@ class FFT3D : public FFT3D_grid
         /* data is host memory */
         if (is_host_memory(mem__)) {
             utils::timer t("sddk::FFT3D::transform_z_serial|cpu");
-            #pragma omp parallel for schedule(dynamic, 1)
-            for (int i = 0; i < num_zcol_local; i++) {
-                /* id of the thread */
-                int tid = omp_get_thread_num();
-                /* global index of column */
-                int icol = gvec_partition_->idx_zcol<index_domain_t::local>(i);
-                /* offset of the PW coeffs in the input/output data buffer */
-                int data_offset = gvec_partition_->zcol_offs(icol);
+            transform_z_serial_cpu<direction>(data__, fft_buffer_aux__, 0, num_zcol_local);
+        }
+    }
 
-                switch (direction) {
-                    case 1: {
-                        /* clear z buffer */
-                        std::fill(fftw_buffer_z_[tid], fftw_buffer_z_[tid] + size(2), 0);
-                        /* load z column  of PW coefficients into buffer */
-                        for (size_t j = 0; j < gvec_partition_->gvec().zcol(icol).z.size(); j++) {
-                            int z                  = coord_by_freq<2>(gvec_partition_->gvec().zcol(icol).z[j]);
-                            fftw_buffer_z_[tid][z] = data__[data_offset + j];
-                        }
+    /// Transform a range of local z-columns on the CPU.
+    /** The layout of fft_buffer_aux is the same as in transform_z_serial(); only the columns with local
+     *  index in [icol_begin, icol_end) are touched. */
+    template <int direction>
+    void transform_z_serial_cpu(double_complex* data__, mdarray<double_complex, 1>& fft_buffer_aux__, int icol_begin__,
+                                int icol_end__)
+    {
+        /* local number of z-columns */
+        int num_zcol_local = gvec_partition_->zcol_count_fft();
 
-                        /* column with {x,y} = {0,0} has only non-negative z components */
-                        if (is_reduced && !icol) {
-                            /* load remaining part of {0,0,z} column */
-                            for (size_t j = 0; j < gvec_partition_->gvec().zcol(icol).z.size(); j++) {
-                                int z                  = coord_by_freq<2>(-gvec_partition_->gvec().zcol(icol).z[j]);
-                                fftw_buffer_z_[tid][z] = std::conj(data__[data_offset + j]);
-                            }
-                        }
+        double norm = 1.0 / size();
 
-                        /* perform local FFT transform of a column */
-                        fftw_execute(plan_backward_z_[tid]);
+        bool is_reduced = gvec_partition_->gvec().reduced();
 
-                        /* redistribute z-column for a forthcoming all-to-all or just load the
-                         * full column into auxiliary buffer in serial case */
-                        for (int r = 0; r < comm_.size(); r++) {
-                            int lsz  = spl_z_.local_size(r);
-                            int offs = spl_z_.global_offset(r);
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int i = icol_begin__; i < icol_end__; i++) {
+            /* id of the thread */
+            int tid = omp_get_thread_num();
+            /* global index of column */
+            int icol = gvec_partition_->idx_zcol<index_domain_t::local>(i);
+            /* offset of the PW coeffs in the input/output data buffer */
+            int data_offset = gvec_partition_->zcol_offs(icol);
 
-                            /* this rank has transformed num_zcol_local columns; this rank has to repack
-                               them in blocks to send to other ranks */
-                            std::copy(&fftw_buffer_z_[tid][offs], &fftw_buffer_z_[tid][offs] + lsz,
-                                      &fft_buffer_aux__[offs * num_zcol_local + i * lsz]);
-                        }
+            switch (direction) {
+                case 1: {
+                    /* for the real function only the columns with x >= 0 are needed by the c2r xy-transform */
+                    if (is_real_ && coord_by_freq<0>(gvec_partition_->gvec().zcol(icol).x) > size(0) / 2) {
                         break;
                     }
-                    case -1: {
-                        /* collect full z-column or just load it from the auxiliary buffer is serial case */
-                        for (int r = 0; r < comm_.size(); r++) {
-                            int lsz  = spl_z_.local_size(r);
-                            int offs = spl_z_.global_offset(r);
-
-                            std::copy(&fft_buffer_aux__[offs * num_zcol_local + i * lsz],
-                                      &fft_buffer_aux__[offs * num_zcol_local + i * lsz] + lsz,
-                                      &fftw_buffer_z_[tid][offs]);
-                        }
-
-                        /* perform local FFT transform of a column */
-                        fftw_execute(plan_forward_z_[tid]);
+                    /* clear z buffer */
+                    std::fill(fftw_buffer_z_[tid], fftw_buffer_z_[tid] + size(2), 0);
+                    /* load z column  of PW coefficients into buffer */
+                    for (size_t j = 0; j < gvec_partition_->gvec().zcol(icol).z.size(); j++) {
+                        int z                  = coord_by_freq<2>(gvec_partition_->gvec().zcol(icol).z[j]);
+                        fftw_buffer_z_[tid][z] = data__[data_offset + j];
+                    }
 
-                        /* save z column of PW coefficients */
+                    /* column with {x,y} = {0,0} has only non-negative z components */
+                    if (is_reduced && !icol) {
+                        /* load remaining part of {0,0,z} column */
                         for (size_t j = 0; j < gvec_partition_->gvec().zcol(icol).z.size(); j++) {
-                            int z                   = coord_by_freq<2>(gvec_partition_->gvec().zcol(icol).z[j]);
-                            data__[data_offset + j] = fftw_buffer_z_[tid][z] * norm;
+                            int z                  = coord_by_freq<2>(-gvec_partition_->gvec().zcol(icol).z[j]);
+                            fftw_buffer_z_[tid][z] = std::conj(data__[data_offset + j]);
                         }
+                    }
 
-                        break;
+                    /* perform local FFT transform of a column */
+                    fftw_execute(plan_backward_z_[tid]);
+
+                    /* redistribute z-column for a forthcoming all-to-all or just load the
+                     * full column into auxiliary buffer in serial case */
+                    for (int r = 0; r < comm_.size(); r++) {
+                        int lsz  = spl_z_.local_size(r);
+                        int offs = spl_z_.global_offset(r);
+
+                        /* this rank has transformed num_zcol_local columns; this rank has to repack
+                           them in blocks to send to other ranks */
+                        std::copy(&fftw_buffer_z_[tid][offs], &fftw_buffer_z_[tid][offs] + lsz,
+                                  &fft_buffer_aux__[offs * num_zcol_local + i * lsz]);
                     }
-                    default: {
-                        TERMINATE("wrong direction");
+                    break;
+                }
+                case -1: {
+                    /* collect full z-column or just load it from the auxiliary buffer is serial case */
+                    for (int r = 0; r < comm_.size(); r++) {
+                        int lsz  = spl_z_.local_size(r);
+                        int offs = spl_z_.global_offset(r);
+
+                        std::copy(&fft_buffer_aux__[offs * num_zcol_local + i * lsz],
+                                  &fft_buffer_aux__[offs * num_zcol_local + i * lsz] + lsz,
+                                  &fftw_buffer_z_[tid][offs]);
                     }
+
+                    /* perform local FFT transform of a column */
+                    fftw_execute(plan_forward_z_[tid]);
+
+                    /* save z column of PW coefficients */
+                    for (size_t j = 0; j < gvec_partition_->gvec().zcol(icol).z.size(); j++) {
+                        int z                   = coord_by_freq<2>(gvec_partition_->gvec().zcol(icol).z[j]);
+                        data__[data_offset + j] = fftw_buffer_z_[tid][z] * norm;
+                    }
+
+                    break;
+                }
+                default: {
+                    TERMINATE("wrong direction");
                 }
             }
         }
     }
 
+    /// Transformation of z-columns with the all-to-all exchange split in chunks.
+    /** Local z-columns are split in a2a_chunk_send_.size() chunks. In case of backward transformation the
+     *  exchange of chunk i is started right after its columns are transformed and runs while the columns of
+     *  chunk i+1 are transformed. In case of forward transformation the exchanges of all chunks are started
+     *  at once and the columns of a chunk are transformed as soon as its exchange is completed. The result
+     *  is identical to the blocking version. */
+    template <int direction>
+    void transform_z_pipelined(double_complex* data__, mdarray<double_complex, 1>& fft_buffer_aux__)
+    {
+        PROFILE("sddk::FFT3D::transform_z_pipelined");
+
+        /* local stick size times full number of z-columns */
+        int a2a_size = gvec_partition_->gvec().num_zcol() * local_size_z();
+
+        int num_chunks = static_cast<int>(a2a_chunk_send_.size());
+
+        std::vector<Request> req(num_chunks);
+
+        switch (direction) {
+            case 1: {
+                for (int k = 0; k < num_chunks; k++) {
+                    transform_z_serial_cpu<direction>(data__, fft_buffer_aux__, a2a_chunk_zcol_offs_[k],
+                                                      a2a_chunk_zcol_offs_[k + 1]);
+                    /* start scattering of the transformed columns; use fft_buffer_ as receiving storage */
+                    req[k] = comm_.ialltoall(fft_buffer_aux__.at(memory_t::host), a2a_chunk_send_[k].counts.data(),
+                                             a2a_chunk_send_[k].offsets.data(), fft_buffer_.at(memory_t::host),
+                                             a2a_chunk_recv_[k].counts.data(), a2a_chunk_recv_[k].offsets.data());
+                }
+                utils::timer t("sddk::FFT3D::transform_z_pipelined|wait");
+                Request::waitall(req);
+                t.stop();
+                /* copy local fractions of z-columns back into auxiliary buffer */
+                std::copy(fft_buffer_.at(memory_t::host), fft_buffer_.at(memory_t::host) + a2a_size,
+                          fft_buffer_aux__.at(memory_t::host));
+                break;
+            }
+            case -1: {
+                /* copy auxiliary buffer because it will be use as the output buffer in the following mpi_a2a */
+                std::copy(fft_buffer_aux__.at(memory_t::host), fft_buffer_aux__.at(memory_t::host) + a2a_size,
+                          fft_buffer_.at(memory_t::host));
+                for (int k = 0; k < num_chunks; k++) {
+                    req[k] = comm_.ialltoall(fft_buffer_.at(memory_t::host), a2a_chunk_recv_[k].counts.data(),
+                                             a2a_chunk_recv_[k].offsets.data(), fft_buffer_aux__.at(memory_t::host),
+                                             a2a_chunk_send_[k].counts.data(), a2a_chunk_send_[k].offsets.data());
+                }
+                for (int k = 0; k < num_chunks; k++) {
+                    utils::timer t("sddk::FFT3D::transform_z_pipelined|wait");
+                    req[k].wait();
+                    t.stop();
+                    transform_z_serial_cpu<direction>(data__, fft_buffer_aux__, a2a_chunk_zcol_offs_[k],
+                                                      a2a_chunk_zcol_offs_[k + 1]);
+                }
+                break;
+            }
+            default: {
+                TERMINATE("wrong direction");
+            }
+        }
+    }
+
     /// Transformation of z-columns.
     template <int direction>
     void transform_z(double_complex* data__, mdarray<double_complex, 1>& fft_buffer_aux__, void* acc_fft_plan_z__,
@@ -405,6 +516,9 @@ class FFT3D : public FFT3D_grid
         /* local stick size times full number of z-columns */
         int a2a_size = gvec_partition_->gvec().num_zcol() * local_size_z();
 
+        /* z-transform of host data is overlapped with the exchange of z-columns */
+        bool pipelined = is_host_memory(mem__) && comm_.size() > 1 && a2a_chunk_send_.size() > 1;
+
         if (direction == -1) {
             /* copy z-sticks to CPU; we need to copy to CPU in two cases:
                  - when data location is on host (in this case z-transfrom is done by CPU) but the processing
@@ -418,7 +532,7 @@ class FFT3D : public FFT3D_grid
             }
 
             /* collect full sticks */
-            if (comm_.size() > 1) {
+            if (comm_.size() > 1 && !pipelined) {
                 utils::timer t("sddk::FFT3D::transform_z|comm");
 
                 if (is_host_memory(mem__) || !is_gpu_direct_) {
@@ -442,11 +556,15 @@ class FFT3D : public FFT3D_grid
             }
         }
 
-        transform_z_serial<direction>(data__, fft_buffer_aux__, acc_fft_plan_z__, mem__);
+        if (pipelined) {
+            transform_z_pipelined<direction>(data__, fft_buffer_aux__);
+        } else {
+            transform_z_serial<direction>(data__, fft_buffer_aux__, acc_fft_plan_z__, mem__);
+        }
 
         if (direction == 1) {
             /* scatter z-columns between slabs of FFT buffer */
-            if (comm_.size() > 1) {
+            if (comm_.size() > 1 && !pipelined) {
                 utils::timer t("sddk::FFT3D::transform_z|comm");
 
                 /* copy to host if we are not using GPU direct */
@@ -518,6 +636,10 @@ class FFT3D : public FFT3D_grid
                 break;
             }
             case device_t::CPU: {
+                if (is_real_) {
+                    transform_xy_real<direction>(fft_buffer_aux__);
+                    break;
+                }
                 #pragma omp parallel for schedule(static)
                 for (int iz = 0; iz < local_size_z(); iz++) {
                     int tid = omp_get_thread_num();
@@ -568,6 +690,62 @@ class FFT3D : public FFT3D_grid
         }
     }
 
+    /// Apply 2D real-to-complex or complex-to-real FFT transformation to z-columns of a real function.
+    /** Only the half of the xy-plane with x >= 0 is transformed; the real-space values are stored in the real part
+     *  of the main FFT buffer. */
+    template <int direction>
+    void transform_xy_real(mdarray<double_complex, 1>& fft_buffer_aux__)
+    {
+        int size_xy = size(0) * size(1);
+        /* size of the half-complex xy-plane */
+        int size_xy_half = (size(0) / 2 + 1) * size(1);
+
+        #pragma omp parallel for schedule(static)
+        for (int iz = 0; iz < local_size_z(); iz++) {
+            int tid = omp_get_thread_num();
+            switch (direction) {
+                case 1: {
+                    /* clear xy-buffer */
+                    std::fill(fftw_buffer_xy_[tid], fftw_buffer_xy_[tid] + size_xy_half, 0);
+                    /* load z-columns with x >= 0 into proper location */
+                    for (int i = 0; i < gvec_partition_->gvec().num_zcol(); i++) {
+                        if (z_col_pos_half_(i, 1)) {
+                            fftw_buffer_xy_[tid][z_col_pos_half_(i, 0)] = fft_buffer_aux__[iz + i * local_size_z()];
+                        }
+                    }
+
+                    /* execute local FFT transform */
+                    fftw_execute(plan_backward_xy_c2r_[tid]);
+
+                    /* copy xy plane to the main FFT buffer */
+                    for (int j = 0; j < size_xy; j++) {
+                        fft_buffer_[iz * size_xy + j] = fftw_buffer_xy_real_[tid][j];
+                    }
+                    break;
+                }
+                case -1: {
+                    /* copy xy plane from the main FFT buffer */
+                    for (int j = 0; j < size_xy; j++) {
+                        fftw_buffer_xy_real_[tid][j] = fft_buffer_[iz * size_xy + j].real();
+                    }
+
+                    /* execute local FFT transform */
+                    fftw_execute(plan_forward_xy_r2c_[tid]);
+
+                    /* get z-columns; columns with x < 0 are the complex conjugates of {-x,-y} columns */
+                    for (int i = 0; i < gvec_partition_->gvec().num_zcol(); i++) {
+                        auto z = fftw_buffer_xy_[tid][z_col_pos_half_(i, 0)];
+                        fft_buffer_aux__[iz + i * local_size_z()] = z_col_pos_half_(i, 1) ? z : std::conj(z);
+                    }
+                    break;
+                }
+                default: {
+                    TERMINATE("wrong direction");
+                }
+            }
+        }
+    }
+
     /// Apply 2D FFT transformation to z-columns of two real functions.
     /** The transformation is always done in the memory of processing unit. */
     template <int direction>
@@ -703,12 +881,15 @@ class FFT3D : public FFT3D_grid
         for (int i = 0; i < omp_get_max_threads(); i++) {
             fftw_buffer_z_.push_back((double_complex*)fftw_malloc(size(2) * sizeof(double_complex)));
             fftw_buffer_xy_.push_back((double_complex*)fftw_malloc(size(0) * size(1) * sizeof(double_complex)));
+            fftw_buffer_xy_real_.push_back((double*)fftw_malloc(size(0) * size(1) * sizeof(double)));
         }
 
         plan_forward_z_   = std::vector<fftw_plan>(omp_get_max_threads());
         plan_forward_xy_  = std::vector<fftw_plan>(omp_get_max_threads());
         plan_backward_z_  = std::vector<fftw_plan>(omp_get_max_threads());
         plan_backward_xy_ = std::vector<fftw_plan>(omp_get_max_threads());
+        plan_forward_xy_r2c_  = std::vector<fftw_plan>(omp_get_max_threads());
+        plan_backward_xy_c2r_ = std::vector<fftw_plan>(omp_get_max_threads());
 
         for (int i = 0; i < omp_get_max_threads(); i++) {
             plan_forward_z_[i] = fftw_plan_dft_1d(size(2), (fftw_complex*)fftw_buffer_z_[i],
@@ -722,6 +903,12 @@ class FFT3D : public FFT3D_grid
 
             plan_backward_xy_[i] = fftw_plan_dft_2d(size(1), size(0), (fftw_complex*)fftw_buffer_xy_[i],
                                                     (fftw_complex*)fftw_buffer_xy_[i], FFTW_BACKWARD, FFTW_ESTIMATE);
+
+            plan_forward_xy_r2c_[i] = fftw_plan_dft_r2c_2d(size(1), size(0), fftw_buffer_xy_real_[i],
+                                                           (fftw_complex*)fftw_buffer_xy_[i], FFTW_ESTIMATE);
+
+            plan_backward_xy_c2r_[i] = fftw_plan_dft_c2r_2d(size(1), size(0), (fftw_complex*)fftw_buffer_xy_[i],
+                                                            fftw_buffer_xy_real_[i], FFTW_ESTIMATE);
         }
 
 #if defined(__GPU)
@@ -774,11 +961,14 @@ class FFT3D : public FFT3D_grid
         for (int i = 0; i < omp_get_max_threads(); i++) {
             fftw_free(fftw_buffer_z_[i]);
             fftw_free(fftw_buffer_xy_[i]);
+            fftw_free(fftw_buffer_xy_real_[i]);
 
             fftw_destroy_plan(plan_forward_z_[i]);
             fftw_destroy_plan(plan_forward_xy_[i]);
             fftw_destroy_plan(plan_backward_z_[i]);
             fftw_destroy_plan(plan_backward_xy_[i]);
+            fftw_destroy_plan(plan_forward_xy_r2c_[i]);
+            fftw_destroy_plan(plan_backward_xy_c2r_[i]);
         }
 #if defined(__GPU)
         if (pu_ == device_t::GPU) {
@@ -883,6 +1073,19 @@ class FFT3D : public FFT3D_grid
         return pu_;
     }
 
+    /// Return the number of chunks in the pipelined all-to-all exchange of z-columns.
+    inline int num_a2a_chunks() const
+    {
+        return num_a2a_chunks_;
+    }
+
+    /// Set the number of chunks in the pipelined all-to-all exchange of z-columns.
+    /** Takes effect at the next call to prepare(). Pipelining is used for the host-memory transforms only. */
+    inline void num_a2a_chunks(int num_a2a_chunks__)
+    {
+        num_a2a_chunks_ = std::max(1, num_a2a_chunks__);
+    }
+
     // TODO: check if reallocation of FFT buffers can be omitted for better performance
     //       problem: cuFFT buffers and work space can be large
 
@@ -924,6 +1127,38 @@ class FFT3D : public FFT3D_grid
         a2a_send.calc_offsets();
         a2a_recv.calc_offsets();
 
+        /* split z-columns of each rank in chunks and create descriptors of the pipelined mpi a2a call;
+           the counts and offsets must stay alive until the non-blocking exchange is completed */
+        a2a_chunk_zcol_offs_.clear();
+        a2a_chunk_send_.clear();
+        a2a_chunk_recv_.clear();
+        if (comm_.size() > 1 && num_a2a_chunks_ > 1) {
+            /* offset of the chunk k in the list of n columns */
+            auto chunk_offs = [this](int n, int k) { return static_cast<int>((static_cast<long>(n) * k) /
+                                                                              num_a2a_chunks_); };
+
+            int ncol = gvec_partition_->zcol_count_fft(rank);
+            for (int k = 0; k <= num_a2a_chunks_; k++) {
+                a2a_chunk_zcol_offs_.push_back(chunk_offs(ncol, k));
+            }
+            for (int k = 0; k < num_a2a_chunks_; k++) {
+                block_data_descriptor send(comm_.size());
+                block_data_descriptor recv(comm_.size());
+                for (int r = 0; r < comm_.size(); r++) {
+                    int ncol_r = gvec_partition_->zcol_count_fft(r);
+                    int c0 = chunk_offs(ncol_r, k);
+                    int c1 = chunk_offs(ncol_r, k + 1);
+
+                    send.counts[r]  = spl_z_.local_size(r) * (a2a_chunk_zcol_offs_[k + 1] - a2a_chunk_zcol_offs_[k]);
+                    send.offsets[r] = a2a_send.offsets[r] + spl_z_.local_size(r) * a2a_chunk_zcol_offs_[k];
+                    recv.counts[r]  = spl_z_.local_size(rank) * (c1 - c0);
+                    recv.offsets[r] = a2a_recv.offsets[r] + spl_z_.local_size(rank) * c0;
+                }
+                a2a_chunk_send_.push_back(send);
+                a2a_chunk_recv_.push_back(recv);
+            }
+        }
+
         /* in case of reduced G-vector set we need to store a position of -x,-y column as well */
         int nc = gvp__.gvec().reduced() ? 2 : 1;
 
@@ -946,6 +1181,25 @@ class FFT3D : public FFT3D_grid
                 z_col_pos_(i, 1) = x + y * size(0);
             }
         }
+
+        /* positions of z-columns in the half-complex xy plane for the transformation of real functions */
+        if (!gvp__.gvec().reduced()) {
+            int size_x_half = size(0) / 2 + 1;
+            z_col_pos_half_ = mdarray<int, 2>(gvp__.gvec().num_zcol(), 2, memory_t::host, "FFT3D.z_col_pos_half_");
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < gvp__.gvec().num_zcol(); i++) {
+                int icol = gvp__.idx_zcol<index_domain_t::global>(i);
+                int x    = coord_by_freq<0>(gvp__.gvec().zcol(icol).x);
+                int y    = coord_by_freq<1>(gvp__.gvec().zcol(icol).y);
+                z_col_pos_half_(i, 1) = (x < size_x_half) ? 1 : 0;
+                if (!z_col_pos_half_(i, 1)) {
+                    x = coord_by_freq<0>(-gvp__.gvec().zcol(icol).x);
+                    y = coord_by_freq<1>(-gvp__.gvec().zcol(icol).y);
+                }
+                assert(x >= 0 && x < size_x_half);
+                z_col_pos_half_(i, 0) = x + y * size_x_half;
+            }
+        }
         t1.stop();
 
         /* init z-plan for G-vector transformation */
@@ -1089,6 +1343,29 @@ class FFT3D : public FFT3D_grid
         }
     }
 
+    /// Transform a function which is real in real space.
+    /** The complete set of G-vectors is expected and the plane-wave coefficients must satisfy
+     *  \f$ f(-{\bf G}) = f^{*}({\bf G}) \f$. In the backward transformation only the z-columns with x >= 0 are
+     *  transformed and the xy-planes are transformed with the complex-to-real FFT; the forward transformation uses
+     *  the real-to-complex FFT of the xy-planes. The real-space values are kept in the real part of the FFT buffer.
+     *  On GPU or for the reduced set of G-vectors this is the regular complex transformation. */
+    template <int direction>
+    void transform_real(double_complex* data__)
+    {
+        if (!gvec_partition_) {
+            TERMINATE("FFT3D is not ready");
+        }
+
+        if (pu_ == device_t::GPU || gvec_partition_->gvec().reduced()) {
+            transform<direction>(data__);
+            return;
+        }
+
+        is_real_ = true;
+        transform<direction>(data__);
+        is_real_ = false;
+    }
+
     /// Transform two real functions.
     template <int direction, memory_t mem = memory_t::host>
     void transform(double_complex* data1__, double_complex* data2__)
@@ -617,6 +617,22 @@ class Gvec
         return lattice_vectors_;
     }
 
+    /// Check if the reciprocal lattice vectors differ from the given ones.
+    /** This is used to decide if the objects which depend on the lattice have to be recomputed after an update. */
+    inline bool lattice_vectors_changed(matrix3d<double> const& lattice_vectors__) const
+    {
+        /* differences below this value are treated as round-off */
+        double const lattice_vectors_tol{1e-12};
+        for (int i : {0, 1, 2}) {
+            for (int j : {0, 1, 2}) {
+                if (std::abs(lattice_vectors_(i, j) - lattice_vectors__(i, j)) > lattice_vectors_tol) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
     /// Return the volume of the real space unit cell that corresponds to the reciprocal lattice of G-vectors.
     inline double omega() const
     {
@@ -783,7 +799,7 @@ class Gvec
      *  column of G-vectors and column's size. Depending on the geometry of the reciprocal lattice,
      *  z-columns may have only negative, only positive or both negative and positive frequencies for
      *  a given x and y. This information is used to compute the offset which is added to the starting index
-     *  in order to get a full G-vector index. */
+     *  in order to get a full G-vector index. Returns -1 if the G-vector is not in the set. */
     inline int index_by_gvec(vector3d<int> const& G__) const
     {
         /* reduced G-vector set does not have negative z for x=y=0 */
@@ -816,6 +832,10 @@ class Gvec
         int z0 = G__[2] - z_columns_[icol].z[0];
         /* calculate proper offset */
         int offs = (z0 >= 0) ? z0 : z0 + col_size;
+        /* z-coordinate is outside of the column */
+        if (offs < 0 || offs >= col_size || z_columns_[icol].z[offs] != G__[2]) {
+            return -1;
+        }
         /* full index */
         int ig = ig0 + offs;
         assert(ig >= 0 && ig < num_gvec());
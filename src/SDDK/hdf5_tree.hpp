@@ -305,6 +305,13 @@ class HDF5_tree
         }
     }
 
+    /// Check if the object with the given name exists at the current location.
+    bool exist(std::string const& name__) const
+    {
+        std::string path = path_ + name__;
+        return (H5Lexists(file_id_, path.c_str(), H5P_DEFAULT) > 0);
+    }
+
     /// Create node by integer index.
     /** Create node at the current location using integer index as a name. */
     HDF5_tree create_node(int idx)
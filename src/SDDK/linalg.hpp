@@ -161,6 +161,56 @@ inline void linalg2::gemm<ftn_double_complex>(char transa, char transb, ftn_int
     }
 }
 
+template <>
+inline void linalg2::gemm<ftn_single>(char transa, char transb, ftn_int m, ftn_int n, ftn_int k, ftn_single const* alpha,
+                                      ftn_single const* A, ftn_int lda, ftn_single const* B, ftn_int ldb,
+                                      ftn_single const* beta, ftn_single* C, ftn_int ldc, stream_id sid) const
+{
+    assert(lda > 0);
+    assert(ldb > 0);
+    assert(ldc > 0);
+    assert(m > 0);
+    assert(n > 0);
+    assert(k > 0);
+    switch (la_) {
+        case linalg_t::blas: {
+            FORTRAN(sgemm)(&transa, &transb, &m, &n, &k, const_cast<float*>(alpha), const_cast<float*>(A), &lda,
+                           const_cast<float*>(B), &ldb, const_cast<float*>(beta), C, &ldc, (ftn_len)1, (ftn_len)1);
+            break;
+        }
+        default: {
+            throw std::runtime_error("single precision gemm is implemented only for blas");
+            break;
+        }
+    }
+}
+
+template <>
+inline void linalg2::gemm<ftn_complex>(char transa, char transb, ftn_int m, ftn_int n, ftn_int k,
+                                       ftn_complex const* alpha, ftn_complex const* A, ftn_int lda,
+                                       ftn_complex const* B, ftn_int ldb, ftn_complex const* beta, ftn_complex* C,
+                                       ftn_int ldc, stream_id sid) const
+{
+    assert(lda > 0);
+    assert(ldb > 0);
+    assert(ldc > 0);
+    assert(m > 0);
+    assert(n > 0);
+    assert(k > 0);
+    switch (la_) {
+        case linalg_t::blas: {
+            FORTRAN(cgemm)(&transa, &transb, &m, &n, &k, const_cast<ftn_complex*>(alpha),
+                           const_cast<ftn_complex*>(A), &lda, const_cast<ftn_complex*>(B), &ldb,
+                           const_cast<ftn_complex*>(beta), C, &ldc, (ftn_len)1, (ftn_len)1);
+            break;
+        }
+        default: {
+            throw std::runtime_error("single precision gemm is implemented only for blas");
+            break;
+        }
+    }
+}
+
 template<>
 inline void linalg2::ger<ftn_double>(ftn_int m, ftn_int n, ftn_double const* alpha, ftn_double const* x, ftn_int incx,
                                      ftn_double const* y, ftn_int incy, ftn_double* A, ftn_int lda, stream_id sid) const
@@ -103,6 +103,13 @@ void inner_local<double_complex>(memory_t mem__, linalg_t la__, int ispn__, Wave
  *    S_{irow0+i,jcol0+j} = \langle \phi_{i0 + i} | \tilde \phi_{j0 + j} \rangle
  *  \f]
  *
+ *  If the result is Hermitian in the global wave-function indices (\f$ \tilde \phi = \hat O \phi \f$ with a
+ *  Hermitian operator \f$ \hat O \f$ or "bra" and "ket" are the same set) and the range of "ket" indices is the
+ *  tail of the range of "bra" indices (\f$ i0 \le j0 \f$ and \f$ i0 + m = j0 + n \f$), only the elements with
+ *  "bra" index not larger than the "ket" index are computed and reduced; the remaining elements are restored by
+ *  complex conjugation. The Hermitian case is switched on by is_herm flag or automatically when the same set of
+ *  wave-functions is passed as "bra" and "ket".
+ *
  *  \param [in]  mem     Type of preferred memory for the resulting matrix.
  *  \param [in]  la      Type of BLAS linear algebra driver.
  *  \param [in]  ispn    Index of spin (0, 1, or 2; 2 means the contribution from two spinor components).
@@ -115,6 +122,7 @@ void inner_local<double_complex>(memory_t mem__, linalg_t la__, int ispn__, Wave
  *  \param [out] result  Resulting inner product matrix \f$ S \f$.
  *  \param [in]  irow0   First row (in the global matrix) of the inner product sub-matrix.
  *  \param [in]  jcol0   First column (in the global matix) of the inner product sub-matrix.
+ *  \param [in]  is_herm True if the resulting matrix is Hermitian.
  */
 template <typename T>
 inline void inner(memory_t        mem__,
@@ -128,12 +136,23 @@ inline void inner(memory_t        mem__,
                   int             n__,
                   dmatrix<T>&     result__,
                   int             irow0__,
-                  int             jcol0__)
+                  int             jcol0__,
+                  bool            is_herm__ = false)
 {
     PROFILE("sddk::inner");
 
     auto& comm = bra__.comm();
 
+    if (&bra__ == &ket__ && i0__ == j0__ && m__ == n__) {
+        is_herm__ = true;
+    }
+    if (is_herm__ && !(i0__ <= j0__ && i0__ + m__ == j0__ + n__)) {
+        TERMINATE("wrong ranges of wave-functions for the Hermitian inner product");
+    }
+    /* offset of the "ket" range inside the "bra" range; in the Hermitian case element (i, j) of the result
+       with i > dij + j is restored from the element (dij + j, i - dij) */
+    int dij = j0__ - i0__;
+
     auto sddk_pp = utils::get_env<int>("SDDK_PRINT_PERFORMANCE");
 
     auto sddk_bs_raw = utils::get_env<int>("SDDK_INNER_BLOCK_SIZE");
@@ -155,15 +174,50 @@ inline void inner(memory_t        mem__,
 
     T beta = 0;
 
+    /* compute local contribution to the full sub-matrix; in the Hermitian case only the upper trapezoid is
+       computed by the blocks of columns */
+    auto compute_local = [&]()
+    {
+        if (is_herm__) {
+            for (int jb = 0; jb < n__; jb += sddk_block_size) {
+                int ncol = std::min(n__, jb + sddk_block_size) - jb;
+                int nrow = std::min(m__, dij + jb + ncol);
+                inner_local<T>(mem__, la__, ispn__, bra__, i0__, nrow, ket__, j0__ + jb, ncol, &beta,
+                               result__.at(mem__, irow0__, jcol0__ + jb), result__.ld(), stream_id(-1));
+            }
+        } else {
+            inner_local<T>(mem__, la__, ispn__, bra__, i0__, m__, ket__, j0__, n__, &beta,
+                           result__.at(mem__, irow0__, jcol0__), result__.ld(), stream_id(-1));
+        }
+    };
+
+    /* restore lower part of the Hermitian sub-matrix stored in the host memory */
+    auto restore_lower = [&]()
+    {
+        #pragma omp parallel for schedule(static)
+        for (int j = 0; j < n__; j++) {
+            for (int i = dij + j + 1; i < m__; i++) {
+                result__(irow0__ + i, jcol0__ + j) = utils::conj(result__(irow0__ + dij + j, jcol0__ + i - dij));
+            }
+        }
+    };
+
     /* single MPI rank */
     if (comm.size() == 1) {
-        inner_local<T>(mem__, la__, ispn__, bra__, i0__, m__, ket__, j0__, n__, &beta,
-                       result__.at(mem__, irow0__, jcol0__), result__.ld(), stream_id(-1));
+        compute_local();
         if (is_device_memory(mem__)) {
             acc::copyout(result__.at(memory_t::host, irow0__, jcol0__), result__.ld(),
                          result__.at(memory_t::device, irow0__, jcol0__), result__.ld(),
                          m__, n__);
         }
+        if (is_herm__) {
+            restore_lower();
+            if (is_device_memory(mem__)) {
+                acc::copyin(result__.at(memory_t::device, irow0__, jcol0__), result__.ld(),
+                            result__.at(memory_t::host, irow0__, jcol0__), result__.ld(),
+                            m__, n__);
+            }
+        }
         if (sddk_pp) {
             time += omp_get_wtime();
             int k = bra__.gkvec().num_gvec() + bra__.num_mt_coeffs();
@@ -172,8 +226,7 @@ inline void inner(memory_t        mem__,
         }
         return;
     } else if (result__.comm().size() == 1) { /* parallel wave-functions distribution but sequential diagonalization */
-        inner_local<T>(mem__, la__, ispn__, bra__, i0__, m__, ket__, j0__, n__, &beta,
-                       result__.at(mem__, irow0__, jcol0__), result__.ld(), stream_id(-1));
+        compute_local();
         if (is_device_memory(mem__)) {
             utils::timer t1("sddk::inner|device_copy");
             acc::copyout(result__.at(memory_t::host, irow0__, jcol0__), result__.ld(),
@@ -187,24 +240,35 @@ inline void inner(memory_t        mem__,
             }
         }
         utils::timer t3("sddk::inner|store");
-        mdarray<T, 2> tmp(m__, n__);
+        /* number of rows and offset of each column in the packed buffer; in the Hermitian case only the upper
+           trapezoid is reduced */
+        std::vector<int> nrow(n__);
+        std::vector<size_t> offs(n__ + 1, 0);
+        for (int j = 0; j < n__; j++) {
+            nrow[j]     = (is_herm__) ? std::min(m__, dij + j + 1) : m__;
+            offs[j + 1] = offs[j] + nrow[j];
+        }
+        std::vector<T> tmp(offs[n__]);
         #pragma omp parallel for schedule(static)
         for (int j = 0; j < n__; j++) {
-            for (int i = 0; i < m__; i++) {
-                tmp(i, j) = result__(irow0__ + i, jcol0__ + j);
+            for (int i = 0; i < nrow[j]; i++) {
+                tmp[offs[j] + i] = result__(irow0__ + i, jcol0__ + j);
             }
         }
         t3.stop();
         utils::timer t1("sddk::inner|mpi");
-        comm.allreduce(tmp.at(memory_t::host), m__ * n__);
+        comm.allreduce(tmp.data(), static_cast<int>(tmp.size()));
         t1.stop();
         utils::timer t2("sddk::inner|store");
         #pragma omp parallel for schedule(static)
         for (int j = 0; j < n__; j++) {
-            for (int i = 0; i < m__; i++) {
-                result__(irow0__ + i, jcol0__ + j) = tmp(i, j);
+            for (int i = 0; i < nrow[j]; i++) {
+                result__(irow0__ + i, jcol0__ + j) = tmp[offs[j] + i];
             }
         }
+        if (is_herm__) {
+            restore_lower();
+        }
         t2.stop();
         if (is_device_memory(mem__)) {
             utils::timer t1("sddk::inner|device_copy");
@@ -270,6 +334,26 @@ inline void inner(memory_t        mem__,
     std::array<MPI_Request, 2> req = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
     std::array<std::array<int, 4>, 2> dims;
 
+    /* in the Hermitian case the block is skipped if all its elements are below the diagonal */
+    auto skip_block = [is_herm__, dij](int i0, int j0, int ncol)
+    {
+        return is_herm__ && (i0 > dij + j0 + ncol - 1);
+    };
+
+    /* in the Hermitian case store the conjugated elements of the reduced block below the diagonal */
+    auto store_lower = [is_herm__, dij, &result__, irow0__, jcol0__](int i0, int j0, int nrow, int ncol, T const* buf)
+    {
+        if (!is_herm__) {
+            return;
+        }
+        for (int jcol = 0; jcol < ncol; jcol++) {
+            for (int irow = std::max(0, dij - i0); irow < std::min(nrow, dij + j0 + jcol - i0); irow++) {
+                result__.set(irow0__ + dij + j0 + jcol, jcol0__ + i0 + irow - dij,
+                             utils::conj(buf[irow + nrow * jcol]));
+            }
+        }
+    };
+
     if (is_device_memory(mem__)) {
         /* state of the buffers:
          * state = 0: buffer is free
@@ -308,6 +392,10 @@ inline void inner(memory_t        mem__,
                     /* actual number of rows in the block */
                     int nrow = std::min(m__, (ibr + 1) * BS) - i0;
 
+                    if (skip_block(i0, j0, ncol)) {
+                        continue;
+                    }
+
                     /* this thread will call cudaZgemm */
                     if (omp_get_thread_num() == 1) {
                         int state{1};
@@ -352,6 +440,7 @@ inline void inner(memory_t        mem__,
                         //}
                         result__.set(irow0__ + i0, jcol0__ + j0, nrow, ncol,
                                      c_tmp.at(memory_t::host, 0, s % num_streams), nrow);
+                        store_lower(i0, j0, nrow, ncol, c_tmp.at(memory_t::host, 0, s % num_streams));
 
                         /* release the buffer */
                         #pragma omp atomic write
@@ -365,7 +454,7 @@ inline void inner(memory_t        mem__,
     }
 
     if (is_host_memory(mem__)) {
-        auto store_panel = [&req, &result__, &dims, &c_tmp, irow0__, jcol0__](int s)
+        auto store_panel = [&req, &result__, &dims, &c_tmp, &store_lower, irow0__, jcol0__](int s)
         {
             utils::timer t1("sddk::inner|store");
             utils::timer t2("sddk::inner|store|mpi");
@@ -381,6 +470,8 @@ inline void inner(memory_t        mem__,
             //}
             result__.set(irow0__ + dims[s % 2][0], jcol0__ + dims[s % 2][1], dims[s % 2][2], dims[s % 2][3],
                           c_tmp.at(memory_t::host, 0, s % 2), dims[s % 2][2]);
+            store_lower(dims[s % 2][0], dims[s % 2][1], dims[s % 2][2], dims[s % 2][3],
+                        c_tmp.at(memory_t::host, 0, s % 2));
         };
 
         int s{0};
@@ -392,6 +483,10 @@ inline void inner(memory_t        mem__,
                 int i0 = ibr * BS;
                 int nrow = std::min(m__, (ibr + 1) * BS) - i0;
 
+                if (skip_block(i0, j0, ncol)) {
+                    continue;
+                }
+
                 if (req[s % 2] != MPI_REQUEST_NULL) {
                     store_panel(s);
                 }
@@ -428,3 +523,97 @@ inline void inner(memory_t        mem__,
         }
     }
 }
+
+/// Inner product between wave-functions computed in single precision.
+/** The wave-functions are converted to single precision on the fly, the local contribution is computed with
+ *  single precision GEMM and reduced in single precision. The result is stored in the double precision matrix.
+ *  Only host memory is supported. This is used as a cheap first pass of the mixed-precision orthogonalization.
+ */
+template <typename T>
+inline void inner_sp(int ispn__, Wave_functions& bra__, int i0__, int m__, Wave_functions& ket__, int j0__, int n__,
+                     dmatrix<T>& result__, int irow0__, int jcol0__)
+{
+    PROFILE("sddk::inner_sp");
+
+    /* single precision counterpart of T */
+    typedef typename std::conditional<std::is_same<T, double>::value, float, std::complex<float>>::type F;
+    /* number of F elements per one complex coefficient */
+    const int nf = std::is_same<T, double>::value ? 2 : 1;
+
+    auto& comm = bra__.comm();
+
+    mdarray<F, 2> s(m__, n__);
+    s.zero();
+
+    /* convert a block of coefficients to single precision */
+    auto convert = [nf](matrix_storage<double_complex, matrix_storage_t::slab>& ms__, int j0__, int n__)
+    {
+        int nr = ms__.num_rows_loc();
+        mdarray<F, 2> a(nf * nr, n__);
+        #pragma omp parallel for schedule(static)
+        for (int j = 0; j < n__; j++) {
+            auto src = reinterpret_cast<double const*>(ms__.prime().at(memory_t::host, 0, j0__ + j));
+            auto dst = reinterpret_cast<float*>(a.at(memory_t::host, 0, j));
+            for (int i = 0; i < 2 * nr; i++) {
+                dst[i] = static_cast<float>(src[i]);
+            }
+        }
+        return std::move(a);
+    };
+
+    auto add_local = [&](matrix_storage<double_complex, matrix_storage_t::slab>& bra,
+                         matrix_storage<double_complex, matrix_storage_t::slab>& ket)
+    {
+        int nr = bra.num_rows_loc();
+        if (nr == 0) {
+            return;
+        }
+        auto a = convert(bra, i0__, m__);
+        auto b = convert(ket, j0__, n__);
+        /* for real wave-functions the contribution of G and -G is counted by the factor of two */
+        F alpha = static_cast<float>(nf);
+        F beta  = 1;
+        linalg2(linalg_t::blas).gemm((nf == 2) ? 'T' : 'C', 'N', m__, n__, nf * nr, &alpha, a.at(memory_t::host),
+                                     nf * nr, b.at(memory_t::host), nf * nr, &beta, s.at(memory_t::host), m__);
+        /* subtract one extra G=0 contribution */
+        if (nf == 2 && comm.rank() == 0) {
+            for (int j = 0; j < n__; j++) {
+                for (int i = 0; i < m__; i++) {
+                    s(i, j) -= a(0, i) * b(0, j);
+                }
+            }
+        }
+    };
+
+    utils::timer t1("sddk::inner_sp|local");
+    for (auto ispn : get_spins(ispn__)) {
+        add_local(bra__.pw_coeffs(ispn), ket__.pw_coeffs(ispn));
+        if (bra__.has_mt()) {
+            if (nf == 2) {
+                TERMINATE("not implemented");
+            }
+            add_local(bra__.mt_coeffs(ispn), ket__.mt_coeffs(ispn));
+        }
+    }
+    t1.stop();
+
+    utils::timer t2("sddk::inner_sp|mpi");
+    comm.allreduce(s.at(memory_t::host), m__ * n__);
+    t2.stop();
+
+    if (result__.comm().size() == 1) {
+        for (int j = 0; j < n__; j++) {
+            for (int i = 0; i < m__; i++) {
+                result__(irow0__ + i, jcol0__ + j) = static_cast<T>(s(i, j));
+            }
+        }
+    } else {
+        mdarray<T, 2> tmp(m__, n__);
+        for (int j = 0; j < n__; j++) {
+            for (int i = 0; i < m__; i++) {
+                tmp(i, j) = static_cast<T>(s(i, j));
+            }
+        }
+        result__.set(irow0__, jcol0__, m__, n__, tmp.at(memory_t::host), m__);
+    }
+}
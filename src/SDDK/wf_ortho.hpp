@@ -22,7 +22,162 @@
  *  \brief Wave-function orthonormalization.
  */
 
+/// Method of orthonormalization of the new block of wave-functions.
+enum class ortho_method_t
+{
+    /// Single pass of Cholesky-QR (Cholesky factorization of the overlap matrix).
+    cholesky,
+
+    /// Two passes of Cholesky-QR; shifted Cholesky-QR3 is used for ill-conditioned blocks.
+    cholesky_qr2,
+
+    /// Cholesky-QR2 with the first overlap matrix computed in single precision (host memory only).
+    mixed
+};
+
+inline ortho_method_t get_ortho_method_t(std::string name__)
+{
+    std::transform(name__.begin(), name__.end(), name__.begin(), ::tolower);
+
+    static const std::map<std::string, ortho_method_t> map_to_type = {
+        {"cholesky", ortho_method_t::cholesky}, {"cholesky_qr2", ortho_method_t::cholesky_qr2},
+        {"mixed", ortho_method_t::mixed}};
+
+    if (map_to_type.count(name__) == 0) {
+        std::stringstream s;
+        s << "wrong label of orthogonalization method : " << name__;
+        TERMINATE(s);
+    }
+
+    return map_to_type.at(name__);
+}
+
+/// Orthonormalize a block of wave-functions using the Cholesky factorization of their overlap matrix.
+/** On input o__ contains the n__ x n__ overlap matrix of the wave-functions [N__, N__ + n__). All sets of
+ *  wave-functions in wfs__ are multiplied by the inverse of the Cholesky factor. The status of the factorization
+ *  is returned (0 in case of success); if the factorization fails the wave-functions are not changed. */
+template <typename T>
+inline int cholesky_orthonormalize(memory_t                     mem__,
+                                   linalg_t                     la__,
+                                   int                          ispn__,
+                                   std::vector<Wave_functions*> wfs__,
+                                   int                          N__,
+                                   int                          n__,
+                                   dmatrix<T>&                  o__,
+                                   Wave_functions&              tmp__)
+{
+    auto spins = (ispn__ == 2) ? std::vector<int>({0, 1}) : std::vector<int>({ispn__});
+
+    /* single MPI rank */
+    if (o__.comm().size() == 1) {
+        bool use_magma{false};
+
+// MAGMA performance for Cholesky and inversion is not good enough; use lapack for the moment
+//#if defined(__GPU) && defined(__MAGMA)
+//        if (pu__ == GPU) {
+//            use_magma = true;
+//        }
+//#endif
+
+        utils::timer t1("sddk::orthogonalize|tmtrx");
+        if (use_magma) {
+            /* Cholesky factorization */
+            if (int info = linalg2(linalg_t::magma).potrf(n__, o__.at(memory_t::device), o__.ld())) {
+                return info;
+            }
+            /* inversion of triangular matrix */
+            if (linalg2(linalg_t::magma).trtri(n__, o__.at(memory_t::device), o__.ld())) {
+                TERMINATE("error in inversion");
+            }
+        } else { /* CPU version */
+            /* Cholesky factorization */
+            if (int info = linalg2(linalg_t::lapack).potrf(n__, &o__(0, 0), o__.ld())) {
+                return info;
+            }
+            /* inversion of triangular matrix */
+            if (linalg2(linalg_t::lapack).trtri(n__, &o__(0, 0), o__.ld())) {
+                TERMINATE("error in inversion");
+            }
+            if (is_device_memory(mem__)) {
+                acc::copyin(o__.at(memory_t::device), o__.ld(), o__.at(memory_t::host), o__.ld(), n__, n__);
+            }
+        }
+        t1.stop();
+
+        utils::timer t2("sddk::orthogonalize|transform");
+
+        for (int s: spins) {
+            /* multiplication by triangular matrix */
+            for (auto& e: wfs__) {
+                /* wave functions are complex, transformation matrix is complex */
+                if (std::is_same<T, double_complex>::value) {
+                    linalg2(la__).trmm('R', 'U', 'N', e->pw_coeffs(s).num_rows_loc(), n__,
+                                       &linalg_const<double_complex>::one(),
+                                       reinterpret_cast<double_complex*>(o__.at(mem__)), o__.ld(),
+                                       e->pw_coeffs(s).prime().at(e->preferred_memory_t(), 0, N__), e->pw_coeffs(s).prime().ld());
+
+                    if (e->has_mt()) {
+                        linalg2(la__).trmm('R', 'U', 'N', e->mt_coeffs(s).num_rows_loc(), n__,
+                                           &linalg_const<double_complex>::one(),
+                                           reinterpret_cast<double_complex*>(o__.at(mem__)), o__.ld(),
+                                           e->mt_coeffs(s).prime().at(e->preferred_memory_t(), 0, N__), e->mt_coeffs(s).prime().ld());
+                    }
+                }
+                /* wave functions are real (psi(G) = psi^{*}(-G)), transformation matrix is real */
+                if (std::is_same<T, double>::value) {
+                    linalg2(la__).trmm('R', 'U', 'N', 2 * e->pw_coeffs(s).num_rows_loc(), n__,
+                                       &linalg_const<double>::one(),
+                                       reinterpret_cast<double*>(o__.at(mem__)), o__.ld(),
+                                       reinterpret_cast<double*>(e->pw_coeffs(s).prime().at(e->preferred_memory_t(), 0, N__)),
+                                       2 * e->pw_coeffs(s).prime().ld());
+
+                    if (e->has_mt()) {
+                        linalg2(la__).trmm('R', 'U', 'N', 2 * e->mt_coeffs(s).num_rows_loc(), n__,
+                                           &linalg_const<double>::one(),
+                                           reinterpret_cast<double*>(o__.at(mem__)), o__.ld(),
+                                           reinterpret_cast<double*>(e->mt_coeffs(s).prime().at(e->preferred_memory_t(), 0, N__)),
+                                           2 * e->mt_coeffs(s).prime().ld());
+                    }
+                }
+            }
+        }
+        t2.stop();
+    } else { /* parallel transformation */
+        utils::timer t1("sddk::orthogonalize|potrf");
+        o__.make_real_diag(n__);
+        if (int info = linalg2(linalg_t::scalapack).potrf(n__, o__.at(memory_t::host), o__.ld(), o__.descriptor())) {
+            return info;
+        }
+        t1.stop();
+
+        utils::timer t2("sddk::orthogonalize|trtri");
+        if (linalg2(linalg_t::scalapack).trtri(n__, o__.at(memory_t::host), o__.ld(), o__.descriptor())) {
+            TERMINATE("error in inversion");
+        }
+        t2.stop();
+
+        /* o is upper triangular matrix */
+        for (int i = 0; i < n__; i++) {
+            for (int j = i + 1; j < n__; j++) {
+                o__.set(j, i, 0);
+            }
+        }
+
+        /* phi is transformed into phi, so we can't use it as the output buffer; use tmp instead and then overwrite phi */
+        for (auto& e: wfs__) {
+            transform(mem__, la__, ispn__, *e, N__, n__, o__, 0, 0, tmp__, 0, n__);
+            for (int s: spins) {
+                e->copy_from(tmp__, n__, s, 0, s, N__);
+            }
+        }
+    }
+
+    return 0;
+}
+
 /// Orthogonalize n new wave-functions to the N old wave-functions
+/** The new wave-functions are projected out of the old subspace and then orthonormalized with the selected
+ *  method. */
 template <typename T, int idx_bra__, int idx_ket__>
 inline void orthogonalize(memory_t                     mem__,
                           linalg_t                     la__,
@@ -31,7 +186,8 @@ inline void orthogonalize(memory_t                     mem__,
                           int                          N__,
                           int                          n__,
                           dmatrix<T>&                  o__,
-                          Wave_functions&              tmp__)
+                          Wave_functions&              tmp__,
+                          ortho_method_t               method__ = ortho_method_t::cholesky)
 {
     PROFILE("sddk::orthogonalize");
 
@@ -119,153 +275,79 @@ inline void orthogonalize(memory_t                     mem__,
         }
     }
 
-    /* orthogonalize new n__ x n__ block */
-    inner(mem__, la__, ispn__, *wfs__[idx_bra__], N__, n__, *wfs__[idx_ket__], N__, n__, o__, 0, 0);
-
-    if (sddk_debug >= 1) {
-        if (o__.comm().rank() == 0) {
-            printf("check diagonal\n");
+    /* orthonormalize new n__ x n__ block; Cholesky-QR2 and mixed-precision methods do two passes */
+    int num_pass = (method__ == ortho_method_t::cholesky) ? 1 : 2;
+    for (int ipass = 0; ipass < num_pass; ipass++) {
+        /* repeat the projection to remove the components of the old subspace reintroduced by the first pass */
+        if (ipass > 0 && N__ > 0) {
+            inner(mem__, la__, ispn__, *wfs__[idx_bra__], 0, N__, *wfs__[idx_ket__], N__, n__, o__, 0, 0);
+            transform(mem__, la__, ispn__, -1.0, wfs__, 0, N__, o__, 0, 0, 1.0, wfs__, N__, n__);
         }
-        auto diag = o__.get_diag(n__);
-        for (int i = 0; i < n__; i++) {
-            if (std::real(diag[i]) <= 0 || std::imag(diag[i]) > 1e-12) {
-                std::cout << "wrong diagonal: " << i << " " << diag[i] << std::endl;
-            }
+        /* overlap matrix is Hermitian */
+        if (method__ == ortho_method_t::mixed && ipass == 0 && is_host_memory(mem__)) {
+            inner_sp(ispn__, *wfs__[idx_bra__], N__, n__, *wfs__[idx_ket__], N__, n__, o__, 0, 0);
+        } else {
+            inner(mem__, la__, ispn__, *wfs__[idx_bra__], N__, n__, *wfs__[idx_ket__], N__, n__, o__, 0, 0, true);
         }
-        if (o__.comm().rank() == 0) {
-            printf("check hermitian\n");
-        }
-        double d = check_hermitian(o__, n__);
-        if (d > 1e-12 && o__.comm().rank() == 0) {
-            std::stringstream s;
-            s << "matrix is not hermitian, max diff = " << d;
-            WARNING(s);
-        }
-    }
-
-    if (sddk_pp) {
-        gflops += ngop * n__ * n__ * K;
-    }
 
-    /* single MPI rank */
-    if (o__.comm().size() == 1) {
-        bool use_magma{false};
-
-// MAGMA performance for Cholesky and inversion is not good enough; use lapack for the moment
-//#if defined(__GPU) && defined(__MAGMA)
-//        if (pu__ == GPU) {
-//            use_magma = true;
-//        }
-//#endif
-
-        utils::timer t1("sddk::orthogonalize|tmtrx");
-        if (use_magma) {
-            /* Cholesky factorization */
-            if (int info = linalg2(linalg_t::magma).potrf(n__, o__.at(memory_t::device), o__.ld())) {
-                std::stringstream s;
-                s << "error in GPU factorization, info = " << info;
-                TERMINATE(s);
+        if (sddk_debug >= 1) {
+            if (o__.comm().rank() == 0) {
+                printf("check diagonal\n");
             }
-            /* inversion of triangular matrix */
-            if (linalg2(linalg_t::magma).trtri(n__, o__.at(memory_t::device), o__.ld())) {
-                TERMINATE("error in inversion");
+            auto diag = o__.get_diag(n__);
+            for (int i = 0; i < n__; i++) {
+                if (std::real(diag[i]) <= 0 || std::imag(diag[i]) > 1e-12) {
+                    std::cout << "wrong diagonal: " << i << " " << diag[i] << std::endl;
+                }
             }
-        } else { /* CPU version */
-            /* Cholesky factorization */
-            if (int info = linalg2(linalg_t::lapack).potrf(n__, &o__(0, 0), o__.ld())) {
-                std::stringstream s;
-                s << "error in factorization, info = " << info << std::endl
-                  << "number of existing states: " << N__ << std::endl
-                  << "number of new states: " << n__ << std::endl
-                  << "number of wave_functions: " << wfs__.size() << std::endl
-                  << "idx_bra: " << idx_bra__ << " " << "idx_ket:" << idx_ket__;
-                TERMINATE(s);
+            if (o__.comm().rank() == 0) {
+                printf("check hermitian\n");
             }
-            /* inversion of triangular matrix */
-            if (linalg2(linalg_t::lapack).trtri(n__, &o__(0, 0), o__.ld())) {
-                TERMINATE("error in inversion");
-            }
-            if (is_device_memory(mem__)) {
-                acc::copyin(o__.at(memory_t::device), o__.ld(), o__.at(memory_t::host), o__.ld(), n__, n__);
+            double d = check_hermitian(o__, n__);
+            if (d > 1e-12 && o__.comm().rank() == 0) {
+                std::stringstream s;
+                s << "matrix is not hermitian, max diff = " << d;
+                WARNING(s);
             }
         }
-        t1.stop();
-
-        utils::timer t2("sddk::orthogonalize|transform");
 
-        for (int s: spins) {
-            /* multiplication by triangular matrix */
-            for (auto& e: wfs__) {
-                /* wave functions are complex, transformation matrix is complex */
-                if (std::is_same<T, double_complex>::value) {
-                    linalg2(la__).trmm('R', 'U', 'N', e->pw_coeffs(s).num_rows_loc(), n__,
-                                       &linalg_const<double_complex>::one(),
-                                       reinterpret_cast<double_complex*>(o__.at(mem__)), o__.ld(),
-                                       e->pw_coeffs(s).prime().at(e->preferred_memory_t(), 0, N__), e->pw_coeffs(s).prime().ld());
+        if (sddk_pp) {
+            gflops += ngop * n__ * n__ * K;
+        }
 
-                    if (e->has_mt()) {
-                        linalg2(la__).trmm('R', 'U', 'N', e->mt_coeffs(s).num_rows_loc(), n__,
-                                           &linalg_const<double_complex>::one(),
-                                           reinterpret_cast<double_complex*>(o__.at(mem__)), o__.ld(),
-                                           e->mt_coeffs(s).prime().at(e->preferred_memory_t(), 0, N__), e->mt_coeffs(s).prime().ld());
-                    }
-                }
-                /* wave functions are real (psi(G) = psi^{*}(-G)), transformation matrix is real */
-                if (std::is_same<T, double>::value) {
-                    linalg2(la__).trmm('R', 'U', 'N', 2 * e->pw_coeffs(s).num_rows_loc(), n__,
-                                       &linalg_const<double>::one(),
-                                       reinterpret_cast<double*>(o__.at(mem__)), o__.ld(),
-                                       reinterpret_cast<double*>(e->pw_coeffs(s).prime().at(e->preferred_memory_t(), 0, N__)),
-                                       2 * e->pw_coeffs(s).prime().ld());
+        int info = cholesky_orthonormalize(mem__, la__, ispn__, wfs__, N__, n__, o__, tmp__);
 
-                    if (e->has_mt()) {
-                        linalg2(la__).trmm('R', 'U', 'N', 2 * e->mt_coeffs(s).num_rows_loc(), n__,
-                                           &linalg_const<double>::one(),
-                                           reinterpret_cast<double*>(o__.at(mem__)), o__.ld(),
-                                           reinterpret_cast<double*>(e->mt_coeffs(s).prime().at(e->preferred_memory_t(), 0, N__)),
-                                           2 * e->mt_coeffs(s).prime().ld());
-                    }
+        if (info && method__ != ortho_method_t::cholesky) {
+            /* ill-conditioned block: recompute the overlap matrix in double precision, shift its diagonal by
+               11 (K n + n (n + 1)) u ||O|| and do two more ordinary passes after the shifted one (shifted
+               Cholesky-QR3) */
+            inner(mem__, la__, ispn__, *wfs__[idx_bra__], N__, n__, *wfs__[idx_ket__], N__, n__, o__, 0, 0, true);
+            auto diag = o__.get_diag(n__);
+            double norm{0};
+            for (int i = 0; i < n__; i++) {
+                norm += std::abs(diag[i]);
+            }
+            double nrow = wfs__[0]->gkvec().num_gvec() + wfs__[0]->num_mt_coeffs();
+            double shift = 11 * (nrow * n__ + n__ * (n__ + 1.0)) * std::numeric_limits<double>::epsilon() * norm;
+            for (int i = 0; i < n__; i++) {
+                if (o__.comm().size() == 1) {
+                    o__(i, i) += shift;
+                } else {
+                    o__.add(i, i, shift);
                 }
             }
+            info     = cholesky_orthonormalize(mem__, la__, ispn__, wfs__, N__, n__, o__, tmp__);
+            num_pass = ipass + 3;
         }
-        t2.stop();
-    } else { /* parallel transformation */
-        utils::timer t1("sddk::orthogonalize|potrf");
-        mdarray<T, 1> diag;
-        o__.make_real_diag(n__);
-        if (sddk_debug >= 1) {
-            diag = o__.get_diag(n__);
-        }
-        if (int info = linalg2(linalg_t::scalapack).potrf(n__, o__.at(memory_t::host), o__.ld(), o__.descriptor())) {
+        if (info) {
             std::stringstream s;
-            s << "error in Cholesky factorization, info = " << info << ", matrix size = " << n__;
-            if (sddk_debug >= 1) {
-                s << std::endl << "  diag = " << diag[info - 1];
-            }
+            s << "error in factorization, info = " << info << std::endl
+              << "number of existing states: " << N__ << std::endl
+              << "number of new states: " << n__ << std::endl
+              << "number of wave_functions: " << wfs__.size() << std::endl
+              << "idx_bra: " << idx_bra__ << " " << "idx_ket:" << idx_ket__;
             TERMINATE(s);
         }
-        t1.stop();
-
-        utils::timer t2("sddk::orthogonalize|trtri");
-        if (linalg2(linalg_t::scalapack).trtri(n__, o__.at(memory_t::host), o__.ld(), o__.descriptor())) {
-            TERMINATE("error in inversion");
-        }
-        t2.stop();
-
-        /* o is upper triangular matrix */
-        for (int i = 0; i < n__; i++) {
-            for (int j = i + 1; j < n__; j++) {
-                o__.set(j, i, 0);
-            }
-        }
-
-        /* phi is transformed into phi, so we can't use it as the output buffer; use tmp instead and then overwrite phi */
-        for (auto& e: wfs__) {
-            transform(mem__, la__, ispn__, *e, N__, n__, o__, 0, 0, tmp__, 0, n__);
-            for (int s: spins) {
-                e->copy_from(tmp__, n__, s, 0, s, N__);
-            }
-        }
     }
 }
 
@@ -278,13 +360,14 @@ inline void orthogonalize(memory_t        mem__,
                           int             N__,
                           int             n__,
                           dmatrix<T>&     o__,
-                          Wave_functions& tmp__)
+                          Wave_functions& tmp__,
+                          ortho_method_t  method__ = ortho_method_t::cholesky)
 {
     static_assert(std::is_same<T, double>::value || std::is_same<T, double_complex>::value, "wrong type");
 
     auto wfs = {&phi__, &hphi__};
 
-    orthogonalize<T, 0, 0>(mem__, la__, ispn__, wfs, N__, n__, o__, tmp__);
+    orthogonalize<T, 0, 0>(mem__, la__, ispn__, wfs, N__, n__, o__, tmp__, method__);
 }
 
 template <typename T>
@@ -297,11 +380,12 @@ inline void orthogonalize(memory_t        mem__,
                           int             N__,
                           int             n__,
                           dmatrix<T>&     o__,
-                          Wave_functions& tmp__)
+                          Wave_functions& tmp__,
+                          ortho_method_t  method__ = ortho_method_t::cholesky)
 {
     static_assert(std::is_same<T, double>::value || std::is_same<T, double_complex>::value, "wrong type");
 
     auto wfs = {&phi__, &hphi__, &ophi__};
 
-    orthogonalize<T, 0, 2>(mem__, la__, ispn__, wfs, N__, n__, o__, tmp__);
+    orthogonalize<T, 0, 2>(mem__, la__, ispn__, wfs, N__, n__, o__, tmp__, method__);
 }
@@ -196,7 +196,8 @@ class Atom_type
     inline void read_pseudo_paw(json const& parser);
 
     /// Read atomic parameters from json file or string.
-    inline void read_input(std::string const& str__);
+    /** The file is read by the root rank of the communicator and broadcast to the other ranks. */
+    inline void read_input(std::string const& str__, Communicator const& comm__);
 
     inline void init_aw_descriptors(int lmax)
     {
@@ -269,7 +270,8 @@ class Atom_type
 
     Atom_type(Atom_type&& src) = default;
 
-    inline void init(int offset_lo__);
+    /// Read the species file and initialize the atom type.
+    inline void init(int offset_lo__, Communicator const& comm__ = Communicator::self());
 
     inline void set_radial_grid(radial_grid_t grid_type__, int num_points__, double rmin__, double rmax__, double p__)
     {
@@ -1021,7 +1023,7 @@ class Atom_type
     inline double_complex calculate_U_sigma_m(const int l, const double j, const int mj, const int m, const int sigma);
 };
 
-inline void Atom_type::init(int offset_lo__)
+inline void Atom_type::init(int offset_lo__, Communicator const& comm__)
 {
     PROFILE("sirius::Atom_type::init");
 
@@ -1033,7 +1035,7 @@ inline void Atom_type::init(int offset_lo__)
     offset_lo_ = offset_lo__;
 
     /* read data from file if it exists */
-    read_input(file_name_);
+    read_input(file_name_, comm__);
 
     /* check the nuclear charge */
     if (zn_ == 0) {
@@ -1624,9 +1626,9 @@ inline void Atom_type::read_pseudo_paw(json const& parser)
     }
 }
 
-inline void Atom_type::read_input(std::string const& str__)
+inline void Atom_type::read_input(std::string const& str__, Communicator const& comm__)
 {
-    json parser = utils::read_json_from_file_or_string(str__);
+    json parser = read_json_from_file_or_string(str__, comm__);
 
     if (parser.empty()) {
         return;
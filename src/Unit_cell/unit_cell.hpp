@@ -801,7 +801,7 @@ inline void Unit_cell::initialize()
     /* initialize atom types */
     int offs_lo{0};
     for (int iat = 0; iat < num_atom_types(); iat++) {
-        atom_type(iat).init(offs_lo);
+        atom_type(iat).init(offs_lo, comm_);
         max_num_mt_points_        = std::max(max_num_mt_points_, atom_type(iat).num_mt_points());
         max_mt_basis_size_        = std::max(max_mt_basis_size_, atom_type(iat).mt_basis_size());
         max_mt_radial_basis_size_ = std::max(max_mt_radial_basis_size_, atom_type(iat).mt_radial_basis_size());
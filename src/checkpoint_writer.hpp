@@ -0,0 +1,219 @@
+// Copyright (c) 2013-2018 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file checkpoint_writer.hpp
+ *
+ *  \brief Contains definition and implementation of sirius::Checkpoint_writer class.
+ */
+
+#ifndef __CHECKPOINT_WRITER_HPP__
+#define __CHECKPOINT_WRITER_HPP__
+
+#include <string>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace sirius {
+
+/// Name of the checkpoint file written by a given MPI rank.
+inline std::string checkpoint_file_name(std::string const& prefix__, int rank__)
+{
+    return prefix__ + "." + std::to_string(rank__) + ".h5";
+}
+
+/// Prefix of the checkpoint files of a given generation.
+/** Each checkpoint is written to a new set of files; the previous set is removed only after the new one is
+ *  complete on all ranks. */
+inline std::string checkpoint_generation_prefix(std::string const& prefix__, int gen__)
+{
+    return prefix__ + "." + std::to_string(gen__);
+}
+
+/// Name of the file which points to the newest checkpoint generation written by all ranks.
+inline std::string checkpoint_marker_name(std::string const& prefix__)
+{
+    return prefix__ + ".h5";
+}
+
+/// Write checkpoints in the background.
+/** The jobs are executed one after another by a separate I/O thread, so the SCF loop continues while the
+ *  checkpoint is written. All HDF5 output must go through the writer, since the HDF5 library is not required to
+ *  be thread-safe. The job must own a copy of the data it writes, must not call MPI and reports errors by
+ *  throwing an exception. The submission
+ *  blocks when the number of checkpoints in flight reaches the limit, which bounds the memory of the staged data.
+ *  An exception thrown by the job is passed to the caller of the next submit() or wait(); the jobs which finish
+ *  after the failure are not counted by num_done(). */
+class Checkpoint_writer
+{
+  private:
+    /// Maximum number of submitted and not yet finished jobs with staged data.
+    int max_in_flight_;
+
+    /// Number of submitted and not yet finished jobs.
+    int num_in_flight_{0};
+
+    /// Number of submitted and not yet finished jobs which count towards the limit.
+    int num_staged_{0};
+
+    /// Total number of submitted jobs.
+    int num_submitted_{0};
+
+    /// Number of successfully finished jobs before the first failure.
+    int num_done_{0};
+
+    /// True if one of the jobs has failed.
+    bool failed_{false};
+
+    /// True if the I/O thread must exit.
+    bool stop_{false};
+
+    /// Exception thrown by the last failed job.
+    std::exception_ptr error_;
+
+    /// Queue of jobs.
+    std::deque<std::pair<std::function<void()>, bool>> jobs_;
+
+    std::mutex mutex_;
+
+    std::condition_variable cv_;
+
+    /// I/O thread.
+    std::thread thread_;
+
+    /// Main loop of the I/O thread.
+    void run()
+    {
+        while (true) {
+            std::function<void()> job;
+            bool staged;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+                if (jobs_.empty()) {
+                    return;
+                }
+                job    = std::move(jobs_.front().first);
+                staged = jobs_.front().second;
+                jobs_.pop_front();
+            }
+            std::exception_ptr error;
+            try {
+                job();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                num_in_flight_--;
+                if (staged) {
+                    num_staged_--;
+                }
+                if (error) {
+                    error_  = error;
+                    failed_ = true;
+                }
+                if (!failed_) {
+                    num_done_++;
+                }
+            }
+            cv_.notify_all();
+        }
+    }
+
+    /// Rethrow the exception of the failed job; the mutex must be locked.
+    void check_error()
+    {
+        if (error_) {
+            auto error = error_;
+            error_     = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+  public:
+    Checkpoint_writer(int max_in_flight__)
+        : max_in_flight_(std::max(1, max_in_flight__))
+    {
+        thread_ = std::thread(&Checkpoint_writer::run, this);
+    }
+
+    Checkpoint_writer(Checkpoint_writer const& src__) = delete;
+
+    Checkpoint_writer& operator=(Checkpoint_writer const& src__) = delete;
+
+    /// Finish the pending jobs and stop the I/O thread.
+    ~Checkpoint_writer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    /// Add job to the queue and return its index; wait if the maximum number of jobs is already in flight.
+    /** The job with index i is finished when num_done() > i. Small jobs which do not own staged data
+     *  (staged__ = false) are not counted towards the limit and never wait. */
+    int submit(std::function<void()> job__, bool staged__ = true)
+    {
+        int idx;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (staged__) {
+                cv_.wait(lock, [this]() { return num_staged_ < max_in_flight_; });
+            }
+            check_error();
+            num_in_flight_++;
+            if (staged__) {
+                num_staged_++;
+            }
+            idx = num_submitted_++;
+            jobs_.push_back(std::make_pair(std::move(job__), staged__));
+        }
+        cv_.notify_all();
+        return idx;
+    }
+
+    /// Number of jobs which are finished in the order of submission.
+    int num_done()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return num_done_;
+    }
+
+    /// Wait until all submitted jobs are finished.
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return num_in_flight_ == 0; });
+        check_error();
+    }
+};
+
+} // namespace sirius
+
+#endif // __CHECKPOINT_WRITER_HPP__
@@ -13,7 +13,8 @@ in_type_map = {
     'double'  : 'real(C_DOUBLE)',
     'string'  : 'character(C_CHAR)',
     'bool'    : 'logical(C_BOOL)',
-    'complex' : 'complex(C_DOUBLE)'
+    'complex' : 'complex(C_DOUBLE)',
+    'func'    : 'type(C_FUNPTR)'
 }
 
 
@@ -30,6 +30,11 @@
 #include "Hubbard/hubbard.hpp"
 #include "Geometry/stress.hpp"
 #include "Geometry/force.hpp"
+#include "checkpoint_writer.hpp"
+#include <deque>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 
 using json = nlohmann::json;
 
@@ -70,6 +75,80 @@ class DFT_ground_state
     /// Store Ewald energy which is computed once and which doesn't change during the run.
     double ewald_energy_{0};
 
+    /// Atomic positions of the ionic steps, starting from the most recent one.
+    std::deque<std::vector<vector3d<double>>> positions_hist_;
+
+    /// Difference between the density and the superposition of atomic densities for the previous ionic steps.
+    std::deque<mdarray<double_complex, 1>> drho_hist_;
+
+    /// Wave-functions of the local k-points for the previous ionic steps.
+    std::deque<std::map<int, std::unique_ptr<Wave_functions>>> psi_hist_;
+
+    /// Generations of the checkpoint files kept on disk.
+    /** Index of generation, SCF iteration, number of slabs and index of the writer job (-1 if the generation was
+     *  loaded from disk). */
+    std::deque<std::array<int, 4>> checkpoint_generations_;
+
+    /// Index of the next checkpoint generation.
+    int checkpoint_next_gen_{0};
+
+    /// Generation for which the marker file is submitted to the writer.
+    int checkpoint_marked_gen_{-1};
+
+    /// Index of the writer job which writes the last marker file (rank 0 only).
+    int checkpoint_marker_job_{-1};
+
+    /// Generation referenced by the marker file on disk.
+    int checkpoint_published_gen_{-1};
+
+    /// Background writer of the SCF checkpoints.
+    std::unique_ptr<Checkpoint_writer> checkpoint_writer_;
+
+    /// Function which receives the telemetry record of each SCF iteration.
+    std::function<void(json const&)> scf_telemetry_callback_;
+
+    /// True if the density or wave-functions are extrapolated between ionic steps.
+    inline bool extrapolate() const
+    {
+        return !ctx_.full_potential() && (ctx_.parameters_input().density_extrapolation_ != "none" ||
+                                          ctx_.parameters_input().wf_extrapolation_ != "none");
+    }
+
+    /// Get the current atomic positions in lattice coordinates.
+    inline std::vector<vector3d<double>> atom_positions() const
+    {
+        std::vector<vector3d<double>> pos(unit_cell_.num_atoms());
+        for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+            pos[ia] = unit_cell_.atom(ia).position();
+        }
+        return pos;
+    }
+
+    /// Get the coefficients of the extrapolation of a given order.
+    inline std::array<double, 2> extrapolation_coefficients(int order__) const;
+
+    /// Store the density and wave-functions of the converged ionic step.
+    inline void save_ionic_step();
+
+    /// Extrapolate density and wave-functions to the new atomic positions.
+    inline void extrapolate_ionic_step();
+
+    /// Stage density and potential and write them to the per-rank checkpoint files in the background.
+    inline void checkpoint(int iter__);
+
+    /// Point the marker file to the newest checkpoint generation written by all ranks and remove the older ones.
+    /** If wait__ is true, the pending writes are finished first, so that the newest generation is published. */
+    inline void publish_checkpoints(bool wait__ = false);
+
+    /// Collect the telemetry record of the SCF iteration.
+    /** Timings are the maximum values over MPI ranks; imbalance is the ratio of maximum to average time. */
+    inline json scf_telemetry_record(int iter__, std::vector<double> const& times__, double rms__, double etot__,
+                                     double de__) const;
+
+    /// Extrapolate wave-functions using the previous steps aligned to the current subspace.
+    template <typename T>
+    inline void extrapolate_wave_functions(std::array<double, 2> ab__);
+
     /// Compute the ion-ion electrostatic energy using Ewald method.
     /** The following contribution (per unit cell) to the total energy has to be computed:
      *  \f[
@@ -217,6 +296,9 @@ class DFT_ground_state
         if (!ctx_.full_potential()) {
             ewald_energy_ = ewald_energy();
         }
+        if (extrapolate()) {
+            positions_hist_.push_front(atom_positions());
+        }
     }
 
     /// Generate initial densty, potential and a subspace of wave-functions.
@@ -230,10 +312,17 @@ class DFT_ground_state
     }
 
     /// Update the parameters after the change of lattice vectors or atomic positions.
+    /** If requested, the density and wave-functions of the previous ionic steps are extrapolated to the new
+     *  atomic positions and the effective potential is regenerated. */
     void update()
     {
         PROFILE("sirius::DFT_ground_state::update");
 
+        /* this must be done before the phase factors are updated */
+        if (extrapolate()) {
+            save_ionic_step();
+        }
+
         ctx_.update();
         kset_.update();
         potential_.update();
@@ -242,6 +331,10 @@ class DFT_ground_state
         if (!ctx_.full_potential()) {
             ewald_energy_ = ewald_energy();
         }
+
+        if (extrapolate()) {
+            extrapolate_ionic_step();
+        }
     }
 
     /// Return reference to a simulation context.
@@ -250,6 +343,15 @@ class DFT_ground_state
         return ctx_;
     }
 
+    /// Set the function which receives the telemetry record of each SCF iteration on rank 0.
+    void scf_telemetry_callback(std::function<void(json const&)> f__)
+    {
+        scf_telemetry_callback_ = f__;
+    }
+
+    /// Load density and potential from the per-rank checkpoint files and return the SCF iteration of the checkpoint.
+    inline int load_checkpoint();
+
     /// Run the SCF ground state calculation and find a total energy minimum.
     json find(double potential_tol, double energy_tol, double initial_tolerance, int num_dft_iter, bool write_state);
 
@@ -673,8 +775,19 @@ inline json DFT_ground_state::find(double potential_tol, double energy_tol, doub
 
     ctx_.iterative_solver_tolerance(initial_tolerance);
 
+    /* the telemetry records are collected on all ranks if any of them is listening */
+    int telemetry = (ctx_.control().scf_telemetry_file_.size() || scf_telemetry_callback_) ? 1 : 0;
+    ctx_.comm().allreduce<int, mpi_op_t::max>(&telemetry, 1);
+    std::ofstream telemetry_out;
+    if (ctx_.comm().rank() == 0 && ctx_.control().scf_telemetry_file_.size()) {
+        telemetry_out.open(ctx_.control().scf_telemetry_file_, std::ios_base::app);
+    }
+
     for (int iter = 0; iter < num_dft_iter; iter++) {
         utils::timer t1("sirius::DFT_ground_state::scf_loop|iteration");
+        auto t_iter = std::chrono::high_resolution_clock::now();
+        /* time of band solution, density generation, mixing and potential generation */
+        std::vector<double> times(5, 0);
 
         if (ctx_.comm().rank() == 0 && ctx_.control().verbosity_ >= 1) {
             printf("\n");
@@ -683,10 +796,14 @@ inline json DFT_ground_state::find(double potential_tol, double energy_tol, doub
             printf("+------------------------------+\n");
         }
 
+        utils::timer t2("sirius::DFT_ground_state::scf_loop|band");
         /* find new wave-functions */
         Band(ctx_).solve(kset_, hamiltonian_, true);
         /* find band occupancies */
         kset_.find_band_occupancies();
+        times[0] = t2.stop();
+
+        utils::timer t3("sirius::DFT_ground_state::scf_loop|density");
         /* generate new density from the occupied wave-functions */
         density_.generate(kset_, true, false);
         /* symmetrize density and magnetization */
@@ -696,10 +813,13 @@ inline json DFT_ground_state::find(double potential_tol, double energy_tol, doub
                 density_.symmetrize_density_matrix();
             }
         }
+        times[1] = t3.stop();
 
         if (!ctx_.full_potential()) {
+            utils::timer t4("sirius::DFT_ground_state::scf_loop|mixer");
             /* mix density */
             rms = density_.mix();
+            times[2] = t4.stop();
             /* estimate new tolerance of iterative solver */
             //double tol = std::max(1e-12, 0.1 * density_.dr2() / ctx_.unit_cell().num_valence_electrons());
             double tol = std::max(ctx_.settings().itsol_tol_min_, 0.0001 * rms);
@@ -726,6 +846,7 @@ inline json DFT_ground_state::find(double potential_tol, double energy_tol, doub
             density_.mix();
         }
 
+        utils::timer t5("sirius::DFT_ground_state::scf_loop|potential");
         /* compute new potential */
         potential_.generate(density_);
 
@@ -736,12 +857,15 @@ inline json DFT_ground_state::find(double potential_tol, double energy_tol, doub
 
         /* transform potential to real space after symmetrization */
         potential_.fft_transform(1);
+        times[3] = t5.stop();
 
         /* compute new total energy for a new density */
         double etot = total_energy();
 
         if (ctx_.full_potential()) {
+            utils::timer t4("sirius::DFT_ground_state::scf_loop|mixer");
             rms        = potential_.mix(ctx_.settings().mixer_rss_min_);
+            times[2]   = t4.stop();
             double tol = std::max(ctx_.settings().itsol_tol_min_, 0.001 * rms);
             ctx_.iterative_solver_tolerance(std::min(ctx_.iterative_solver_tolerance(), tol));
         }
@@ -758,6 +882,21 @@ inline json DFT_ground_state::find(double potential_tol, double energy_tol, doub
             }
         }
 
+        if (telemetry) {
+            times[4] = std::chrono::duration_cast<std::chrono::duration<double>>(
+                           std::chrono::high_resolution_clock::now() - t_iter).count();
+            auto record = scf_telemetry_record(iter, times, rms, etot, etot - eold);
+            if (ctx_.comm().rank() == 0) {
+                if (telemetry_out.is_open()) {
+                    /* flush the line, so the record is visible while the job is running */
+                    telemetry_out << record.dump() << std::endl;
+                }
+                if (scf_telemetry_callback_) {
+                    scf_telemetry_callback_(record);
+                }
+            }
+        }
+
         // TODO: improve this part
         if (ctx_.full_potential()) {
             if (std::abs(eold - etot) < energy_tol && rms < potential_tol) {
@@ -785,9 +924,23 @@ inline json DFT_ground_state::find(double potential_tol, double energy_tol, doub
             hamiltonian_.U().calculate_hubbard_potential_and_energy();
         }
 
+        /* redistribute k-points using the measured time of the band solution */
+        if (ctx_.control().kpoint_distribution_ == "dynamic") {
+            kset_.rebalance();
+        }
+
+        /* the checkpoint is written during the band solution of the next iteration */
+        if (ctx_.control().checkpoint_period_ > 0 && (iter + 1) % ctx_.control().checkpoint_period_ == 0) {
+            checkpoint(iter);
+        }
+
         eold = etot;
     }
 
+    if (checkpoint_writer_) {
+        publish_checkpoints(true);
+    }
+
     if (write_state) {
         ctx_.create_storage_file();
         if (ctx_.full_potential()) { // TODO: why this is necessary?
@@ -822,6 +975,440 @@ inline json DFT_ground_state::find(double potential_tol, double energy_tol, doub
     return std::move(dict);
 }
 
+inline std::array<double, 2> DFT_ground_state::extrapolation_coefficients(int order__) const
+{
+    std::array<double, 2> ab = {0, 0};
+    if (order__ == 1 || (order__ == 2 && positions_hist_.size() < 4)) {
+        ab[0] = 1;
+    }
+    if (order__ == 2 && positions_hist_.size() >= 4) {
+        /* fit the last displacement by the two previous ones (D. Alfe, Comp. Phys. Comm. 118, 31 (1999)):
+           |d1 - a d2 - b d3|^2 -> min */
+        double m[2][2] = {{0, 0}, {0, 0}};
+        double r[2] = {0, 0};
+        for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+            vector3d<double> d[3];
+            for (int i = 0; i < 3; i++) {
+                auto v = positions_hist_[i][ia] - positions_hist_[i + 1][ia];
+                /* minimum image convention */
+                for (int x : {0, 1, 2}) {
+                    v[x] -= std::round(v[x]);
+                }
+                d[i] = unit_cell_.lattice_vectors() * v;
+            }
+            m[0][0] += dot(d[1], d[1]);
+            m[0][1] += dot(d[1], d[2]);
+            m[1][1] += dot(d[2], d[2]);
+            r[0] += dot(d[0], d[1]);
+            r[1] += dot(d[0], d[2]);
+        }
+        double det = m[0][0] * m[1][1] - m[0][1] * m[0][1];
+        if (std::abs(det) > 1e-12 * std::max(1e-12, m[0][0] * m[1][1])) {
+            ab[0] = (r[0] * m[1][1] - r[1] * m[0][1]) / det;
+            ab[1] = (r[1] * m[0][0] - r[0] * m[0][1]) / det;
+        } else if (m[0][0] > 1e-12) {
+            ab[0] = r[0] / m[0][0];
+        }
+    }
+    return ab;
+}
+
+inline void DFT_ground_state::checkpoint(int iter__)
+{
+    PROFILE("sirius::DFT_ground_state::checkpoint");
+
+    using slab_t = Periodic_function<double>::hdf5_slab_t;
+
+    /* copy of the data owned by the I/O job */
+    struct checkpoint_data_t
+    {
+        std::vector<std::pair<std::string, slab_t>> functions;
+        std::vector<std::vector<double>> d_mtrx;
+    };
+    auto data = std::make_shared<checkpoint_data_t>();
+
+    data->functions.emplace_back("density", density_.rho().hdf5_slab());
+    for (int j = 0; j < ctx_.num_mag_dims(); j++) {
+        data->functions.emplace_back("magnetization/" + std::to_string(j), density_.magnetization(j).hdf5_slab());
+    }
+    data->functions.emplace_back("effective_potential", potential_.effective_potential().hdf5_slab());
+    for (int j = 0; j < ctx_.num_mag_dims(); j++) {
+        data->functions.emplace_back("effective_magnetic_field/" + std::to_string(j),
+                                     potential_.effective_magnetic_field(j).hdf5_slab());
+    }
+
+    int rank         = ctx_.comm().rank();
+    int num_ranks    = ctx_.comm().size();
+    int num_mag_dims = ctx_.num_mag_dims();
+
+    if (rank == 0 && !ctx_.full_potential()) {
+        for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+            auto& d = unit_cell_.atom(ia).d_mtrx();
+            data->d_mtrx.emplace_back(d.at(memory_t::host), d.at(memory_t::host) + d.size());
+        }
+    }
+
+    int gen = checkpoint_next_gen_++;
+
+    auto fname = checkpoint_file_name(checkpoint_generation_prefix(ctx_.control().checkpoint_prefix_, gen), rank);
+
+    if (!checkpoint_writer_) {
+        checkpoint_writer_ = std::unique_ptr<Checkpoint_writer>(
+            new Checkpoint_writer(ctx_.control().checkpoint_max_in_flight_));
+    }
+
+    /* each generation is written to a new set of files, so the previous checkpoint stays valid until the new
+       one is complete on all ranks */
+    int job = checkpoint_writer_->submit([=]()
+    {
+        auto tmp_name = fname + ".tmp";
+        {
+            HDF5_tree fout(tmp_name, hdf5_access_t::truncate);
+            fout.write("generation", gen);
+            fout.write("iteration", iter__);
+            fout.write("num_slabs", num_ranks);
+            for (auto name : {"density", "magnetization", "effective_potential", "effective_magnetic_field"}) {
+                fout.create_node(name);
+            }
+            for (int j = 0; j < num_mag_dims; j++) {
+                fout["magnetization"].create_node(j);
+                fout["effective_magnetic_field"].create_node(j);
+            }
+            for (auto& f : data->functions) {
+                auto node = fout[f.first];
+                if (rank == 0) {
+                    node.write("num_slabs", num_ranks);
+                    if (f.second.f_mt.size()) {
+                        node.write("f_mt", f.second.f_mt);
+                    }
+                }
+                Periodic_function<double>::write_hdf5_slab(node.create_node("slabs").create_node(rank), f.second);
+            }
+            if (data->d_mtrx.size()) {
+                auto atoms = fout.create_node("unit_cell").create_node("atoms");
+                for (int ia = 0; ia < static_cast<int>(data->d_mtrx.size()); ia++) {
+                    atoms.create_node(ia).write("D_operator", data->d_mtrx[ia]);
+                }
+            }
+        }
+        if (std::rename(tmp_name.c_str(), fname.c_str())) {
+            throw std::runtime_error("failed to rename " + tmp_name);
+        }
+    });
+    checkpoint_generations_.push_back({gen, iter__, num_ranks, job});
+
+    publish_checkpoints();
+}
+
+inline void DFT_ground_state::publish_checkpoints(bool wait__)
+{
+    auto& comm   = ctx_.comm();
+    auto& prefix = ctx_.control().checkpoint_prefix_;
+
+    if (wait__) {
+        checkpoint_writer_->wait();
+    }
+
+    /* jobs are executed in the order of submission; find the newest generation finished by all ranks */
+    int num_done = checkpoint_writer_->num_done();
+    int gen{-1};
+    for (auto& g : checkpoint_generations_) {
+        if (g[3] < num_done) {
+            gen = g[0];
+        }
+    }
+    comm.allreduce<int, mpi_op_t::min>(&gen, 1);
+
+    /* HDF5 is not required to be thread-safe, so the marker is written by the I/O thread as well */
+    if (gen > checkpoint_marked_gen_) {
+        checkpoint_marked_gen_ = gen;
+        if (comm.rank() == 0) {
+            auto g = std::find_if(checkpoint_generations_.begin(), checkpoint_generations_.end(),
+                                  [gen](std::array<int, 4> const& e) { return e[0] == gen; });
+            int iter      = (*g)[1];
+            int num_slabs = (*g)[2];
+            auto name     = checkpoint_marker_name(prefix);
+            checkpoint_marker_job_ = checkpoint_writer_->submit([=]()
+            {
+                {
+                    HDF5_tree fout(name + ".tmp", hdf5_access_t::truncate);
+                    fout.write("generation", gen);
+                    fout.write("iteration", iter);
+                    fout.write("num_slabs", num_slabs);
+                }
+                if (std::rename((name + ".tmp").c_str(), name.c_str())) {
+                    throw std::runtime_error("failed to rename " + name + ".tmp");
+                }
+            }, false);
+        }
+    }
+    if (wait__) {
+        checkpoint_writer_->wait();
+    }
+
+    /* generation referenced by the marker on disk */
+    int published = checkpoint_published_gen_;
+    if (comm.rank() == 0 && checkpoint_marker_job_ >= 0 && checkpoint_marker_job_ < checkpoint_writer_->num_done()) {
+        published = checkpoint_marked_gen_;
+    }
+    comm.bcast(&published, 1, 0);
+
+    /* older generations are removed only after the marker points to a newer one */
+    while (checkpoint_generations_.front()[0] < published) {
+        auto& g = checkpoint_generations_.front();
+        for (int r = comm.rank(); r < g[2]; r += comm.size()) {
+            std::remove(checkpoint_file_name(checkpoint_generation_prefix(prefix, g[0]), r).c_str());
+        }
+        checkpoint_generations_.pop_front();
+    }
+    checkpoint_published_gen_ = published;
+}
+
+inline json DFT_ground_state::scf_telemetry_record(int iter__, std::vector<double> const& times__, double rms__,
+                                                   double etot__, double de__) const
+{
+    auto& comm = ctx_.comm();
+
+    std::vector<double> tmax(times__);
+    std::vector<double> tavg(times__);
+    comm.allreduce<double, mpi_op_t::max>(tmax);
+    comm.allreduce(tavg);
+
+    json time;
+    json imbalance;
+    const char* phases[] = {"band", "density", "mixer", "potential", "total"};
+    for (int i = 0; i < 5; i++) {
+        tavg[i] /= comm.size();
+        time[phases[i]]      = tmax[i];
+        imbalance[phases[i]] = (tavg[i] > 0) ? tmax[i] / tavg[i] : 1.0;
+    }
+
+    /* number of iterative solver steps for each k-point */
+    std::vector<int> num_diag_iter(kset_.num_kpoints(), 0);
+    for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+        int ik            = kset_.spl_num_kpoints(ikloc);
+        num_diag_iter[ik] = kset_[ik]->num_diag_iter();
+    }
+    kset_.comm().allreduce(num_diag_iter);
+
+    size_t VmHWM, VmRSS;
+    utils::get_proc_status(&VmHWM, &VmRSS);
+    double hwm = static_cast<double>(VmHWM) / (1 << 20);
+    comm.allreduce<double, mpi_op_t::max>(&hwm, 1);
+
+    json dict;
+    dict["iteration"]     = iter__;
+    dict["time"]          = time;
+    dict["imbalance"]     = imbalance;
+    dict["num_diag_iter"] = num_diag_iter;
+    dict["rms"]           = rms__;
+    dict["energy"]        = etot__;
+    dict["energy_change"] = de__;
+    dict["fermi_energy"]  = kset_.energy_fermi();
+    dict["memory_hwm_mb"] = hwm;
+    return dict;
+}
+
+inline int DFT_ground_state::load_checkpoint()
+{
+    PROFILE("sirius::DFT_ground_state::load_checkpoint");
+
+    auto& prefix = ctx_.control().checkpoint_prefix_;
+
+    /* the marker file points to the newest generation written by all ranks */
+    int gen, iter, num_slabs;
+    {
+        HDF5_tree fin(checkpoint_marker_name(prefix), hdf5_access_t::read_only);
+        fin.read("generation", &gen, 1);
+        fin.read("iteration", &iter, 1);
+        fin.read("num_slabs", &num_slabs, 1);
+    }
+
+    density_.load_checkpoint(checkpoint_generation_prefix(prefix, gen));
+    potential_.load_checkpoint(checkpoint_generation_prefix(prefix, gen));
+
+    /* new checkpoints continue the numbering; the loaded generation is removed when a newer one is complete */
+    if (!checkpoint_writer_) {
+        checkpoint_generations_.clear();
+        checkpoint_generations_.push_back({gen, iter, num_slabs, -1});
+        checkpoint_marked_gen_    = gen;
+        checkpoint_published_gen_ = gen;
+        checkpoint_next_gen_      = gen + 1;
+    }
+
+    return iter;
+}
+
+inline void DFT_ground_state::save_ionic_step()
+{
+    PROFILE("sirius::DFT_ground_state::save_ionic_step");
+
+    auto& inp = ctx_.parameters_input();
+
+    if (inp.density_extrapolation_ != "none") {
+        /* phase factors of the context still correspond to the positions of the converged step */
+        auto rho_at = ctx_.make_periodic_function<index_domain_t::local>([&](int iat, double g)
+                                                                         {
+                                                                             return ctx_.ps_rho_ri().value<int>(iat, g);
+                                                                         });
+        mdarray<double_complex, 1> drho(ctx_.gvec().count());
+        for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+            drho[igloc] = density_.rho().f_pw_local(igloc) - rho_at[igloc];
+        }
+        drho_hist_.push_front(std::move(drho));
+        size_t n = (inp.density_extrapolation_ == "atomic") ? 1 : ((inp.density_extrapolation_ == "first_order") ? 2 : 3);
+        while (drho_hist_.size() > n) {
+            drho_hist_.pop_back();
+        }
+    }
+
+    if (inp.wf_extrapolation_ != "none") {
+        std::map<int, std::unique_ptr<Wave_functions>> psi;
+        for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+            int ik   = kset_.spl_num_kpoints(ikloc);
+            auto* kp = kset_[ik];
+            psi[ik]  = std::unique_ptr<Wave_functions>(
+                new Wave_functions(kp->gkvec_partition(), ctx_.num_bands(), memory_t::host, ctx_.num_spins()));
+            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                psi[ik]->copy_from(device_t::CPU, ctx_.num_bands(), kp->spinor_wave_functions(), ispn, 0, ispn, 0);
+            }
+        }
+        /* drop the history of k-points which are no longer stored on this rank */
+        for (auto& e : psi_hist_) {
+            for (auto it = e.begin(); it != e.end();) {
+                if (psi.count(it->first)) {
+                    it++;
+                } else {
+                    it = e.erase(it);
+                }
+            }
+        }
+        psi_hist_.push_front(std::move(psi));
+        size_t n = (inp.wf_extrapolation_ == "first_order") ? 2 : 3;
+        while (psi_hist_.size() > n) {
+            psi_hist_.pop_back();
+        }
+    }
+}
+
+inline void DFT_ground_state::extrapolate_ionic_step()
+{
+    PROFILE("sirius::DFT_ground_state::extrapolate_ionic_step");
+
+    auto& inp = ctx_.parameters_input();
+
+    positions_hist_.push_front(atom_positions());
+    while (positions_hist_.size() > 4) {
+        positions_hist_.pop_back();
+    }
+
+    if (inp.density_extrapolation_ != "none") {
+        int order = (inp.density_extrapolation_ == "atomic") ? 0 : ((inp.density_extrapolation_ == "first_order") ? 1 : 2);
+        order = std::min(order, static_cast<int>(drho_hist_.size()) - 1);
+        auto ab = extrapolation_coefficients(order);
+
+        /* superposition of atomic densities at new positions */
+        auto rho_at = ctx_.make_periodic_function<index_domain_t::local>([&](int iat, double g)
+                                                                         {
+                                                                             return ctx_.ps_rho_ri().value<int>(iat, g);
+                                                                         });
+        #pragma omp parallel for schedule(static)
+        for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+            /* rho(t+dt) = rho_at(t+dt) + drho(t) + a * (drho(t) - drho(t-dt)) + b * (drho(t-dt) - drho(t-2dt)) */
+            auto z = rho_at[igloc] + drho_hist_[0][igloc];
+            if (order >= 1) {
+                z += ab[0] * (drho_hist_[0][igloc] - drho_hist_[1][igloc]);
+            }
+            if (order == 2) {
+                z += ab[1] * (drho_hist_[1][igloc] - drho_hist_[2][igloc]);
+            }
+            density_.rho().f_pw_local(igloc) = z;
+        }
+        density_.rho().fft_transform(1);
+    }
+
+    if (inp.wf_extrapolation_ != "none") {
+        int order = (inp.wf_extrapolation_ == "first_order") ? 1 : 2;
+        order = std::min(order, static_cast<int>(psi_hist_.size()) - 1);
+        if (order > 0) {
+            auto ab = extrapolation_coefficients(order);
+            if (ctx_.gamma_point()) {
+                extrapolate_wave_functions<double>(ab);
+            } else {
+                extrapolate_wave_functions<double_complex>(ab);
+            }
+        }
+    }
+
+    /* effective potential for the new positions and extrapolated density */
+    potential_.generate(density_);
+    if (ctx_.use_symmetry()) {
+        potential_.symmetrize();
+    }
+    potential_.fft_transform(1);
+}
+
+template <typename T>
+inline void DFT_ground_state::extrapolate_wave_functions(std::array<double, 2> ab__)
+{
+    PROFILE("sirius::DFT_ground_state::extrapolate_wave_functions");
+
+    int nbnd = ctx_.num_bands();
+    bool nc_mag = (ctx_.num_mag_dims() == 3);
+
+    auto solver = Eigensolver_factory(ev_solver_t::lapack);
+
+    dmatrix<T> ovlp(nbnd, nbnd);
+    dmatrix<T> a(nbnd, nbnd);
+    dmatrix<T> z(nbnd, nbnd);
+    dmatrix<T> u(nbnd, nbnd);
+    std::vector<double> eval(nbnd);
+
+    /* psi(t+dt) = (1 + a) psi(t) + (b - a) psi(t-dt) U1 - b psi(t-2dt) U2 */
+    double c[] = {ab__[1] - ab__[0], -ab__[1]};
+
+    for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+        int ik = kset_.spl_num_kpoints(ikloc);
+        /* k-point could have been moved to this rank after the previous step */
+        bool has_hist{true};
+        for (auto& e : psi_hist_) {
+            has_hist &= (e.count(ik) != 0);
+        }
+        if (!has_hist) {
+            continue;
+        }
+        auto& psi  = kset_[ik]->spinor_wave_functions();
+        auto& psi0 = *psi_hist_[0][ik];
+
+        for (int ispin_step = 0; ispin_step < ctx_.num_spin_dims(); ispin_step++) {
+            int ispn = nc_mag ? 2 : ispin_step;
+
+            for (int i = 1; i < static_cast<int>(psi_hist_.size()); i++) {
+                auto& phi = *psi_hist_[i][ik];
+                /* the band index and phase of the previous wave-functions are not related to the current ones;
+                   find the unitary transformation U that best maps phi onto psi(t): U = S (S^H S)^{-1/2} */
+                inner(memory_t::host, linalg_t::blas, ispn, phi, 0, nbnd, psi0, 0, nbnd, ovlp, 0, 0);
+                linalg<CPU>::gemm(2, 0, nbnd, nbnd, nbnd, ovlp.at(memory_t::host), ovlp.ld(), ovlp.at(memory_t::host),
+                                  ovlp.ld(), a.at(memory_t::host), a.ld());
+                solver->solve(nbnd, a, eval.data(), z);
+                for (int j = 0; j < nbnd; j++) {
+                    double f = (eval[j] > 1e-12) ? 1.0 / std::sqrt(eval[j]) : 0.0;
+                    for (int k = 0; k < nbnd; k++) {
+                        a(k, j) = z(k, j) * f;
+                    }
+                }
+                linalg<CPU>::gemm(0, 2, nbnd, nbnd, nbnd, a.at(memory_t::host), a.ld(), z.at(memory_t::host), z.ld(),
+                                  u.at(memory_t::host), u.ld());
+                linalg<CPU>::gemm(0, 0, nbnd, nbnd, nbnd, ovlp.at(memory_t::host), ovlp.ld(), u.at(memory_t::host),
+                                  u.ld(), a.at(memory_t::host), a.ld());
+                /* psi is equal to psi(t) at this point and it is scaled by (1 + a) in the first pass */
+                transform<T>(memory_t::host, linalg_t::blas, ispn, c[i - 1], {&phi}, 0, nbnd, a, 0, 0,
+                             (i == 1) ? 1 + ab__[0] : 1.0, {&psi}, 0, nbnd);
+            }
+        }
+    }
+}
+
 inline void DFT_ground_state::print_info()
 {
     double evalsum1 = kset_.valence_eval_sum();
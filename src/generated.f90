@@ -652,6 +652,27 @@ if (present(save__)) save___ptr = C_LOC(save__)
 call sirius_find_ground_state_aux(gs_handler,save___ptr)
 end subroutine sirius_find_ground_state
 
+!> @brief Set a function which receives the SCF telemetry.
+!> @details The function is called on rank 0 after each SCF iteration with a null-terminated string which contains the
+!> JSON record of the iteration.
+!> @param [in] gs_handler Ground-state handler.
+!> @param [in] callback Function of one argument (JSON record as C string).
+subroutine sirius_set_scf_telemetry_callback(gs_handler,callback)
+implicit none
+type(C_PTR), intent(in) :: gs_handler
+type(C_FUNPTR), intent(in) :: callback
+interface
+subroutine sirius_set_scf_telemetry_callback_aux(gs_handler,callback)&
+&bind(C, name="sirius_set_scf_telemetry_callback")
+use, intrinsic :: ISO_C_BINDING
+type(C_PTR), intent(in) :: gs_handler
+type(C_FUNPTR), intent(in) :: callback
+end subroutine
+end interface
+
+call sirius_set_scf_telemetry_callback_aux(gs_handler,callback)
+end subroutine sirius_set_scf_telemetry_callback
+
 !> @brief Update a ground state object after change of atomic coordinates or lattice vectors.
 !> @param [in] gs_handler Ground-state handler.
 subroutine sirius_update_ground_state(gs_handler)
@@ -668,6 +689,25 @@ end interface
 call sirius_update_ground_state_aux(gs_handler)
 end subroutine sirius_update_ground_state
 
+!> @brief Move atoms and update a ground state object.
+!> @param [in] gs_handler Ground-state handler.
+!> @param [in] positions New atomic positions in lattice coordinates (3 x num_atoms).
+subroutine sirius_update_atomic_positions(gs_handler,positions)
+implicit none
+type(C_PTR), intent(in) :: gs_handler
+real(C_DOUBLE), intent(in) :: positions
+interface
+subroutine sirius_update_atomic_positions_aux(gs_handler,positions)&
+&bind(C, name="sirius_update_atomic_positions")
+use, intrinsic :: ISO_C_BINDING
+type(C_PTR), intent(in) :: gs_handler
+real(C_DOUBLE), intent(in) :: positions
+end subroutine
+end interface
+
+call sirius_update_atomic_positions_aux(gs_handler,positions)
+end subroutine sirius_update_atomic_positions
+
 !> @brief Add new atom type to the unit cell.
 !> @param [in] handler Simulation context handler.
 !> @param [in] label Atom type unique label.
@@ -1532,6 +1572,28 @@ end interface
 call sirius_get_stress_tensor_aux(handler,label,stress_tensor)
 end subroutine sirius_get_stress_tensor
 
+!> @brief Compute total forces and total stress tensor.
+!> @param [in] handler DFT ground state handler.
+!> @param [out] forces Total force for each atom.
+!> @param [out] stress_tensor Total stress tensor.
+subroutine sirius_get_forces_and_stress(handler,forces,stress_tensor)
+implicit none
+type(C_PTR), intent(in) :: handler
+real(C_DOUBLE), intent(out) :: forces
+real(C_DOUBLE), intent(out) :: stress_tensor
+interface
+subroutine sirius_get_forces_and_stress_aux(handler,forces,stress_tensor)&
+&bind(C, name="sirius_get_forces_and_stress")
+use, intrinsic :: ISO_C_BINDING
+type(C_PTR), intent(in) :: handler
+real(C_DOUBLE), intent(out) :: forces
+real(C_DOUBLE), intent(out) :: stress_tensor
+end subroutine
+end interface
+
+call sirius_get_forces_and_stress_aux(handler,forces,stress_tensor)
+end subroutine sirius_get_forces_and_stress
+
 !> @brief Get the number of beta-projectors for an atom type.
 !> @param [in] handler Simulation context handler.
 !> @param [in] label Atom type label.
@@ -264,6 +264,11 @@ struct Iterative_solver_input
      *  as they are and solve generalized eigen-value problem. */
     bool orthogonalize_{true};
 
+    /// Lock converged bands in the Davidson solver.
+    /** The lowest converged bands are removed from the subspace on each restart and the new basis functions are
+     *  kept orthogonal to them. Only used with orthogonalize = true. */
+    bool locking_{false};
+
     /// Initialize eigen-values with previous (old) values.
     bool init_eval_old_{true};
 
@@ -272,6 +277,24 @@ struct Iterative_solver_input
      *  the randomized wave functions. */
     std::string init_subspace_{"lcao"};
 
+    /// Method of orthonormalization of the new block of basis functions.
+    /** It can be "cholesky" (single Cholesky factorization of the overlap matrix), "cholesky_qr2" (two passes with
+     *  the shifted factorization for ill-conditioned blocks) or "mixed" (first pass in single precision). */
+    std::string orthogonalization_method_{"cholesky"};
+
+    /// Maximum degree of the Chebyshev filter.
+    /** The actual degree is chosen at each step from the spectral bounds and the largest residual. */
+    int chebyshev_max_degree_{16};
+
+    /// Number of Lanczos steps to estimate the upper bound of the spectrum in the Chebyshev solver.
+    int chebyshev_lanczos_steps_{8};
+
+    /// Maximum number of DIIS steps per band in the RMM-DIIS solver.
+    int rmm_diis_num_steps_{4};
+
+    /// Number of bands processed together in the RMM-DIIS solver (0 for all bands).
+    int rmm_diis_block_size_{64};
+
     void read(json const& parser)
     {
         if (parser.count("iterative_solver")) {
@@ -286,9 +309,17 @@ struct Iterative_solver_input
             min_num_res_            = section.value("min_num_res", min_num_res_);
             num_singular_           = section.value("num_singular", num_singular_);
             orthogonalize_          = section.value("orthogonalize", orthogonalize_);
+            locking_                = section.value("locking", locking_);
             init_eval_old_          = section.value("init_eval_old", init_eval_old_);
             init_subspace_          = section.value("init_subspace", init_subspace_);
             std::transform(init_subspace_.begin(), init_subspace_.end(), init_subspace_.begin(), ::tolower);
+            orthogonalization_method_ = section.value("orthogonalization_method", orthogonalization_method_);
+            std::transform(orthogonalization_method_.begin(), orthogonalization_method_.end(),
+                           orthogonalization_method_.begin(), ::tolower);
+            chebyshev_max_degree_    = section.value("chebyshev_max_degree", chebyshev_max_degree_);
+            chebyshev_lanczos_steps_ = section.value("chebyshev_lanczos_steps", chebyshev_lanczos_steps_);
+            rmm_diis_num_steps_      = section.value("rmm_diis_num_steps", rmm_diis_num_steps_);
+            rmm_diis_block_size_     = section.value("rmm_diis_block_size", rmm_diis_block_size_);
         }
     }
 };
@@ -305,6 +336,7 @@ struct Iterative_solver_input
  *      "electronic_structure_method" : (string) electronic structure method
  *      "processing_unit" : (string) primary processing unit
  *      "fft_mode" : (string) serial or parallel FFT
+ *      "fft_a2a_num_chunks" : (int) number of chunks in the pipelined all-to-all of the parallel FFT
  *    }
  *  \endcode
  *  Parameters of the control input sections do not in general change the numerics, but instead control how the
@@ -390,6 +422,37 @@ struct Control_input
     /// Number of atoms in the beta-projectors chunk.
     int beta_chunk_size_{256};
 
+    /// Number of chunks of z-columns in the pipelined all-to-all exchange of the parallel FFT.
+    /** The exchange of one chunk is overlapped with the 1D transforms of the next one. Value of 1 switches
+     *  the pipelining off. */
+    int fft_a2a_num_chunks_{4};
+
+    /// Distribution of k-points between MPI ranks.
+    /** Possible values are: "block" (equal number of k-points), "cost" (balance the estimated cost of each
+     *  k-point) and "dynamic" (as "cost", but rebalance between SCF iterations using the measured time). */
+    std::string kpoint_distribution_{"block"};
+
+    /// Run short timed trials of the MPI grid layout, FFT mode and ScaLAPACK block size during initialization.
+    /** The number of MPI ranks in a band group (product of mpi_grid_dims) is kept; the fastest layout of this
+     *  group replaces the input values of mpi_grid_dims, fft_mode, fft_a2a_num_chunks and cyclic_block_size. */
+    bool autotune_{false};
+
+    /// Write a checkpoint every checkpoint_period SCF iterations (0 switches checkpointing off).
+    /** Each rank writes its part of the density and potential to the file checkpoint_prefix.<generation>.<rank>.h5
+     *  in a background thread, while the SCF loop continues. The file checkpoint_prefix.h5 points to the newest
+     *  generation which is complete on all ranks. */
+    int checkpoint_period_{0};
+
+    /// Prefix of the checkpoint file names.
+    std::string checkpoint_prefix_{"checkpoint"};
+
+    /// Maximum number of checkpoints which are staged in memory and not yet written.
+    int checkpoint_max_in_flight_{1};
+
+    /// Name of the file to which the SCF telemetry records are appended (one JSON object per line).
+    /** Empty string switches the output off. */
+    std::string scf_telemetry_file_{""};
+
     void read(json const& parser)
     {
         if (parser.count("control")) {
@@ -416,8 +479,16 @@ struct Control_input
             print_neighbors_     = section.value("print_neighbors", print_neighbors_);
             memory_usage_        = section.value("memory_usage", memory_usage_);
             beta_chunk_size_     = section.value("beta_chunk_size", beta_chunk_size_);
-
-            auto strings = {&std_evp_solver_name_, &gen_evp_solver_name_, &fft_mode_, &processing_unit_, &memory_usage_};
+            fft_a2a_num_chunks_  = section.value("fft_a2a_num_chunks", fft_a2a_num_chunks_);
+            kpoint_distribution_ = section.value("kpoint_distribution", kpoint_distribution_);
+            autotune_            = section.value("autotune", autotune_);
+            checkpoint_period_   = section.value("checkpoint_period", checkpoint_period_);
+            checkpoint_prefix_   = section.value("checkpoint_prefix", checkpoint_prefix_);
+            checkpoint_max_in_flight_ = section.value("checkpoint_max_in_flight", checkpoint_max_in_flight_);
+            scf_telemetry_file_  = section.value("scf_telemetry_file", scf_telemetry_file_);
+
+            auto strings = {&std_evp_solver_name_, &gen_evp_solver_name_, &fft_mode_, &processing_unit_, &memory_usage_,
+                            &kpoint_distribution_};
             for (auto s : strings) {
                 std::transform(s->begin(), s->end(), s->begin(), ::tolower);
             }
@@ -427,6 +498,11 @@ struct Control_input
             if (std::find(kw.begin(), kw.end(), memory_usage_) == kw.end()) {
                 TERMINATE("wrong memory_usage input");
             }
+
+            kw = {"block", "cost", "dynamic"};
+            if (std::find(kw.begin(), kw.end(), kpoint_distribution_) == kw.end()) {
+                TERMINATE("wrong kpoint_distribution input");
+            }
         }
     }
 };
@@ -523,6 +599,14 @@ struct Parameters_input
     /// Reduction of the auxiliary magnetic field at each SCF step.
     double reduce_aux_bf_{0.0};
 
+    /// Extrapolation of the charge density between ionic steps.
+    /** Possible values are: "none", "atomic" (correction by the superposition of atomic densities), "first_order"
+     *  and "second_order". */
+    std::string density_extrapolation_{"none"};
+
+    /// Extrapolation of the wave-functions between ionic steps ("none", "first_order" or "second_order").
+    std::string wf_extrapolation_{"none"};
+
     void read(json const& parser)
     {
         if (parser.count("parameters")) {
@@ -571,6 +655,20 @@ struct Parameters_input
             nn_radius_      = parser["parameters"].value("nn_radius", nn_radius_);
             reduce_aux_bf_  = parser["parameters"].value("reduce_aux_bf", reduce_aux_bf_);
 
+            density_extrapolation_ = parser["parameters"].value("density_extrapolation", density_extrapolation_);
+            wf_extrapolation_      = parser["parameters"].value("wf_extrapolation", wf_extrapolation_);
+            for (auto s : {&density_extrapolation_, &wf_extrapolation_}) {
+                std::transform(s->begin(), s->end(), s->begin(), ::tolower);
+            }
+            std::list<std::string> kw = {"none", "atomic", "first_order", "second_order"};
+            if (std::find(kw.begin(), kw.end(), density_extrapolation_) == kw.end()) {
+                TERMINATE("wrong density_extrapolation input");
+            }
+            if (wf_extrapolation_ == "atomic" ||
+                std::find(kw.begin(), kw.end(), wf_extrapolation_) == kw.end()) {
+                TERMINATE("wrong wf_extrapolation input");
+            }
+
             if (parser["parameters"].count("spin_orbit")) {
                 so_correction_ = parser["parameters"].value("spin_orbit", so_correction_);
 
@@ -601,6 +699,8 @@ struct Settings_input
     double itsol_tol_min_{1e-13};
     double auto_enu_tol_{0};
     std::string radial_grid_{"exponential, 1.0"};
+    /// Bands with the weighted occupancy below this value are excluded from density, force and stress calculation.
+    double min_occupancy_{1e-14};
 
     void read(json const& parser)
     {
@@ -614,6 +714,7 @@ struct Settings_input
             itsol_tol_min_    = parser["settings"].value("itsol_tol_min", itsol_tol_min_);
             auto_enu_tol_     = parser["settings"].value("auto_enu_tol", auto_enu_tol_);
             radial_grid_      = parser["settings"].value("radial_grid", radial_grid_);
+            min_occupancy_    = parser["settings"].value("min_occupancy", min_occupancy_);
         }
     }
 };
@@ -28,6 +28,10 @@
 #include "simulation_context.hpp"
 #include "spheric_function.hpp"
 #include "smooth_periodic_function.hpp"
+#include "checkpoint_writer.hpp"
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
 
 namespace sirius {
 
@@ -64,6 +68,19 @@ class Periodic_function : public Smooth_periodic_function<T>
 
     Gvec const& gvec_;
 
+    /// Hash key of the G-vector with the given Miller indices.
+    static inline long gvec_key(int x__, int y__, int z__)
+    {
+        return ((static_cast<long>(x__) + (1 << 20)) << 42) + ((static_cast<long>(y__) + (1 << 20)) << 21) +
+               (static_cast<long>(z__) + (1 << 20));
+    }
+
+    /// Hash key of the z-column with the given x and y Miller indices.
+    static inline long zcol_key(int x__, int y__)
+    {
+        return gvec_key(x__, y__, 0);
+    }
+
     /// Size of the muffin-tin functions angular domain size.
     int angular_domain_size_;
 
@@ -236,37 +253,114 @@ class Periodic_function : public Smooth_periodic_function<T>
         }
     }
 
-    /** \todo write and read distributed functions */
-    void hdf5_write(std::string storage_file_name__, std::string path__)
+    /// Local part of the function, staged for the output to the HDF5 file.
+    struct hdf5_slab_t
     {
-        auto v = this->gather_f_pw();
-        if (ctx_.comm().rank() == 0) {
-            HDF5_tree fout(storage_file_name, hdf5_access_t::read_write);
-            fout[path__].write("f_pw", reinterpret_cast<double*>(v.data()), static_cast<int>(v.size() * 2));
-            if (ctx_.full_potential()) {
-                fout[path__].write("f_mt", f_mt_);
+        /// Miller indices of the local G-vectors.
+        std::vector<int> gvec;
+        /// x and y Miller indices of the local z-columns.
+        std::vector<int> zcol;
+        /// Local plane-wave coefficients.
+        std::vector<double_complex> f_pw;
+        /// Muffin-tin part of the function (only on rank 0 of the full-potential calculation).
+        std::vector<T> f_mt;
+    };
+
+    /// Make a copy of the local plane-wave coefficients together with the Miller indices of the local G-vectors.
+    hdf5_slab_t hdf5_slab() const
+    {
+        hdf5_slab_t slab;
+        slab.gvec.resize(3 * gvec_.count());
+        slab.f_pw.resize(gvec_.count());
+        std::unordered_set<long> zcol_set;
+        for (int igloc = 0; igloc < gvec_.count(); igloc++) {
+            auto G = gvec_.gvec(gvec_.offset() + igloc);
+            for (int x : {0, 1, 2}) {
+                slab.gvec[3 * igloc + x] = G[x];
             }
+            if (zcol_set.insert(zcol_key(G[0], G[1])).second) {
+                slab.zcol.push_back(G[0]);
+                slab.zcol.push_back(G[1]);
+            }
+            slab.f_pw[igloc] = this->f_pw_local_[igloc];
+        }
+        if (ctx_.full_potential() && gvec_.comm().rank() == 0) {
+            slab.f_mt = std::vector<T>(f_mt_.at(memory_t::host), f_mt_.at(memory_t::host) + f_mt_.size());
         }
+        return slab;
     }
 
-    void hdf5_read(HDF5_tree h5f__, mdarray<int, 2>& gvec__)
+    /// Write the slab to the node of HDF5 file.
+    static void write_hdf5_slab(HDF5_tree node__, hdf5_slab_t const& slab__)
     {
-        std::vector<double_complex> v(gvec_.num_gvec());
-        h5f__.read("f_pw", reinterpret_cast<double*>(v.data()), static_cast<int>(v.size() * 2));
+        int ngv = static_cast<int>(slab__.f_pw.size());
+        node__.write("num_gvec", ngv);
+        node__.write("num_zcol", static_cast<int>(slab__.zcol.size() / 2));
+        if (ngv) {
+            node__.write("gvec", slab__.gvec.data(), 3 * ngv);
+            node__.write("zcol", slab__.zcol.data(), static_cast<int>(slab__.zcol.size()));
+            node__.write("f_pw", reinterpret_cast<double const*>(slab__.f_pw.data()), 2 * ngv);
+        }
+    }
 
-        std::map<vector3d<int>, int> local_gvec_mapping;
+    /// Write the function to the HDF5 file.
+    /** Each rank writes its own slab of plane-wave coefficients together with the Miller indices of the local
+     *  G-vectors and the list of local z-columns. The ranks write one after another, so no rank has to hold the
+     *  full array of coefficients. */
+    void hdf5_write(std::string storage_file_name__, std::string path__)
+    {
+        PROFILE("sirius::Periodic_function::hdf5_write");
 
-        for (int igloc = 0; igloc < gvec_.count(); igloc++) {
-            int  ig               = gvec_.offset() + igloc;
-            auto G                = gvec_.gvec(ig);
-            local_gvec_mapping[G] = igloc;
+        auto& comm = gvec_.comm();
+
+        auto slab = hdf5_slab();
+
+        for (int r = 0; r < comm.size(); r++) {
+            if (comm.rank() == r) {
+                HDF5_tree fout(storage_file_name__, hdf5_access_t::read_write);
+                if (r == 0) {
+                    fout[path__].write("num_slabs", comm.size());
+                    fout[path__].create_node("slabs");
+                    if (ctx_.full_potential()) {
+                        fout[path__].write("f_mt", f_mt_);
+                    }
+                }
+                write_hdf5_slab(fout[path__]["slabs"].create_node(r), slab);
+            }
+            comm.barrier();
         }
+    }
+
+    /// Read the function from the HDF5 file.
+    /** The local G-vectors are matched by their Miller indices, so the number of ranks can differ from the one
+     *  used to write the file. Only the slabs which contain the local z-columns are read. Files with the single
+     *  array of plane-wave coefficients in the order of gvec__ are also accepted; gvec__ is not used for the
+     *  files with slabs. */
+    void hdf5_read(HDF5_tree h5f__, mdarray<int, 2>& gvec__)
+    {
+        PROFILE("sirius::Periodic_function::hdf5_read");
 
-        for (int ig = 0; ig < gvec_.num_gvec(); ig++) {
-            vector3d<int> G(&gvec__(0, ig));
-            if (local_gvec_mapping.count(G) != 0) {
-                this->f_pw_local_[local_gvec_mapping[G]] = v[ig];
+        if (!h5f__.exist("num_slabs")) {
+            std::unordered_map<long, int> local_gvec_mapping;
+            for (int igloc = 0; igloc < gvec_.count(); igloc++) {
+                auto G = gvec_.gvec(gvec_.offset() + igloc);
+                local_gvec_mapping[gvec_key(G[0], G[1], G[2])] = igloc;
             }
+            std::vector<double_complex> v(gvec_.num_gvec());
+            h5f__.read("f_pw", reinterpret_cast<double*>(v.data()), static_cast<int>(v.size() * 2));
+            for (int ig = 0; ig < gvec_.num_gvec(); ig++) {
+                auto it = local_gvec_mapping.find(gvec_key(gvec__(0, ig), gvec__(1, ig), gvec__(2, ig)));
+                if (it != local_gvec_mapping.end()) {
+                    this->f_pw_local_[it->second] = v[ig];
+                }
+            }
+        } else {
+            int num_slabs;
+            h5f__.read("num_slabs", &num_slabs, 1);
+            hdf5_read_slabs(num_slabs, [&](int r, std::function<void(HDF5_tree)> read_slab)
+                                       {
+                                           read_slab(h5f__["slabs"][r]);
+                                       });
         }
 
         if (ctx_.full_potential()) {
@@ -274,6 +368,83 @@ class Periodic_function : public Smooth_periodic_function<T>
         }
     }
 
+    /// Read the function from the set of per-rank checkpoint files.
+    /** Slab r is stored in the file checkpoint_file_name(prefix__, r); the number of slabs and the muffin-tin part
+     *  are stored in the file of rank 0. */
+    void hdf5_read_checkpoint(std::string const& prefix__, std::string const& path__)
+    {
+        PROFILE("sirius::Periodic_function::hdf5_read_checkpoint");
+
+        int num_slabs;
+        {
+            HDF5_tree fin(checkpoint_file_name(prefix__, 0), hdf5_access_t::read_only);
+            fin[path__].read("num_slabs", &num_slabs, 1);
+            if (ctx_.full_potential()) {
+                fin[path__].read("f_mt", f_mt_);
+            }
+        }
+        hdf5_read_slabs(num_slabs, [&](int r, std::function<void(HDF5_tree)> read_slab)
+                                   {
+                                       HDF5_tree fin(checkpoint_file_name(prefix__, r), hdf5_access_t::read_only);
+                                       read_slab(fin[path__]["slabs"][r]);
+                                   });
+    }
+
+    /// Read the local plane-wave coefficients from the slabs.
+    /** The callback function opens the node of the slab r and passes it to the reader. */
+    void hdf5_read_slabs(int num_slabs__, std::function<void(int, std::function<void(HDF5_tree)>)> open_slab__)
+    {
+        /* hash table of local G-vectors */
+        std::unordered_map<long, int> local_gvec_mapping;
+        std::unordered_set<long> local_zcol;
+        for (int igloc = 0; igloc < gvec_.count(); igloc++) {
+            auto G = gvec_.gvec(gvec_.offset() + igloc);
+            local_gvec_mapping[gvec_key(G[0], G[1], G[2])] = igloc;
+            local_zcol.insert(zcol_key(G[0], G[1]));
+        }
+
+        int num_found{0};
+
+        auto read_slab = [&](HDF5_tree node)
+        {
+            int ngv, ncol;
+            node.read("num_gvec", &ngv, 1);
+            node.read("num_zcol", &ncol, 1);
+            if (!ngv) {
+                return;
+            }
+            /* check if this slab contains any of the local z-columns */
+            std::vector<int> zcol(2 * ncol);
+            node.read("zcol", zcol.data(), 2 * ncol);
+            bool found{false};
+            for (int i = 0; i < ncol && !found; i++) {
+                found = local_zcol.count(zcol_key(zcol[2 * i], zcol[2 * i + 1])) != 0;
+            }
+            if (!found) {
+                return;
+            }
+
+            std::vector<int> gv(3 * ngv);
+            std::vector<double_complex> v(ngv);
+            node.read("gvec", gv.data(), 3 * ngv);
+            node.read("f_pw", reinterpret_cast<double*>(v.data()), 2 * ngv);
+            for (int ig = 0; ig < ngv; ig++) {
+                auto it = local_gvec_mapping.find(gvec_key(gv[3 * ig], gv[3 * ig + 1], gv[3 * ig + 2]));
+                if (it != local_gvec_mapping.end()) {
+                    this->f_pw_local_[it->second] = v[ig];
+                    num_found++;
+                }
+            }
+        };
+
+        for (int r = 0; r < num_slabs__ && num_found < gvec_.count(); r++) {
+            open_slab__(r, read_slab);
+        }
+        if (num_found != gvec_.count()) {
+            TERMINATE("not all G-vectors are found in the HDF5 file");
+        }
+    }
+
     /// Set the global pointer to the muffin-tin part
     void set_mt_ptr(T* mt_ptr__)
     {
@@ -47,6 +47,11 @@ class Radial_integrals_base
     /// Array with integrals.
     mdarray<Spline<double>, N> values_;
 
+    /// Integrals of each atom type packed into a single set of splines.
+    /** Only the radial integrals which are looked up as a whole family for each G-vector (beta-projectors,
+        augmentation operator, atomic wave-functions) are packed. */
+    std::vector<Spline_set<double>> packed_values_;
+
   public:
     /// Constructor.
     Radial_integrals_base(Unit_cell const& unit_cell__, double qmax__, int np__)
@@ -54,6 +59,7 @@ class Radial_integrals_base
     {
         grid_q_ = Radial_grid_lin<double>(static_cast<int>(np__ * qmax__), 0, qmax__);
         spl_q_  = splindex<block>(grid_q_.num_points(), unit_cell_.comm().size(), unit_cell_.comm().rank());
+        packed_values_ = std::vector<Spline_set<double>>(unit_cell_.num_atom_types());
     }
 
     /// Get starting index iq and delta dq for the q-point on the linear grid.
@@ -88,6 +94,30 @@ class Radial_integrals_base
     {
         return grid_q_.num_points();
     }
+
+    /// Number of packed radial integrals of a given atom type.
+    inline int num_packed_values(int iat__) const
+    {
+        return packed_values_[iat__].num_splines();
+    }
+
+    /// Get all packed radial integrals of a given atom type at a single q-point.
+    /** Output buffer must hold at least num_packed_values(iat__) elements. No memory is allocated. */
+    inline void packed_values(int iat__, double q__, double* val__) const
+    {
+        auto idx = iqdq(q__);
+        packed_values_[iat__](idx.first, idx.second, val__);
+    }
+
+    /// Get all packed radial integrals of a given atom type at a set of q-points.
+    /** Output buffer has the dimensions (num_packed_values(iat__), nq__). */
+    inline void packed_values(int iat__, int nq__, double const* q__, double* val__) const
+    {
+        int n = num_packed_values(iat__);
+        for (int iq = 0; iq < nq__; iq++) {
+            packed_values(iat__, q__[iq], &val__[n * iq]);
+        }
+    }
 };
 
 /// Radial integrals of the atomic centered orbitals.
@@ -137,6 +167,11 @@ class Radial_integrals_atomic_wf : public Radial_integrals_base<2>
 
                 values_(i, iat).interpolate();
             }
+
+            packed_values_[iat] = Spline_set<double>(nwf, nq());
+            for (int i = 0; i < nwf; i++) {
+                packed_values_[iat].set(i, values_(i, iat));
+            }
         }
     }
 
@@ -163,11 +198,10 @@ class Radial_integrals_atomic_wf : public Radial_integrals_base<2>
     /// Get all values for a given atom type and q-point.
     inline mdarray<double, 1> values(int iat__, double q__) const
     {
-        auto idx        = iqdq(q__);
         auto& atom_type = unit_cell_.atom_type(iat__);
         mdarray<double, 1> val(atom_type.num_ps_atomic_wf());
-        for (int i = 0; i < atom_type.num_ps_atomic_wf(); i++) {
-            val(i) = values_(i, iat__)(idx.first, idx.second);
+        if (num_packed_values(iat__)) {
+            packed_values(iat__, q__, val.at(memory_t::host));
         }
         return std::move(val);
     }
@@ -241,6 +275,15 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
                     values_(idx, l, iat).interpolate();
                 }
             }
+
+            /* pack in the same order as the (idx, l) array returned by values() */
+            int nidx = nbrf * (nbrf + 1) / 2;
+            packed_values_[iat] = Spline_set<double>(nidx * (2 * lmax_beta + 1), nq());
+            for (int l = 0; l <= 2 * lmax_beta; l++) {
+                for (int idx = 0; idx < nidx; idx++) {
+                    packed_values_[iat].set(idx + l * nidx, values_(idx, l, iat));
+                }
+            }
         }
     }
 
@@ -258,17 +301,15 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
 
     inline mdarray<double, 2> values(int iat__, double q__) const
     {
-        auto idx = iqdq(q__);
-
         auto& atom_type = unit_cell_.atom_type(iat__);
         int lmax        = atom_type.indexr().lmax();
         int nbrf        = atom_type.mt_radial_basis_size();
 
         mdarray<double, 2> val(nbrf * (nbrf + 1) / 2, 2 * lmax + 1);
-        for (int l = 0; l <= 2 * lmax; l++) {
-            for (int i = 0; i < nbrf * (nbrf + 1) / 2; i++) {
-                val(i, l) = values_(i, l, iat__)(idx.first, idx.second);
-            }
+        if (num_packed_values(iat__)) {
+            packed_values(iat__, q__, val.at(memory_t::host));
+        } else {
+            val.zero();
         }
         return std::move(val);
     }
@@ -409,6 +450,11 @@ class Radial_integrals_beta : public Radial_integrals_base<2>
                 unit_cell_.comm().allgather(&values_(idxrf, iat)(0), spl_q_.global_offset(), spl_q_.local_size());
                 values_(idxrf, iat).interpolate();
             }
+
+            packed_values_[iat] = Spline_set<double>(nrb, nq());
+            for (int idxrf = 0; idxrf < nrb; idxrf++) {
+                packed_values_[iat].set(idxrf, values_(idxrf, iat));
+            }
         }
     }
 
@@ -424,11 +470,11 @@ class Radial_integrals_beta : public Radial_integrals_base<2>
     /// Get all values for a given atom type and q-point.
     inline mdarray<double, 1> values(int iat__, double q__) const
     {
-        auto idx        = iqdq(q__);
         auto& atom_type = unit_cell_.atom_type(iat__);
         mdarray<double, 1> val(atom_type.mt_radial_basis_size());
-        for (int i = 0; i < atom_type.mt_radial_basis_size(); i++) {
-            val(i) = values_(i, iat__)(idx.first, idx.second);
+        val.zero();
+        if (num_packed_values(iat__)) {
+            packed_values(iat__, q__, val.at(memory_t::host));
         }
         return std::move(val);
     }
@@ -146,6 +146,9 @@ class Simulation_context : public Simulation_parameters
     /// Lattice coordinats of G-vectors in a GPU-friendly ordering.
     mdarray<int, 2> gvec_coord_;
 
+    /// Number of calls to update().
+    int num_updates_{0};
+
     /// Radial integrals of beta-projectors.
     std::unique_ptr<Radial_integrals_beta<false>> beta_ri_;
 
@@ -215,6 +218,9 @@ class Simulation_context : public Simulation_parameters
     /// True if the context is already initialized.
     bool initialized_{false};
 
+    /// Decision and timings of the runtime auto-tuner.
+    json autotune_result_;
+
     /// Initialize FFT drivers.
     inline void init_fft()
     {
@@ -232,10 +238,12 @@ class Simulation_context : public Simulation_parameters
             fft_grid = get_min_fft_grid(pw_cutoff(), rlv).grid_size();
         }
         fft_ = std::unique_ptr<FFT3D>(new FFT3D(fft_grid, comm_fft(), processing_unit()));
+        fft_->num_a2a_chunks(control().fft_a2a_num_chunks_);
 
         /* create FFT driver for coarse mesh */
         fft_coarse_ = std::unique_ptr<FFT3D>(
             new FFT3D(get_min_fft_grid(2 * gk_cutoff(), rlv).grid_size(), comm_fft_coarse(), processing_unit()));
+        fft_coarse_->num_a2a_chunks(control().fft_a2a_num_chunks_);
 
         /* create a list of G-vectors for corase FFT grid */
         gvec_coarse_ = std::unique_ptr<Gvec>(new Gvec(rlv, 2 * gk_cutoff(), comm(), control().reduce_gvec_));
@@ -310,6 +318,41 @@ class Simulation_context : public Simulation_parameters
         comm_band_ortho_fft_coarse_ = comm_band().split(comm_fft_coarse().rank());
     }
 
+    /// Get the name of the default eigen-value solver for a given npr x npc grid of the band communicator.
+    inline std::string default_evp_solver_name(int npr__, int npc__) const
+    {
+#if defined(__MAGMA)
+        bool is_magma{true};
+#else
+        bool is_magma{false};
+#endif
+#if defined(__SCALAPACK)
+        bool is_scalapack{true};
+#else
+        bool is_scalapack{false};
+#endif
+#if defined(__ELPA)
+        bool is_elpa{true};
+#else
+        bool is_elpa{false};
+#endif
+        /* conditions for sequential diagonalization */
+        if (comm_band().size() == 1 || npc__ == 1 || npr__ == 1 || !is_scalapack) {
+            if (is_magma && num_bands() > 200) {
+                return "magma";
+            } else {
+                return "lapack";
+            }
+        }
+        if (is_elpa) {
+            return "elpa1";
+        }
+        return "scalapack";
+    }
+
+    /// Run short timed trials of the band group layouts and keep the fastest one.
+    void autotune();
+
     /// Unit step function is defined to be 1 in the interstitial and 0 inside muffin-tins.
     /** Unit step function is constructed from it's plane-wave expansion coefficients which are computed
      *  analytically:
@@ -364,7 +407,7 @@ class Simulation_context : public Simulation_parameters
         for (int i = 0; i < gvec_partition().gvec_count_fft(); i++) {
             ftmp[i] = theta_pw_[gvec_partition().idx_gvec(i)];
         }
-        fft().transform<1>(ftmp.data());
+        fft().transform_real<1>(ftmp.data());
         fft().output(&theta_[0]);
 
         double vit{0};
@@ -479,7 +522,7 @@ class Simulation_context : public Simulation_parameters
         , unit_cell_(*this, comm_)
     {
         start();
-        import(str__);
+        import(str__, comm_);
         unit_cell_.import(unit_cell_input_);
     }
 
@@ -505,7 +548,7 @@ class Simulation_context : public Simulation_parameters
         , unit_cell_(*this, comm_)
     {
         start();
-        import(str__);
+        import(str__, comm_);
         unit_cell_.import(unit_cell_input_);
     }
 
@@ -526,6 +569,12 @@ class Simulation_context : public Simulation_parameters
     /// Initialize the similation (can only be called once).
     void initialize();
 
+    /// Decision of the runtime auto-tuner (empty if "control.autotune" is not set).
+    inline json const& autotune_result() const
+    {
+        return autotune_result_;
+    }
+
     void print_info() const;
 
     /// Print the memory usage.
@@ -552,12 +601,20 @@ class Simulation_context : public Simulation_parameters
     }
 
     /// Update context after setting new lattice vectors or atomic coordinates.
+    /** If the lattice vectors are not changed since the previous call, only the position-dependent quantities are
+     *  recomputed. */
     void update()
     {
         PROFILE("sirius::Simulation_context::update");
 
-        gvec_->lattice_vectors(unit_cell().reciprocal_lattice_vectors());
-        gvec_coarse_->lattice_vectors(unit_cell().reciprocal_lattice_vectors());
+        /* objects that depend only on G-vectors are kept if the lattice was not changed since the last update */
+        bool lattice_changed = (num_updates_++ == 0);
+        lattice_changed |= gvec_->lattice_vectors_changed(unit_cell().reciprocal_lattice_vectors());
+
+        if (lattice_changed) {
+            gvec_->lattice_vectors(unit_cell().reciprocal_lattice_vectors());
+            gvec_coarse_->lattice_vectors(unit_cell().reciprocal_lattice_vectors());
+        }
 
         unit_cell().update();
 
@@ -616,7 +673,7 @@ class Simulation_context : public Simulation_parameters
             }
         }
 
-        if (processing_unit() == device_t::GPU) {
+        if (processing_unit() == device_t::GPU && lattice_changed) {
             gvec_coord_ = mdarray<int, 2>(gvec().count(), 3, memory_t::host, "gvec_coord_");
             gvec_coord_.allocate(memory_t::device);
             for (int igloc = 0; igloc < gvec().count(); igloc++) {
@@ -633,7 +690,8 @@ class Simulation_context : public Simulation_parameters
             init_step_function();
         }
 
-        if (!full_potential()) {
+        /* augmentation operator depends only on the G-vectors and atom types */
+        if (!full_potential() && lattice_changed) {
             augmentation_op_.clear();
             memory_pool* mp{nullptr};
             switch (processing_unit()) {
@@ -785,15 +843,8 @@ class Simulation_context : public Simulation_parameters
             fout["parameters"].write("num_mag_dims", num_mag_dims());
             fout["parameters"].write("num_bands", num_bands());
 
-            mdarray<int, 2> gv(3, gvec().num_gvec());
-            for (int ig = 0; ig < gvec().num_gvec(); ig++) {
-                auto G = gvec().gvec(ig);
-                for (int x : {0, 1, 2}) {
-                    gv(x, ig) = G[x];
-                }
-            }
+            /* the G-vectors of each slab are stored together with the function */
             fout["parameters"].write("num_gvec", gvec().num_gvec());
-            fout["parameters"].write("gvec", gv);
 
             fout.create_node("unit_cell");
             fout["unit_cell"].create_node("atoms");
@@ -1376,9 +1427,6 @@ inline void Simulation_context::initialize()
         set_lmax_apw(-1);
     }
 
-    /* initialize FFT interface */
-    init_fft();
-
     int nbnd = static_cast<int>(unit_cell_.num_valence_electrons() / 2.0) +
                std::max(10, static_cast<int>(0.1 * unit_cell_.num_valence_electrons()));
     if (full_potential()) {
@@ -1400,22 +1448,15 @@ inline void Simulation_context::initialize()
         }
     }
 
+    /* run short timed trials of the MPI grid layout, FFT mode and ScaLAPACK block size */
+    if (control().autotune_) {
+        autotune();
+    }
+
+    /* initialize FFT interface */
+    init_fft();
+
     std::string evsn[] = {std_evp_solver_name(), gen_evp_solver_name()};
-#if defined(__MAGMA)
-    bool is_magma{true};
-#else
-    bool is_magma{false};
-#endif
-#if defined(__SCALAPACK)
-    bool is_scalapack{true};
-#else
-    bool is_scalapack{false};
-#endif
-#if defined(__ELPA)
-    bool is_elpa{true};
-#else
-    bool is_elpa{false};
-#endif
 
     int npr = control_input_.mpi_grid_dims_[0];
     int npc = control_input_.mpi_grid_dims_[1];
@@ -1423,21 +1464,7 @@ inline void Simulation_context::initialize()
     /* deduce the default eigen-value solver */
     for (int i : {0, 1}) {
         if (evsn[i] == "") {
-            /* conditions for sequential diagonalization */
-            if (comm_band().size() == 1 || npc == 1 || npr == 1 || !is_scalapack) {
-                if (is_magma && num_bands() > 200) {
-                    evsn[i] = "magma";
-                } else {
-                    evsn[i] = "lapack";
-                }
-            } else {
-                if (is_scalapack) {
-                    evsn[i] = "scalapack";
-                }
-                if (is_elpa) {
-                    evsn[i] = "elpa1";
-                }
-            }
+            evsn[i] = default_evp_solver_name(npr, npc);
         }
     }
 
@@ -1521,6 +1548,201 @@ inline void Simulation_context::initialize()
     initialized_ = true;
 }
 
+inline void Simulation_context::autotune()
+{
+    PROFILE("sirius::Simulation_context::autotune");
+
+    /* the size of the band group is fixed by the input; only the layout of the group is tuned */
+    int npb = comm_band().size();
+    /* size of the subspace matrix after the first expansion of the Davidson basis */
+    int nsub = (full_potential() ? 1 : 2) * num_bands();
+    /* number of timed repetitions of the FFT trial */
+    int const nrep{3};
+
+    auto rlv      = unit_cell_.reciprocal_lattice_vectors();
+    auto fft_grid = get_min_fft_grid(2 * gk_cutoff(), rlv).grid_size();
+
+    /* time of the backward and forward transforms of a single wave-function on the coarse FFT grid */
+    auto time_fft = [&]() -> double
+    {
+        FFT3D fft(fft_grid, comm_fft_coarse(), processing_unit());
+        fft.num_a2a_chunks(control().fft_a2a_num_chunks_);
+        /* G+k vectors are distributed in the same way as in K_point */
+        Gvec gkvec(vector3d<double>(0, 0, 0), rlv, gk_cutoff(), comm_band(), gamma_point());
+        Gvec_partition gkvecp(gkvec, comm_fft_coarse(), comm_band_ortho_fft_coarse());
+        fft.prepare(gkvecp);
+
+        std::vector<double_complex> psi(gkvecp.gvec_count_fft() + 1, double_complex(1, 0));
+        /* warm-up */
+        fft.transform<1>(psi.data());
+        fft.transform<-1>(psi.data());
+
+        comm_.barrier();
+        double t = utils::wtime();
+        for (int i = 0; i < nrep; i++) {
+            fft.transform<1>(psi.data());
+            fft.transform<-1>(psi.data());
+        }
+        t = (utils::wtime() - t) / nrep;
+        fft.dismiss();
+        comm_.allreduce<double, mpi_op_t::max>(&t, 1);
+        return t;
+    };
+
+    /* time of the standard eigen-value problem of the subspace size */
+    auto time_evp = [&](Eigensolver& solver__, int npr__, int npc__, int bs__) -> double
+    {
+        std::unique_ptr<BLACS_grid> blacs_grid;
+        if (solver__.is_parallel()) {
+            blacs_grid = std::unique_ptr<BLACS_grid>(new BLACS_grid(comm_band(), npr__, npc__));
+        } else {
+            blacs_grid = std::unique_ptr<BLACS_grid>(new BLACS_grid(Communicator::self(), 1, 1));
+        }
+        dmatrix<double_complex> A(nsub, nsub, *blacs_grid, bs__, bs__);
+        dmatrix<double_complex> Z(nsub, nsub, *blacs_grid, bs__, bs__);
+        /* diagonally dominant Hermitian matrix with a spread spectrum */
+        auto fill = [&]()
+        {
+            for (int jloc = 0; jloc < A.num_cols_local(); jloc++) {
+                int j = A.icol(jloc);
+                for (int iloc = 0; iloc < A.num_rows_local(); iloc++) {
+                    int i = A.irow(iloc);
+                    double d = 1.0 / (1 + std::abs(i - j));
+                    A(iloc, jloc) = double_complex(d + ((i == j) ? i : 0), 0.1 * d * (j - i));
+                }
+            }
+        };
+        std::vector<double> eval(nsub);
+
+        /* warm-up; the solver overwrites the input matrix, so it is filled again before the timed call */
+        fill();
+        solver__.solve(nsub, std::min(num_bands(), nsub), A, eval.data(), Z);
+        fill();
+
+        comm_.barrier();
+        double t = utils::wtime();
+        solver__.solve(nsub, std::min(num_bands(), nsub), A, eval.data(), Z);
+        t = utils::wtime() - t;
+        comm_.allreduce<double, mpi_op_t::max>(&t, 1);
+        return t;
+    };
+
+    std::vector<int> block_sizes({16, 32, 64, 128});
+    if (cyclic_block_size() > 0) {
+        block_sizes = {cyclic_block_size()};
+    }
+
+    json trials = json::array();
+
+    double best_time{-1};
+    std::vector<int> best_dims;
+    std::string best_fft_mode;
+    int best_num_chunks{0};
+    int best_block_size{cyclic_block_size()};
+
+    /* time of the sequential eigen-solver doesn't depend on the layout */
+    double t_evp_seq{-1};
+
+    /* the serial FFT is timed with the number of chunks from the input; trials of the parallel FFT change it */
+    int const input_num_chunks = control_input_.fft_a2a_num_chunks_;
+
+    for (int npr = 1; npr <= npb; npr++) {
+        if (npb % npr) {
+            continue;
+        }
+        int npc = npb / npr;
+        set_mpi_grid_dims({npr, npc});
+
+        /* find the fastest FFT setup for this layout */
+        double t_fft{-1};
+        std::string fft_mode;
+        int num_chunks{0};
+        for (std::string mode : {"serial", "parallel"}) {
+            /* with one rank per FFT group the parallel FFT is the serial one */
+            if (mode == "parallel" && npr == 1) {
+                continue;
+            }
+            std::vector<int> chunks({1, 2, 4, 8});
+            if (mode == "serial") {
+                chunks = {input_num_chunks};
+            }
+            for (int nc : chunks) {
+                control_input_.fft_mode_           = mode;
+                control_input_.fft_a2a_num_chunks_ = nc;
+                init_comm();
+                /* bands are distributed between the FFT groups of the band communicator */
+                double t = time_fft() * num_bands() / (comm_band().size() / comm_fft_coarse().size());
+                if (t_fft < 0 || t < t_fft) {
+                    t_fft      = t;
+                    fft_mode   = mode;
+                    num_chunks = nc;
+                }
+            }
+        }
+
+        /* find the fastest block size of the subspace eigen-solver for this layout */
+        auto evp_name = std_evp_solver_name().size() ? std_evp_solver_name() : default_evp_solver_name(npr, npc);
+        auto solver   = Eigensolver_factory(get_ev_solver_t(evp_name));
+        double t_evp{-1};
+        int block_size{cyclic_block_size()};
+        if (solver->is_parallel()) {
+            for (int bs : block_sizes) {
+                double t = time_evp(*solver, npr, npc, bs);
+                if (t_evp < 0 || t < t_evp) {
+                    t_evp      = t;
+                    block_size = bs;
+                }
+            }
+        } else {
+            if (t_evp_seq < 0) {
+                t_evp_seq = time_evp(*solver, 1, 1, 1);
+            }
+            t_evp = t_evp_seq;
+        }
+
+        /* one Davidson step: local part of the Hamiltonian applied to all bands and one subspace diagonalization */
+        double t = t_fft + t_evp;
+
+        json trial;
+        trial["mpi_grid_dims"]      = {npr, npc};
+        trial["fft_mode"]           = fft_mode;
+        trial["fft_a2a_num_chunks"] = num_chunks;
+        trial["cyclic_block_size"]  = block_size;
+        trial["std_evp_solver"]     = evp_name;
+        trial["fft_time"]           = t_fft;
+        trial["evp_time"]           = t_evp;
+        trials.push_back(trial);
+
+        if (best_time < 0 || t < best_time) {
+            best_time       = t;
+            best_dims       = {npr, npc};
+            best_fft_mode   = fft_mode;
+            best_num_chunks = num_chunks;
+            best_block_size = block_size;
+        }
+    }
+
+    set_mpi_grid_dims(best_dims);
+    control_input_.fft_mode_           = best_fft_mode;
+    control_input_.fft_a2a_num_chunks_ = best_num_chunks;
+    control_input_.cyclic_block_size_  = best_block_size;
+    init_comm();
+
+    /* the "control" part can be copied to the input file of the next run */
+    autotune_result_["control"]["mpi_grid_dims"]      = best_dims;
+    autotune_result_["control"]["fft_mode"]           = best_fft_mode;
+    autotune_result_["control"]["fft_a2a_num_chunks"] = best_num_chunks;
+    if (best_block_size > 0) {
+        autotune_result_["control"]["cyclic_block_size"] = best_block_size;
+    }
+    autotune_result_["trials"] = trials;
+
+    if (comm_.rank() == 0 && control().verbosity_ >= 1) {
+        printf("autotune: mpi_grid_dims: %i %i, fft_mode: %s, fft_a2a_num_chunks: %i, cyclic_block_size: %i\n",
+               best_dims[0], best_dims[1], best_fft_mode.c_str(), best_num_chunks, best_block_size);
+    }
+}
+
 inline void Simulation_context::print_info() const
 {
     tm const* ptm = localtime(&start_time_.tv_sec);
@@ -42,6 +42,44 @@ inline const json& get_options_dictionary()
     return all_options_dictionary_;
 }
 
+/// Read json dictionary from file or string on the root rank and broadcast it to the other ranks.
+/** Only the root rank of the communicator accesses the file system; the raw content of the file is broadcast and
+ *  parsed by each rank from memory. This avoids simultaneous reads of the input and species files by all MPI ranks
+ *  at startup. */
+inline json read_json_from_file_or_string(std::string const& str__, Communicator const& comm__)
+{
+    /* json string or serial run */
+    if (str__.size() == 0 || str__.find("{") != std::string::npos || comm__.size() == 1) {
+        return utils::read_json_from_file_or_string(str__);
+    }
+
+    std::vector<uint8_t> buf;
+    int sz{-1};
+    if (comm__.rank() == 0 && utils::file_exists(str__)) {
+        buf = utils::read_file_content(str__);
+        sz  = static_cast<int>(buf.size());
+    }
+    comm__.bcast(&sz, 1, 0);
+    if (sz < 0) {
+        std::stringstream s;
+        s << "file " << str__ << " doesn't exist";
+        TERMINATE(s);
+    }
+    buf.resize(sz);
+    comm__.bcast(buf.data(), sz, 0);
+
+    json dict;
+    try {
+        dict = utils::parse_json(buf, str__);
+    } catch (std::exception& e) {
+        std::stringstream s;
+        s << "wrong input json file" << std::endl
+          << e.what();
+        TERMINATE(s);
+    }
+    return std::move(dict);
+}
+
 /// Set of basic parameters of a simulation.
 class Simulation_parameters
 {
@@ -84,7 +122,8 @@ class Simulation_parameters
 
   public:
     /// Import parameters from a file or a serialized json string.
-    void import(std::string const& str__)
+    /** The file is read by the root rank of the communicator and broadcast to the other ranks. */
+    void import(std::string const& str__, Communicator const& comm__ = Communicator::self())
     {
         PROFILE("sirius::Simulation_parameters::import");
 
@@ -92,7 +131,7 @@ class Simulation_parameters
             return;
         }
 
-        json dict = utils::read_json_from_file_or_string(str__);
+        json dict = read_json_from_file_or_string(str__, comm__);
 
         /* read unit cell */
         unit_cell_input_.read(dict);
@@ -196,7 +196,7 @@ void sirius_import_parameters(void* const* handler__,
 {
     GET_SIM_CTX(handler__);
     if (str__) {
-        sim_ctx.import(std::string(str__));
+        sim_ctx.import(std::string(str__), sim_ctx.comm());
     }
     else {
         sim_ctx.import(sim_ctx.get_runtime_options_dictionary());
@@ -545,6 +545,25 @@ void sirius_find_ground_state(void* const* gs_handler__, bool const *save__)
     auto result = gs.find(inp.potential_tol_, inp.energy_tol_, ctx.iterative_solver_tolerance(), inp.num_dft_iter_, save);
 }
 
+/* @fortran begin function void sirius_set_scf_telemetry_callback   Set a function which receives the SCF telemetry.
+   @fortran argument in required void* gs_handler                      Ground-state handler.
+   @fortran argument in required func  callback                        Function of one argument (JSON record as C string).
+   @fortran details
+   The function is called on rank 0 after each SCF iteration with a null-terminated string which contains the
+   JSON record of the iteration.
+   @fortran end */
+void sirius_set_scf_telemetry_callback(void* const* gs_handler__,
+                                       void (* const* callback__)(char const*))
+{
+    GET_GS(gs_handler__)
+    auto callback = *callback__;
+    gs.scf_telemetry_callback([callback](json const& record)
+                              {
+                                  auto str = record.dump();
+                                  callback(str.c_str());
+                              });
+}
+
 /* @fortran begin function void sirius_update_ground_state   Update a ground state object after change of atomic coordinates or lattice vectors.
    @fortran argument in  required void*  gs_handler          Ground-state handler.
    @fortran end */
@@ -554,6 +573,23 @@ void sirius_update_ground_state(void** handler__)
     gs.update();
 }
 
+/* @fortran begin function void sirius_update_atomic_positions   Move atoms and update a ground state object.
+   @fortran argument in  required void*  gs_handler               Ground-state handler.
+   @fortran argument in  required double positions                New atomic positions in lattice coordinates (3 x num_atoms).
+   @fortran end */
+void sirius_update_atomic_positions(void*  const* gs_handler__,
+                                    double const* positions__)
+{
+    GET_GS(gs_handler__)
+    /* lattice, cutoffs and atom types are kept; only the position-dependent quantities are recomputed and
+     * the current density and wave-functions serve as a starting guess */
+    auto& uc = gs.k_point_set().ctx().unit_cell();
+    for (int ia = 0; ia < uc.num_atoms(); ia++) {
+        uc.atom(ia).set_position(vector3d<double>(&positions__[3 * ia]));
+    }
+    gs.update();
+}
+
 /* @fortran begin function void sirius_add_atom_type     Add new atom type to the unit cell.
    @fortran argument in  required void*  handler         Simulation context handler.
    @fortran argument in  required string label           Atom type unique label.
@@ -1461,6 +1497,32 @@ void sirius_get_stress_tensor(void* const* handler__,
     }
 }
 
+/* @fortran begin function void sirius_get_forces_and_stress     Compute total forces and total stress tensor.
+   @fortran argument in  required void*   handler                 DFT ground state handler.
+   @fortran argument out required double  forces                  Total force for each atom.
+   @fortran argument out required double  stress_tensor           Total stress tensor.
+   @fortran end */
+void sirius_get_forces_and_stress(void* const* handler__,
+                                  double*      forces__,
+                                  double*      stress_tensor__)
+{
+    GET_GS(handler__)
+
+    /* non-local forces are computed together with the non-local stress */
+    auto s = gs.stress().calc_stress_total(gs.forces());
+    auto& f = gs.forces().calc_forces_total(false);
+
+    for (size_t i = 0; i < f.size(); i++) {
+        forces__[i] = f[i];
+    }
+
+    for (int mu = 0; mu < 3; mu++) {
+        for (int nu = 0; nu < 3; nu++) {
+            stress_tensor__[nu + mu * 3] = s(mu, nu);
+        }
+    }
+}
+
 /* @fortran begin function int sirius_get_num_beta_projectors     Get the number of beta-projectors for an atom type.
    @fortran argument in  required void*   handler                  Simulation context handler.
    @fortran argument in  required string  label                    Atom type label.
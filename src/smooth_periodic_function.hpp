@@ -182,13 +182,22 @@ class Smooth_periodic_function
         switch (direction__) {
             case 1: {
                 gather_f_pw_fft();
-                fft_->transform<1>(f_pw_fft_.at(memory_t::host));
+                /* real functions are transformed with the complex-to-real FFT */
+                if (std::is_same<T, double>::value) {
+                    fft_->transform_real<1>(f_pw_fft_.at(memory_t::host));
+                } else {
+                    fft_->transform<1>(f_pw_fft_.at(memory_t::host));
+                }
                 fft_->output(f_rg_.at(memory_t::host));
                 break;
             }
             case -1: {
                 fft_->input(f_rg_.at(memory_t::host));
-                fft_->transform<-1>(f_pw_fft_.at(memory_t::host));
+                if (std::is_same<T, double>::value) {
+                    fft_->transform_real<-1>(f_pw_fft_.at(memory_t::host));
+                } else {
+                    fft_->transform<-1>(f_pw_fft_.at(memory_t::host));
+                }
                 int count  = gvecp_->gvec_fft_slab().counts[gvecp_->comm_ortho_fft().rank()];
                 int offset = gvecp_->gvec_fft_slab().offsets[gvecp_->comm_ortho_fft().rank()];
                 std::memcpy(f_pw_local_.at(memory_t::host), f_pw_fft_.at(memory_t::host, offset),
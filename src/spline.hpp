@@ -557,6 +557,95 @@ class Spline : public Radial_grid<U>
     }
 };
 
+/// Set of cubic splines defined on the same radial grid and stored in a contiguous array.
+/** Coefficients are stored as \f$ c_{j,k,i} \f$, where \f$ j \f$ is the index of spline, \f$ k \f$ is the index of
+ *  coefficient (0 to 3) and \f$ i \f$ is the index of the grid segment. For a given segment all coefficients of all
+ *  splines are located in one piece of memory, so the entire set of splines is evaluated in a single streaming pass
+ *  which the compiler can vectorize over the spline index.
+ */
+template <typename T, typename U = double>
+class Spline_set
+{
+  private:
+    /// Number of splines in the set.
+    int num_splines_{0};
+
+    /// Number of grid points.
+    int num_points_{0};
+
+    /// Packed spline coefficients.
+    mdarray<T, 3> coeffs_;
+
+  public:
+    /// Default constructor.
+    Spline_set()
+    {
+    }
+
+    /// Constructor of an empty set of splines.
+    Spline_set(int num_splines__, int num_points__)
+        : num_splines_(num_splines__)
+        , num_points_(num_points__)
+    {
+        coeffs_ = mdarray<T, 3>(std::max(num_splines_, 1), 4, num_points_);
+        coeffs_.zero();
+    }
+
+    Spline_set(Spline_set<T, U>&& src__) = default;
+
+    Spline_set<T, U>& operator=(Spline_set<T, U>&& src__) = default;
+
+    /// Copy coefficients of the interpolated spline to the j-th position in the set.
+    inline void set(int j__, Spline<T, U> const& s__)
+    {
+        assert(j__ >= 0 && j__ < num_splines_);
+        assert(s__.num_points() == num_points_);
+        for (int i = 0; i < num_points_; i++) {
+            for (int k = 0; k < 4; k++) {
+                coeffs_(j__, k, i) = s__.coeffs()(i, k);
+            }
+        }
+    }
+
+    /// Get values of all splines at the point x[i] + dx.
+    /** An empty set (e.g. for an atom type without radial functions) is a no-op. The last grid point is
+     *  allowed and gives the values at this point. */
+    inline void operator()(int i__, U dx__, T* val__) const
+    {
+        if (!num_splines_) {
+            return;
+        }
+
+        assert(i__ >= 0);
+        assert(i__ < num_points_);
+        assert(dx__ >= 0);
+
+        if (i__ == num_points_ - 1) {
+            for (int j = 0; j < num_splines_; j++) {
+                val__[j] = coeffs_(j, 0, i__);
+            }
+            return;
+        }
+        T const* c0 = &coeffs_(0, 0, i__);
+        T const* c1 = &coeffs_(0, 1, i__);
+        T const* c2 = &coeffs_(0, 2, i__);
+        T const* c3 = &coeffs_(0, 3, i__);
+        for (int j = 0; j < num_splines_; j++) {
+            val__[j] = c0[j] + dx__ * (c1[j] + dx__ * (c2[j] + dx__ * c3[j]));
+        }
+    }
+
+    inline int num_splines() const
+    {
+        return num_splines_;
+    }
+
+    inline int num_points() const
+    {
+        return num_points_;
+    }
+};
+
 template <typename T, typename U = double>
 inline Spline<T, U> operator*(Spline<T, U> const& a__, Spline<T, U> const& b__)
 {
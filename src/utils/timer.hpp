@@ -290,6 +290,13 @@ class timer
         }
     }
 
+    /// Clear the values of all timers.
+    static void reset()
+    {
+        timer_values().clear();
+        timer_values_ex().clear();
+    }
+
     static nlohmann::json serialize()
     {
         nlohmann::json dict;
@@ -33,6 +33,7 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <sys/time.h>
 #include <unistd.h>
@@ -304,8 +305,40 @@ inline double confined_polynomial(double r, double R, int p1, int p2, int dm)
     }
 }
 
+/// Return true if the file name has the extension of a binary json file (CBOR or MessagePack).
+inline bool is_binary_json_file(std::string const& fname__)
+{
+    auto ext = fname__.substr(fname__.find_last_of(".") + 1);
+    return (ext == "cbor" || ext == "msgpack");
+}
+
+/// Read the entire content of a file.
+inline std::vector<uint8_t> read_file_content(std::string const& fname__)
+{
+    std::ifstream ifs(fname__, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+}
+
+/// Parse json dictionary from the raw content of a file.
+/** The format is deduced from the file name: *.cbor and *.msgpack files are in binary CBOR and MessagePack formats,
+ *  all other files are text. Binary species files are produced by apps/upf/json_to_binary.py. They are parsed much
+ *  faster than the text files because floating point numbers are stored as raw IEEE 754 values. */
+inline nlohmann::json parse_json(std::vector<uint8_t> const& buf__, std::string const& fname__)
+{
+    if (is_binary_json_file(fname__)) {
+        auto ext = fname__.substr(fname__.find_last_of(".") + 1);
+        if (ext == "cbor") {
+            return nlohmann::json::from_cbor(buf__);
+        } else {
+            return nlohmann::json::from_msgpack(buf__);
+        }
+    } else {
+        return nlohmann::json::parse(buf__.begin(), buf__.end());
+    }
+}
+
 /// Read json dictionary from file or string.
-/** Terminate if file doesn't exist. */
+/** Terminate if file doesn't exist. Files with *.cbor and *.msgpack extensions are read in binary format. */
 inline nlohmann::json read_json_from_file_or_string(std::string const& str__)
 {
     nlohmann::json dict = {};
@@ -316,7 +349,7 @@ inline nlohmann::json read_json_from_file_or_string(std::string const& str__)
     if (str__.find("{") == std::string::npos) { /* this is a file */
         if (file_exists(str__)) {
             try {
-                std::ifstream(str__) >> dict;
+                dict = parse_json(read_file_content(str__), str__);
             } catch(std::exception& e) {
                 std::stringstream s;
                 s << "wrong input json file" << std::endl